@@ -26,6 +26,8 @@ public class PRG_Plugin : ModuleRules
 			new string[]
 			{
 				"Core",
+				// Room gizmos are declared in the public room header
+				"InteractiveToolsFramework",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -36,18 +38,17 @@ public class PRG_Plugin : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
-				"Slate",
-				"SlateCore",
-				"InputCore",
-				"EditorFramework",
-				"EditorStyle",
-				"UnrealEd",
-				"LevelEditor",
-				"InteractiveToolsFramework",
-				"EditorInteractiveToolsFramework"
+				"PhysicsCore",
+				"NavigationSystem"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
+
+		// Portal culling of the level editor viewport
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
 		
 		
 		DynamicallyLoadedModuleNames.AddRange(
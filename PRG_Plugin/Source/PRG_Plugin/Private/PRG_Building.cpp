@@ -0,0 +1,328 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_Building.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "PRG_Room.h"
+
+APRG_Building::APRG_Building()
+{
+	// Disable this actor to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = false;
+
+	BaseComponent = CreateDefaultSubobject<USceneComponent>(TEXT("BaseComponent"));
+	BaseComponent->SetMobility(EComponentMobility::Type::Static);
+	RootComponent = BaseComponent;
+}
+
+int32 APRG_Building::AddLevel(APRG_Room* Room)
+{
+	if (!Room)
+		return INDEX_NONE;
+
+	const int32 ExistingLevel = GetLevelIndex(Room);
+	if (ExistingLevel != INDEX_NONE)
+		return ExistingLevel;
+
+	Modify();
+	Room->Modify();
+
+	FPRGBuildingLevel NewLevelEntry;
+	NewLevelEntry.Room = Room;
+	const int32 NewLevel = Levels.Add(NewLevelEntry);
+	Room->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
+	Room->SetActorRelativeTransform(FTransform(FVector(0.0f, 0.0f, GetLevelOffsetCM(NewLevel))));
+	Room->NotifyRoomChanged(ERoomChange::Transform);
+
+	ApplyConnectorOpenings();
+	RebuildConnectors();
+
+	return NewLevel;
+}
+
+void APRG_Building::RestackLevels()
+{
+	Modify();
+	Levels.RemoveAll([](const FPRGBuildingLevel& Level) { return !IsValid(Level.Room); });
+
+	for (int32 Level = 0; Level < Levels.Num(); Level++)
+	{
+		APRG_Room* Room = Levels[Level].Room;
+		const FTransform LevelTransform(FVector(0.0f, 0.0f, GetLevelOffsetCM(Level)));
+		if (Room->GetAttachParentActor() == this && Room->GetRootComponent()->GetRelativeTransform().Equals(LevelTransform))
+			continue;
+
+		Room->Modify();
+		Room->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
+		Room->SetActorRelativeTransform(LevelTransform);
+		Room->NotifyRoomChanged(ERoomChange::Transform);
+	}
+
+	RebuildConnectors();
+	ApplyLevelVisibility();
+}
+
+APRG_Room* APRG_Building::GetLevelRoom(int32 Level) const
+{
+	return Levels.IsValidIndex(Level) ? Levels[Level].Room.Get() : nullptr;
+}
+
+int32 APRG_Building::GetLevelIndex(const APRG_Room* Room) const
+{
+	return Room ? Levels.IndexOfByPredicate([Room](const FPRGBuildingLevel& Level) { return Level.Room == Room; }) : INDEX_NONE;
+}
+
+int32 APRG_Building::GetLevelByHeight(float LocalZ) const
+{
+	if (Levels.Num() == 0)
+		return INDEX_NONE;
+
+	return FMath::Clamp(FMath::FloorToInt(LocalZ / (LevelHeight * 100.0f)), 0, Levels.Num() - 1);
+}
+
+FPRGBuildingCell APRG_Building::GetTileByPosition(FVector LocalPosition) const
+{
+	FPRGBuildingCell Cell;
+	Cell.Level = GetLevelByHeight(LocalPosition.Z);
+	if (APRG_Room* Room = GetLevelRoom(Cell.Level))
+	{
+		const FIntPoint Size = Room->GetRoomSize();
+		const int32 Index = Room->GetTileIndexByPosition(LocalPosition, Room->GetTileSizeCM());
+		Cell.Index = (Index >= 0 && Index < FPRGRoomCells::NumTiles(Size)) ? Index : INDEX_NONE;
+	}
+	return Cell;
+}
+
+FPRGBuildingCell APRG_Building::GetWallByPosition(FVector LocalPosition) const
+{
+	FPRGBuildingCell Cell;
+	Cell.Level = GetLevelByHeight(LocalPosition.Z);
+	if (APRG_Room* Room = GetLevelRoom(Cell.Level))
+	{
+		const FIntPoint Size = Room->GetRoomSize();
+		const int32 Index = Room->GetWallIndexByPosition(LocalPosition, Room->GetTileSizeCM());
+		Cell.Index = (Index >= 0 && Index < FPRGRoomCells::NumWalls(Size)) ? Index : INDEX_NONE;
+	}
+	return Cell;
+}
+
+FVector APRG_Building::GetTilePosition(const FPRGBuildingCell& Cell) const
+{
+	APRG_Room* Room = GetLevelRoom(Cell.Level);
+	if (!Room)
+		return FVector::ZeroVector;
+
+	return Room->GetTilePositionFromIndex(Cell.Index, Room->GetTileSizeCM()) + FVector(0.0f, 0.0f, GetLevelOffsetCM(Cell.Level));
+}
+
+FVector APRG_Building::GetWallPosition(const FPRGBuildingCell& Cell) const
+{
+	APRG_Room* Room = GetLevelRoom(Cell.Level);
+	if (!Room)
+		return FVector::ZeroVector;
+
+	return Room->GetWallPositionFromIndex(Cell.Index, Room->GetTileSizeCM()) + FVector(0.0f, 0.0f, GetLevelOffsetCM(Cell.Level));
+}
+
+void APRG_Building::SetLevelVisible(int32 Level, bool bVisible)
+{
+	if (!Levels.IsValidIndex(Level) || Levels[Level].bVisible == bVisible)
+		return;
+
+	Modify();
+	Levels[Level].bVisible = bVisible;
+	ApplyLevelVisibility();
+}
+
+void APRG_Building::ApplyConnectorOpenings()
+{
+	// Tiles the connectors occupy now. The bottom level keeps its floor
+	TArray<TPair<APRG_Room*, FIntPoint>> Required;
+	for (const FPRGVerticalConnector& Connector : Connectors)
+	{
+		for (int32 Level = Connector.BottomLevel + 1; Level <= Connector.TopLevel; Level++)
+		{
+			APRG_Room* Room = GetLevelRoom(Level);
+			if (!Room || GetConnectorTileIndex(Connector, Level) == INDEX_NONE)
+				continue;
+
+			if (Room->HasLayout())
+			{
+				UE_LOG(LogPRGRoom, Warning, TEXT("Level %d of %s uses a shared layout, unable to open the floor for a connector."), Level, *GetName());
+				continue;
+			}
+			Required.AddUnique(MakeTuple(Room, Connector.Tile));
+		}
+	}
+
+	// Lambda - Modify building and room before their first change, so the change is undone with the edit that caused it
+	bool bModified = false;
+	TArray<APRG_Room*> ChangedRooms;
+	auto BeginChange = [this, &bModified, &ChangedRooms](APRG_Room* Room)
+	{
+		if (!bModified)
+			Modify();
+		bModified = true;
+
+		if (IsValid(Room) && !ChangedRooms.Contains(Room))
+		{
+			Room->Modify();
+			ChangedRooms.Add(Room);
+		}
+	};
+
+	// Restore tiles of openings no connector needs anymore, unless the slot was filled since
+	for (int32 i = ConnectorOpenings.Num() - 1; i >= 0; i--)
+	{
+		const FPRGConnectorOpening& Opening = ConnectorOpenings[i];
+		APRG_Room* Room = Opening.Room;
+		if (IsValid(Room) && Required.Contains(MakeTuple(Room, Opening.Tile)))
+			continue;
+
+		BeginChange(Room);
+		if (IsValid(Room) && Opening.Mesh && !Room->HasLayout())
+		{
+			const int32 TileIndex = FPRGGridLayout(Room->GetRoomSize(), Room->GetTileSizeCM()).TileIndex(Opening.Tile.X, Opening.Tile.Y);
+			if (Room->GetTiles().IsValidIndex(TileIndex) && !Room->GetTiles()[TileIndex])
+				Room->SetCellMeshes(false, TileIndex, 1, Opening.Mesh);
+		}
+		ConnectorOpenings.RemoveAt(i);
+	}
+
+	// Remove tiles under new openings, keeping their mesh
+	for (const TPair<APRG_Room*, FIntPoint>& Opening : Required)
+	{
+		APRG_Room* Room = Opening.Key;
+		if (ConnectorOpenings.ContainsByPredicate([&Opening](const FPRGConnectorOpening& Existing) { return Existing.Room == Opening.Key && Existing.Tile == Opening.Value; }))
+			continue;
+
+		const int32 TileIndex = FPRGGridLayout(Room->GetRoomSize(), Room->GetTileSizeCM()).TileIndex(Opening.Value.X, Opening.Value.Y);
+		ATile* Tile = Room->GetTiles().IsValidIndex(TileIndex) ? Room->GetTiles()[TileIndex].Get() : nullptr;
+		if (!Tile)
+			continue;
+
+		BeginChange(Room);
+		FPRGConnectorOpening& NewOpening = ConnectorOpenings.AddDefaulted_GetRef();
+		NewOpening.Room = Room;
+		NewOpening.Tile = Opening.Value;
+		NewOpening.Mesh = Tile->GetStaticMeshComponent()->GetStaticMesh();
+		Room->SetCellMeshes(false, TileIndex, 1, nullptr);
+	}
+
+	for (APRG_Room* Room : ChangedRooms)
+		Room->NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void APRG_Building::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	if (IsTemplate() || !GetWorld())
+		return;
+
+	RebuildConnectors();
+	ApplyLevelVisibility();
+}
+
+#if WITH_EDITOR
+void APRG_Building::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+	const FName MemberName = PropertyChangedEvent.GetMemberPropertyName();
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(APRG_Building, LevelHeight))
+		RestackLevels();
+	else if (MemberName == GET_MEMBER_NAME_CHECKED(APRG_Building, Connectors))
+	{
+		ApplyConnectorOpenings();
+		RebuildConnectors();
+		ApplyLevelVisibility();
+	}
+	else if (MemberName == GET_MEMBER_NAME_CHECKED(APRG_Building, Levels))
+		ApplyLevelVisibility();
+}
+
+void APRG_Building::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	RebuildConnectors();
+	ApplyLevelVisibility();
+}
+#endif
+
+void APRG_Building::RebuildConnectors()
+{
+	for (TObjectPtr<UInstancedStaticMeshComponent>& ConnectorComponent : ConnectorComponents)
+	{
+		if (ConnectorComponent)
+			ConnectorComponent->DestroyComponent();
+	}
+	ConnectorComponents.Reset();
+	ConnectorComponentLevels.Reset();
+
+	// Group instances by mesh and level, in building space
+	TMap<TPair<UStaticMesh*, int32>, TArray<FTransform>> Instances;
+	for (const FPRGVerticalConnector& Connector : Connectors)
+	{
+		if (!Connector.Mesh)
+			continue;
+
+		// Stairs lead up from each level to the next, shafts pass through every level they span
+		const int32 LastLevel = Connector.Type == EPRGConnectorType::Stairs ? Connector.TopLevel - 1 : Connector.TopLevel;
+		for (int32 Level = Connector.BottomLevel; Level <= LastLevel; Level++)
+		{
+			const int32 TileIndex = GetConnectorTileIndex(Connector, Level);
+			if (TileIndex == INDEX_NONE)
+				continue;
+
+			Instances.FindOrAdd(MakeTuple(Connector.Mesh.Get(), Level)).Add(FTransform(GetTilePosition({ Level, TileIndex })));
+		}
+	}
+
+	for (const TPair<TPair<UStaticMesh*, int32>, TArray<FTransform>>& LevelInstances : Instances)
+	{
+		UInstancedStaticMeshComponent* ConnectorComponent = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+		ConnectorComponent->SetMobility(EComponentMobility::Static);
+		ConnectorComponent->SetupAttachment(RootComponent);
+		ConnectorComponent->SetStaticMesh(LevelInstances.Key.Key);
+		ConnectorComponent->RegisterComponent();
+		ConnectorComponent->AddInstances(LevelInstances.Value, false);
+
+		ConnectorComponents.Add(ConnectorComponent);
+		ConnectorComponentLevels.Add(LevelInstances.Key.Value);
+	}
+}
+
+void APRG_Building::ApplyLevelVisibility()
+{
+	for (int32 Level = 0; Level < Levels.Num(); Level++)
+	{
+		if (APRG_Room* Room = Levels[Level].Room)
+			Room->SetRoomHidden(!Levels[Level].bVisible, ERoomHiddenBy::Building);
+	}
+
+	// Hidden levels only declutter the editor, the game shows all connectors
+	const bool bGameWorld = GetWorld() && GetWorld()->IsGameWorld();
+	for (int32 i = 0; i < ConnectorComponents.Num(); i++)
+	{
+		if (ConnectorComponents[i])
+			ConnectorComponents[i]->SetVisibility(bGameWorld || IsLevelVisible(ConnectorComponentLevels[i]));
+	}
+}
+
+int32 APRG_Building::GetConnectorTileIndex(const FPRGVerticalConnector& Connector, int32 Level) const
+{
+	APRG_Room* Room = GetLevelRoom(Level);
+	if (!Room)
+		return INDEX_NONE;
+
+	// Levels can differ in size, so the connector tile may fall outside smaller levels
+	const FIntPoint Size = Room->GetRoomSize();
+	if (Connector.Tile.X < 0 || Connector.Tile.Y < 0 || Connector.Tile.X >= Size.X || Connector.Tile.Y >= Size.Y)
+		return INDEX_NONE;
+
+	return Connector.Tile.X + Connector.Tile.Y * Size.X;
+}
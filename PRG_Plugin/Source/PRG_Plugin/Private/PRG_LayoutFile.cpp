@@ -0,0 +1,314 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_LayoutFile.h"
+
+#include "PRG_Room.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	// Size of the fixed header: Magic, Version, RoomCount, PaletteOffset
+	constexpr int64 HeaderSize = sizeof(uint32) + sizeof(uint32) + sizeof(int32) + sizeof(int64);
+	// Largest room size accepted when reading. Guards against allocating huge arrays for corrupt files
+	constexpr int32 MaxRoomSize = 4096;
+	// Highest room accepted when reading, in meters. Heights feed bounds, collision and overlap tests
+	constexpr int32 MaxRoomHeight = 1000;
+
+	// Serialize placement and dimensions of a record. Works for both loading and saving
+	void SerializeRecordHeader(FArchive& Ar, FPRGRoomRecord& Record)
+	{
+		Ar << Record.Location.X << Record.Location.Y << Record.Location.Z;
+		Ar << Record.Rotation.Pitch << Record.Rotation.Yaw << Record.Rotation.Roll;
+
+		uint32 SizeX = Record.Cells.RoomSize.X;
+		uint32 SizeY = Record.Cells.RoomSize.Y;
+		uint32 Height = Record.Cells.RoomHeight;
+		uint32 TileSize = Record.Cells.TileSizeCM;
+		Ar.SerializeIntPacked(SizeX);
+		Ar.SerializeIntPacked(SizeY);
+		Ar.SerializeIntPacked(Height);
+		Ar.SerializeIntPacked(TileSize);
+
+		if (Ar.IsLoading())
+		{
+			Record.Cells.RoomSize = FIntPoint(SizeX, SizeY);
+			Record.Cells.RoomHeight = Height;
+			Record.Cells.TileSizeCM = TileSize;
+		}
+	}
+
+	// Write cell array as runs of equal palette indices
+	void WriteCellRuns(FArchive& Ar, const TArray<int32>& MeshIds)
+	{
+		int32 RunStart = 0;
+		while (RunStart < MeshIds.Num())
+		{
+			int32 RunEnd = RunStart + 1;
+			while (RunEnd < MeshIds.Num() && MeshIds[RunEnd] == MeshIds[RunStart])
+				RunEnd++;
+
+			// Shift by one so empty cells (INDEX_NONE) are stored as 0
+			uint32 Count = RunEnd - RunStart;
+			uint32 StoredId = MeshIds[RunStart] + 1;
+			Ar.SerializeIntPacked(Count);
+			Ar.SerializeIntPacked(StoredId);
+
+			RunStart = RunEnd;
+		}
+	}
+
+	// Write wall types as runs, using the cell run encoding with solid walls stored like empty cells
+	void WriteWallTypeRuns(FArchive& Ar, const FPRGRoomCells& Cells)
+	{
+		TArray<int32> TypeIds;
+		TypeIds.SetNumUninitialized(Cells.WallMeshIds.Num());
+		for (int32 i = 0; i < TypeIds.Num(); i++)
+			TypeIds[i] = int32(Cells.GetWallType(i)) - 1;
+		WriteCellRuns(Ar, TypeIds);
+	}
+
+	// Read cell runs until the presized array is filled. Returns false on corrupt data
+	bool ReadCellRuns(FArchive& Ar, TArray<int32>& MeshIds, int32 PaletteCount)
+	{
+		int32 Filled = 0;
+		while (Filled < MeshIds.Num())
+		{
+			uint32 Count = 0, StoredId = 0;
+			Ar.SerializeIntPacked(Count);
+			Ar.SerializeIntPacked(StoredId);
+
+			if (Ar.IsError() || Count == 0 || Count > uint32(MeshIds.Num() - Filled) || StoredId > uint32(PaletteCount))
+				return false;
+
+			const int32 MeshId = int32(StoredId) - 1;
+			for (uint32 i = 0; i < Count; i++)
+				MeshIds[Filled++] = MeshId;
+		}
+		return true;
+	}
+
+	// Read wall type runs written by WriteWallTypeRuns. Returns false on corrupt data
+	bool ReadWallTypeRuns(FArchive& Ar, FPRGRoomCells& Cells)
+	{
+		TArray<int32> TypeIds;
+		TypeIds.SetNumUninitialized(Cells.WallMeshIds.Num());
+		if (!ReadCellRuns(Ar, TypeIds, int32(EPRGWallType::Count) - 1))
+			return false;
+
+		for (int32 i = 0; i < TypeIds.Num(); i++)
+			Cells.SetWallType(i, EPRGWallType(TypeIds[i] + 1));
+		return true;
+	}
+}
+
+/*
+ * FPRGLayoutWriter implementation
+ */
+
+FPRGLayoutWriter::~FPRGLayoutWriter()
+{
+	if (Writer)
+		Close();
+}
+
+bool FPRGLayoutWriter::Open(const FString& FilePath)
+{
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer)
+	{
+		UE_LOG(LogPRGRoom, Error, TEXT("Unable to create layout file '%s'."), *FilePath);
+		return false;
+	}
+
+	Palette.Reset();
+	RoomCount = 0;
+
+	// Reserve space for the header, which is patched in Close once the palette offset is known
+	uint8 Placeholder[HeaderSize] = {};
+	Writer->Serialize(Placeholder, HeaderSize);
+
+	return !Writer->IsError();
+}
+
+void FPRGLayoutWriter::WriteRoom(const APRG_Room& Room)
+{
+	if (!Writer)
+		return;
+
+	FPRGRoomRecord Record;
+	Record.Location = Room.GetActorLocation();
+	Record.Rotation = Room.GetActorRotation();
+	Room.CaptureCells(Record.Cells, Palette);
+
+	SerializeRecordHeader(*Writer, Record);
+	WriteCellRuns(*Writer, Record.Cells.TileMeshIds);
+	WriteCellRuns(*Writer, Record.Cells.WallMeshIds);
+	WriteWallTypeRuns(*Writer, Record.Cells);
+
+	RoomCount++;
+}
+
+bool FPRGLayoutWriter::Close()
+{
+	if (!Writer)
+		return false;
+
+	// Palette
+	int64 PaletteOffset = Writer->Tell();
+	int32 PaletteCount = Palette.Num();
+	*Writer << PaletteCount;
+	for (const TObjectPtr<UStaticMesh>& Mesh : Palette.Meshes)
+	{
+		FString MeshPath = FSoftObjectPath(Mesh.Get()).ToString();
+		*Writer << MeshPath;
+	}
+
+	// Header
+	uint32 Magic = PRGLayoutFile::Magic;
+	uint32 Version = uint32(PRGLayoutFile::EVersion::Latest);
+	Writer->Seek(0);
+	*Writer << Magic << Version << RoomCount << PaletteOffset;
+
+	const bool bSuccess = Writer->Close() && !Writer->IsError();
+	Writer.Reset();
+
+	return bSuccess;
+}
+
+bool FPRGLayoutWriter::WriteFile(const FString& FilePath, const TArray<TObjectPtr<APRG_Room>>& Rooms)
+{
+	FPRGLayoutWriter LayoutWriter;
+	if (!LayoutWriter.Open(FilePath))
+		return false;
+
+	for (const TObjectPtr<APRG_Room>& Room : Rooms)
+	{
+		if (Room)
+			LayoutWriter.WriteRoom(*Room);
+	}
+
+	return LayoutWriter.Close();
+}
+
+/*
+ * FPRGLayoutReader implementation
+ */
+
+FPRGLayoutReader::~FPRGLayoutReader()
+{
+	if (Reader)
+		Reader->Close();
+}
+
+bool FPRGLayoutReader::Open(const FString& FilePath)
+{
+	Reader.Reset(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader)
+	{
+		UE_LOG(LogPRGRoom, Error, TEXT("Unable to open layout file '%s'."), *FilePath);
+		return false;
+	}
+
+	uint32 Magic = 0;
+	int64 PaletteOffset = 0;
+	*Reader << Magic << FileVersion << RoomCount << PaletteOffset;
+
+	if (Reader->IsError() || Magic != PRGLayoutFile::Magic)
+	{
+		UE_LOG(LogPRGRoom, Error, TEXT("'%s' is not a layout file."), *FilePath);
+		Reader.Reset();
+		return false;
+	}
+	if (FileVersion > uint32(PRGLayoutFile::EVersion::Latest))
+	{
+		UE_LOG(LogPRGRoom, Error, TEXT("Layout file '%s' has version %u, newest supported version is %u."), *FilePath, FileVersion, uint32(PRGLayoutFile::EVersion::Latest));
+		Reader.Reset();
+		return false;
+	}
+	if (RoomCount < 0 || PaletteOffset < HeaderSize || PaletteOffset > Reader->TotalSize())
+	{
+		UE_LOG(LogPRGRoom, Error, TEXT("Layout file '%s' has a corrupt header."), *FilePath);
+		Reader.Reset();
+		return false;
+	}
+
+	// Load palette from the end of the file, then return to the first record
+	Reader->Seek(PaletteOffset);
+	int32 PaletteCount = 0;
+	*Reader << PaletteCount;
+
+	Palette.Reset();
+	for (int32 i = 0; i < PaletteCount && !Reader->IsError(); i++)
+	{
+		FString MeshPath;
+		*Reader << MeshPath;
+
+		// Keep missing meshes as nullptr so indices stay valid. Cells will use fallback meshes instead
+		UStaticMesh* Mesh = Cast<UStaticMesh>(FSoftObjectPath(MeshPath).TryLoad());
+		if (!Mesh)
+			UE_LOG(LogPRGRoom, Warning, TEXT("Layout mesh '%s' not found, using default mesh instead."), *MeshPath);
+		Palette.Meshes.Add(Mesh);
+	}
+
+	Reader->Seek(HeaderSize);
+	RoomsRead = 0;
+
+	return !Reader->IsError();
+}
+
+bool FPRGLayoutReader::ReadRecords(int MaxRecords, TArray<FPRGRoomRecord>& OutRecords)
+{
+	OutRecords.Reset();
+
+	if (!Reader || RoomsRead >= RoomCount)
+		return false;
+
+	const int32 NumToRead = FMath::Min(MaxRecords, RoomCount - RoomsRead);
+	OutRecords.Reserve(NumToRead);
+
+	for (int32 i = 0; i < NumToRead; i++)
+	{
+		FPRGRoomRecord Record;
+		SerializeRecordHeader(*Reader, Record);
+
+		const FIntPoint Size = Record.Cells.RoomSize;
+		if (Reader->IsError() || Size.X <= 0 || Size.Y <= 0 || Size.X > MaxRoomSize || Size.Y > MaxRoomSize || Record.Cells.TileSizeCM <= 0
+			|| Record.Cells.RoomHeight <= 0 || Record.Cells.RoomHeight > MaxRoomHeight)
+		{
+			UE_LOG(LogPRGRoom, Error, TEXT("Corrupt room record %d in layout file, stopped reading."), RoomsRead);
+			Reader.Reset();
+			return OutRecords.Num() > 0;
+		}
+
+		Record.Cells.Init(Size, Record.Cells.RoomHeight, Record.Cells.TileSizeCM);
+		const bool bHasWallTypes = FileVersion >= uint32(PRGLayoutFile::EVersion::WallTypes);
+		if (!ReadCellRuns(*Reader, Record.Cells.TileMeshIds, Palette.Num()) || !ReadCellRuns(*Reader, Record.Cells.WallMeshIds, Palette.Num())
+			|| (bHasWallTypes && !ReadWallTypeRuns(*Reader, Record.Cells)))
+		{
+			UE_LOG(LogPRGRoom, Error, TEXT("Corrupt cell data in room record %d of layout file, stopped reading."), RoomsRead);
+			Reader.Reset();
+			return OutRecords.Num() > 0;
+		}
+
+		OutRecords.Add(MoveTemp(Record));
+		RoomsRead++;
+	}
+
+	return true;
+}
+
+TObjectPtr<APRG_Room> FPRGLayoutReader::SpawnRoom(UWorld* World, const FPRGRoomRecord& Record, UStaticMesh* FallbackFloorMesh, UStaticMesh* FallbackWallMesh) const
+{
+	if (!World)
+		return nullptr;
+
+	const FTransform SpawnLocAndRotation = FTransform(Record.Rotation, Record.Location);
+	TObjectPtr<APRG_Room> NewRoom = World->SpawnActorDeferred<APRG_Room>(APRG_Room::StaticClass(), SpawnLocAndRotation);
+	NewRoom->InitRoom(Record.Cells.RoomSize, Record.Cells.RoomHeight, Record.Cells.TileSizeCM);
+	NewRoom->FinishSpawning(SpawnLocAndRotation);
+	NewRoom->SpawnCells(Record.Cells, Palette, FallbackFloorMesh, FallbackWallMesh);
+
+	return NewRoom;
+}
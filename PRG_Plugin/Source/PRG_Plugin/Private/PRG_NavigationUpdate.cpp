@@ -0,0 +1,48 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_NavigationUpdate.h"
+
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavigationSystem.h"
+#include "PRG_Room.h"
+
+TMap<TWeakObjectPtr<UWorld>, FPRGScopedNavigationUpdate::FWorldScopes> FPRGScopedNavigationUpdate::WorldScopes;
+
+FPRGScopedNavigationUpdate::FPRGScopedNavigationUpdate(APRG_Room* InRoom)
+	: Room(InRoom)
+	, World(InRoom ? InRoom->GetWorld() : nullptr)
+{
+	if (!World.IsValid())
+		return;
+
+	BoundsBefore = InRoom->GetRoomBounds();
+	bInScope = true;
+	WorldScopes.FindOrAdd(World).Depth++;
+}
+
+FPRGScopedNavigationUpdate::~FPRGScopedNavigationUpdate()
+{
+	if (!bInScope)
+		return;
+
+	FWorldScopes* Scopes = WorldScopes.Find(World);
+	if (!Scopes)
+		return;
+
+	Scopes->DirtyBounds += BoundsBefore;
+	if (Room.IsValid())
+		Scopes->DirtyBounds += Room->GetRoomBounds();
+
+	// Nested scopes leave their bounds to the outermost scope
+	if (--Scopes->Depth > 0)
+		return;
+
+	const FBox DirtyBounds = Scopes->DirtyBounds;
+	WorldScopes.Remove(World);
+
+	if (!World.IsValid() || !DirtyBounds.IsValid)
+		return;
+
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World.Get()))
+		NavigationSystem->AddDirtyArea(DirtyBounds, ENavigationDirtyFlag::All);
+}
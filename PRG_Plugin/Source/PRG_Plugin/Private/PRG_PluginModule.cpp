@@ -1,25 +1,6 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
+// Copyright 2022 Steven Weijden
 
-#include "PRG_PluginModule.h"
-#include "PRG_PluginEditorModeCommands.h"
+#include "Modules/ModuleManager.h"
 
-#define LOCTEXT_NAMESPACE "PRG_PluginModule"
-
-void FPRG_PluginModule::StartupModule()
-{
-	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
-
-	FPRG_PluginEditorModeCommands::Register();
-}
-
-void FPRG_PluginModule::ShutdownModule()
-{
-	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
-	// we call this function before unloading the module.
-
-	FPRG_PluginEditorModeCommands::Unregister();
-}
-
-#undef LOCTEXT_NAMESPACE
-
-IMPLEMENT_MODULE(FPRG_PluginModule, PRG_PluginEditorMode)
\ No newline at end of file
+// Rooms, buildings, rendering and culling need no startup code. Editor tools are in the PRG_PluginEditor module
+IMPLEMENT_MODULE(FDefaultModuleImpl, PRG_Plugin)
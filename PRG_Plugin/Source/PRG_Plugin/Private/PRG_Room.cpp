@@ -3,11 +3,66 @@
 #include "PRG_Room.h"
 
 #include "BaseGizmos/TransformGizmoUtil.h"
-#include "Tools/PRG_PluginRoomTool.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BoxElem.h"
+#include "PRG_Building.h"
+#include "PRG_NavigationUpdate.h"
+#include "PRG_RoomCollisionComponent.h"
+#include "PRG_RoomLayout.h"
+#include "PRG_RoomValidator.h"
+#include "PRG_Settings.h"
+#include "Serialization/CustomVersion.h"
+#include "UObject/ObjectSaveContext.h"
 
 // localization namespace
 #define LOCTEXT_NAMESPACE "APRG_Room"
 
+DEFINE_LOG_CATEGORY(LogPRGRoom);
+
+namespace
+{
+	// Versions of the data saved with room actors
+	struct FPRGRoomVersion
+	{
+		enum Type
+		{
+			// Rooms saved before this version took their tile size from the map settings
+			BeforeCustomVersion = 0,
+			StoredTileSize = 1,
+
+			// Add new versions above this line
+			VersionPlusOne,
+			LatestVersion = VersionPlusOne - 1
+		};
+
+		static const FGuid GUID;
+	};
+
+	// Tag of temporary cells, see APRG_Room::SetTemporaryCell
+	const FName TemporaryCellTag(TEXT("PRG_TemporaryCell"));
+
+	const FGuid FPRGRoomVersion::GUID(0x6F1B2C84, 0x3E5D4A17, 0x9C0B7E62, 0xA14D58F3);
+	FCustomVersionRegistration GRegisterPRGRoomVersion(FPRGRoomVersion::GUID, FPRGRoomVersion::LatestVersion, TEXT("PRGRoomVersion"));
+
+	// Cells loaded after their room, e.g. from another streaming cell, change its room collision. Spawned cells are attached only after registering
+	void NotifyCellLoaded(AStaticMeshActor* Cell)
+	{
+		APRG_Room* Room = Cast<APRG_Room>(Cell->GetAttachParentActor());
+		if (Room && Room->HasActorRegisteredAllComponents())
+			Room->OnCellLoaded(Cell);
+	}
+
+	// Cells unloaded by streaming leave their room partially loaded. Destroyed cells were removed by edits of a loaded room
+	void NotifyCellUnloaded(AActor* Cell)
+	{
+		APRG_Room* Room = Cast<APRG_Room>(Cell->GetAttachParentActor());
+		if (Room && !Cell->IsActorBeingDestroyed())
+			Room->OnCellUnloaded();
+	}
+}
+
 // Sets default values
 AWall::AWall()
 {
@@ -15,6 +70,20 @@ AWall::AWall()
 	PrimaryActorTick.bCanEverTick = false;
 }
 
+void AWall::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	NotifyCellLoaded(this);
+}
+
+void AWall::PostUnregisterAllComponents()
+{
+	Super::PostUnregisterAllComponents();
+
+	NotifyCellUnloaded(this);
+}
+
 // Sets default values
 ATile::ATile()
 {
@@ -22,6 +91,22 @@ ATile::ATile()
 	PrimaryActorTick.bCanEverTick = false;
 }
 
+void ATile::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	NotifyCellLoaded(this);
+}
+
+void ATile::PostUnregisterAllComponents()
+{
+	Super::PostUnregisterAllComponents();
+
+	NotifyCellUnloaded(this);
+}
+
+FOnRoomChangedDelegate APRG_Room::OnAnyRoomChanged;
+
 // Sets default values
 APRG_Room::APRG_Room()
 {
@@ -33,50 +118,115 @@ APRG_Room::APRG_Room()
 	RootComponent = BaseComponent;
 }
 
-void APRG_Room::InitRoom(FIntPoint NewSize, int NewHeight)
+void APRG_Room::InitRoom(FIntPoint NewSize, int NewHeight, int NewTileSizeCM)
 {
 	if (NewSize.X > 0 && NewSize.Y > 0)
 		RoomSize = NewSize;
 	if (NewHeight > 0)
 		RoomHeight = NewHeight;
+	if (NewTileSizeCM > 0)
+		TileSizeCM = NewTileSizeCM;
 
-	Tiles.SetNum(RoomSize.X * RoomSize.Y, false);
-	Walls.SetNum((RoomSize.X + 1) * RoomSize.Y + RoomSize.X * (RoomSize.Y + 1), false);
+	Tiles.SetNum(FPRGRoomCells::NumTiles(RoomSize), false);
+	Walls.SetNum(FPRGRoomCells::NumWalls(RoomSize), false);
+	if (WallTypes.Num() > 0)
+		WallTypes.SetNum(FPRGRoomCells::NumWalls(RoomSize), false);
 }
 
 void APRG_Room::CleanupRoom()
 {
-	Tiles.Empty();
-	Walls.Empty();
 	ProxyTransform = nullptr;
 	StoredGizmo = nullptr;
 	OnRoomDeletion.Unbind();
 }
 
+void APRG_Room::NotifyRoomChanged(ERoomChange Change)
+{
+	// Room collision, occluder and opening instances follow the cells before other systems see the change
+	if (Change == ERoomChange::Cells)
+	{
+		UpdateRoomCollision();
+		UpdateRoomOccluder();
+		UpdateOpeningInstances();
+	}
+
+	OnAnyRoomChanged.Broadcast(this, Change);
+}
+
 // Called when the game starts or when spawned
 void APRG_Room::BeginPlay()
 {
 	Super::BeginPlay();
 }
 
-// Called when this actor is explicitly being destroyed during gameplay or in the editor
-void APRG_Room::Destroyed()
+void APRG_Room::PostRegisterAllComponents()
 {
-	OnRoomDeletion.ExecuteIfBound(this);
-	OnRoomDeletion.Unbind();
+	Super::PostRegisterAllComponents();
 
-	for (auto& Tile : Tiles)
+	if (Layout && LayoutInstancesHash == 0)
 	{
-		if (Tile)
-			Tile->Destroy();
+		BindLayout();
+		RebuildLayoutInstances();
 	}
-	Tiles.Empty();
 
-	for (auto& Wall : Walls)
+	// Settings of World Partition maps are in packages of their own, so may only be loaded once the room is in its world
+	if (bLegacyTileSize && GetWorld())
 	{
-		if (Wall)
-			Wall->Destroy();
+		for (const ULevel* Level : GetWorld()->GetLevels())
+		{
+			if (ApplyLegacyTileSize(Level))
+				break;
+		}
 	}
+
+	// Let systems derived from room content pick up rooms that are loaded or streamed in
+	NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void APRG_Room::PostUnregisterAllComponents()
+{
+	NotifyRoomChanged(ERoomChange::Removed);
+
+	Super::PostUnregisterAllComponents();
+}
+
+#if WITH_EDITOR
+void APRG_Room::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(APRG_Room, Layout))
+		SetLayout(Layout);
+	else if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(APRG_Room, bUseRoomCollision))
+		UpdateRoomCollision();
+	else if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(APRG_Room, bUseRoomOccluder))
+		UpdateRoomOccluder();
+	else if (PropertyChangedEvent.GetPropertyName() == "RuntimeGrid" || PropertyChangedEvent.GetPropertyName() == "bIsSpatiallyLoaded" || PropertyChangedEvent.GetPropertyName() == "HLODLayer")
+		PropagateStreamingSettings();
+}
+
+void APRG_Room::PostEditMove(bool bFinished)
+{
+	Super::PostEditMove(bFinished);
+
+	NotifyRoomChanged(ERoomChange::Transform);
+}
+#endif
+
+// Called when this actor is explicitly being destroyed during gameplay or in the editor
+void APRG_Room::Destroyed()
+{
+	OnRoomDeletion.ExecuteIfBound(this);
+	OnRoomDeletion.Unbind();
+
+	if (BoundLayout.IsValid())
+		BoundLayout->OnLayoutChanged.RemoveAll(this);
+	BoundLayout = nullptr;
+
+	NotifyRoomChanged(ERoomChange::Removed);
+
+	DestroyCells();
+	Tiles.Empty();
 	Walls.Empty();
 
 	Super::Destroyed();
@@ -127,112 +277,1132 @@ TArray<TObjectPtr<AWall>>& APRG_Room::GetWalls()
 
 int APRG_Room::GetTileIndexByPosition(FVector Position, int TileSizeCM) const
 {
-	int XPos = int(Position.X);
-	int YPos = int(Position.Y);
-	int QuarterTileSize = TileSizeCM / 4;
+	return FPRGGridLayout(RoomSize, TileSizeCM).TileIndexAt(Position);
+}
 
-	// Tiles are at 0.5 TileSize x and y pos. Check (0.25; 0.75) range by shifting -0.25
-	int IndexX = (XPos - QuarterTileSize) / TileSizeCM;
-	int IndexY = (YPos - QuarterTileSize) / TileSizeCM;
+int APRG_Room::GetWallIndexByPosition(FVector Position, int TileSizeCM) const
+{
+	// See FPRGGridLayout for the index progression of walls
+	return FPRGGridLayout(RoomSize, TileSizeCM).WallIndexAt(Position);
+}
 
-	return IndexX + IndexY * RoomSize.X;
+FVector APRG_Room::GetTilePositionFromIndex(int Index, int TileSizeCM) const
+{
+	return FPRGRoomCells::GetTilePosition(RoomSize, Index, TileSizeCM);
 }
 
-int APRG_Room::GetWallIndexByPosition(FVector Position, int TileSizeCM) const
+FVector APRG_Room::GetWallPositionFromIndex(int Index, int TileSizeCM) const
 {
-	/* Index progression example on a 3x2 grid. First vertical walls, then horizontal walls:
-	 * 
-	 *     0       1      2
-	 *  9     10      11     12
-	 *     3       4      5
-	 * 13     14      15     16
-	 *     6       7      8
-	 */
+	return FPRGRoomCells::GetWallPosition(RoomSize, Index, TileSizeCM);
+}
 
-	/* Index assignment - Set index to nearest index
-	 * 
-	 * Shift to positive axis by 1/4th and check if resulting modulo is less than half
-	 * So for TileSizeCM of 200, at position 400, for position 350-450 consider 400
-	 * Then apply normal division and drop remainder to get index. E.g. Index = 400/200
-	 */
+void APRG_Room::SetTileAtIndex(int Index, TObjectPtr<ATile> NewTile)
+{
+	if (NewTile && Tiles.IsValidIndex(Index))
+		Tiles[Index] = NewTile;
+}
+
+void APRG_Room::SetWallAtIndex(int Index, TObjectPtr<AWall> NewWall)
+{
+	if (NewWall && Walls.IsValidIndex(Index))
+		Walls[Index] = NewWall;
+}
 
-	int XPos = int(Position.X);
-	int YPos = int(Position.Y);
-	int QuarterTileSize = TileSizeCM / 4;
-	int HalfTileSize = TileSizeCM / 2;
+void APRG_Room::SetTemporaryCell(AActor* Cell, bool bTemporary)
+{
+	if (!Cell)
+		return;
 
-	// X-aligned walls at 0.5 TileSize x pos. Check (0.25; 0.75) range by shifting -0.25
-	if ((TileSizeCM + XPos - QuarterTileSize) % TileSizeCM < HalfTileSize)
+	if (bTemporary)
+	{
+		Cell->SetFlags(RF_Transient);
+		Cell->Tags.AddUnique(TemporaryCellTag);
+	}
+	else
 	{
-		int IndexX = (XPos - QuarterTileSize) / TileSizeCM;
-		int IndexY = (YPos + QuarterTileSize) / TileSizeCM;
+		Cell->ClearFlags(RF_Transient);
+		Cell->Tags.Remove(TemporaryCellTag);
+	}
+}
+
+bool APRG_Room::IsTemporaryCell(const AActor* Cell)
+{
+	return Cell && Cell->ActorHasTag(TemporaryCellTag);
+}
+
+FRotator APRG_Room::GetWallRotationByIndex(int Index) const
+{
+	return FPRGRoomCells::GetWallRotation(RoomSize, Index);
+}
+
+TObjectPtr<ATile> APRG_Room::SpawnTile(FVector Position, UStaticMesh* Mesh)
+{
+	FActorSpawnParameters SpawnInfo;
+	TObjectPtr<ATile> NewTile = GetWorld()->SpawnActor<ATile>(Position, FRotator(0.0f, 0.0f, 0.0f), SpawnInfo);
+	NewTile->AttachToActor(this, FAttachmentTransformRules::KeepRelativeTransform);
+	NewTile->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+#if WITH_EDITOR
+	ApplyStreamingSettings(NewTile);
+#endif
+
+	return NewTile;
+}
 
-		return IndexX + IndexY * RoomSize.X;
+TObjectPtr<AWall> APRG_Room::SpawnWall(FVector Position, FRotator Rotation, UStaticMesh* Mesh)
+{
+	FActorSpawnParameters SpawnInfo;
+	TObjectPtr<AWall> NewWall = GetWorld()->SpawnActor<AWall>(Position, Rotation, SpawnInfo);
+	NewWall->AttachToActor(this, FAttachmentTransformRules::KeepRelativeTransform);
+	NewWall->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+#if WITH_EDITOR
+	ApplyStreamingSettings(NewWall);
+#endif
+
+	return NewWall;
+}
+
+void APRG_Room::CaptureCells(FPRGRoomCells& OutCells, FPRGMeshPalette& Palette) const
+{
+	OutCells.Init(RoomSize, RoomHeight, TileSizeCM);
+
+	// Copy shared layout cells, remapping them to the given palette
+	if (Layout)
+	{
+		if (Layout->Cells.IsValid() && Layout->Cells.RoomSize == RoomSize)
+		{
+			for (int i = 0; i < OutCells.TileMeshIds.Num(); i++)
+				OutCells.TileMeshIds[i] = Palette.FindOrAdd(Layout->Palette.GetMesh(Layout->Cells.TileMeshIds[i]));
+			for (int i = 0; i < OutCells.WallMeshIds.Num(); i++)
+				OutCells.WallMeshIds[i] = Palette.FindOrAdd(Layout->Palette.GetMesh(Layout->Cells.WallMeshIds[i]));
+			OutCells.WallTypes = Layout->Cells.WallTypes;
+		}
+		return;
+	}
+
+	// Lambda - Get palette index of the mesh used by a cell actor
+	auto GetMeshId = [&Palette](const AStaticMeshActor* Actor)
+	{
+		if (!Actor || !Actor->GetStaticMeshComponent())
+			return INDEX_NONE;
+		return Palette.FindOrAdd(Actor->GetStaticMeshComponent()->GetStaticMesh());
+	};
+
+	for (int i = 0; i < Tiles.Num() && i < OutCells.TileMeshIds.Num(); i++)
+		OutCells.TileMeshIds[i] = GetMeshId(Tiles[i]);
+
+	for (int i = 0; i < Walls.Num() && i < OutCells.WallMeshIds.Num(); i++)
+		OutCells.WallMeshIds[i] = GetMeshId(Walls[i]);
+
+	for (int i = 0; i < WallTypes.Num() && i < OutCells.WallMeshIds.Num(); i++)
+		OutCells.SetWallType(i, GetWallType(i));
+}
+
+void APRG_Room::SpawnCells(const FPRGRoomCells& Cells, const FPRGMeshPalette& Palette, UStaticMesh* FallbackFloorMesh, UStaticMesh* FallbackWallMesh)
+{
+	FPRGScopedNavigationUpdate NavigationUpdate(this);
+
+	if (!Cells.IsValid() || Cells.RoomSize != RoomSize)
+	{
+		UE_LOG(LogPRGRoom, Warning, TEXT("%s: Cell data does not match room size, skipped spawning cells."), *GetName());
+		return;
+	}
+
+	// Positions of all occupied cells are looked up in one pass before spawning
+	const FPRGGridLayout Grid(RoomSize, TileSizeCM);
+	TArray<int32> Indices;
+	TArray<FVector> Positions;
+
+	for (int i = 0; i < Cells.TileMeshIds.Num(); i++)
+	{
+		if (Cells.TileMeshIds[i] != INDEX_NONE)
+			Indices.Add(i);
 	}
-	// Y-aligned walls at each TileSize x pos. Check (-0.25; 0.25) range by shifting +0.25
-	else //if ((XPos + QuarterTileSize) % TileSizeCM < HalfTileSize)
+	Positions.SetNumUninitialized(Indices.Num());
+	Grid.TilePositions(Indices, Positions);
+	for (int i = 0; i < Indices.Num(); i++)
 	{
-		int IndexX = (XPos + QuarterTileSize) / TileSizeCM;
-		int IndexY = (YPos - QuarterTileSize) / TileSizeCM;
+		UStaticMesh* Mesh = Palette.GetMesh(Cells.TileMeshIds[Indices[i]]);
+		SetTileAtIndex(Indices[i], SpawnTile(Positions[i], Mesh ? Mesh : FallbackFloorMesh));
+	}
 
-		int AddIndex = RoomSize.X * (RoomSize.Y + 1);
-		return AddIndex + IndexX + IndexY * (RoomSize.X + 1);
+	// Doors, windows and openings are rendered by the room, so their slots get no wall actor
+	WallTypes = Cells.WallTypes;
+	Indices.Reset();
+	for (int i = 0; i < Cells.WallMeshIds.Num(); i++)
+	{
+		if (Cells.WallMeshIds[i] != INDEX_NONE && !Cells.IsWallOpening(i))
+			Indices.Add(i);
 	}
+	Positions.SetNumUninitialized(Indices.Num());
+	Grid.WallPositions(Indices, Positions);
+	for (int i = 0; i < Indices.Num(); i++)
+	{
+		UStaticMesh* Mesh = Palette.GetMesh(Cells.WallMeshIds[Indices[i]]);
+		SetWallAtIndex(Indices[i], SpawnWall(Positions[i], Grid.WallRotation(Indices[i]), Mesh ? Mesh : FallbackWallMesh));
+	}
+
+	// Fallback meshes are the defaults of the spawned cells
+	SetDefaultMeshes(FallbackFloorMesh, FallbackWallMesh);
+	NotifyRoomChanged(ERoomChange::Cells);
 }
 
-FVector APRG_Room::GetTilePositionFromIndex(int Index, int TileSizeCM) const
+uint32 APRG_Room::GetContentHash() const
 {
-	int HalfTileSize = TileSizeCM / 2;
-	return FVector(
-		(Index % RoomSize.X) * TileSizeCM + HalfTileSize,
-		(Index / RoomSize.X) * TileSizeCM + HalfTileSize,
-		0.0f
-	);
+	FPRGRoomCells Cells;
+	FPRGMeshPalette Palette;
+	CaptureCells(Cells, Palette);
+	return Cells.GetContentHash(Palette);
 }
 
-FVector APRG_Room::GetWallPositionFromIndex(int Index, int TileSizeCM) const
+void APRG_Room::CaptureRegenerationCells(FPRGRoomCells& OutCells, FPRGMeshPalette& Palette) const
 {
-	int HalfTileSize = TileSizeCM / 2;
-	// X-aligned walls
-	if (Index < RoomSize.X * (RoomSize.Y + 1))
+	OutCells.Init(RoomSize, RoomHeight, TileSizeCM);
+	Palette.Reset();
+	Palette.Meshes.Add(nullptr);
+
+	// Lambda - Get palette index of the mesh used by a cell actor, 0 when it uses the default mesh
+	auto GetMeshId = [&Palette](const AStaticMeshActor* Actor, const TSoftObjectPtr<UStaticMesh>& DefaultMesh)
 	{
-		return FVector(
-			(Index % RoomSize.X) * TileSizeCM + HalfTileSize,
-			(Index / RoomSize.X) * TileSizeCM,
-			0.0f
-		);
+		if (!Actor || !Actor->GetStaticMeshComponent())
+			return INDEX_NONE;
+
+		UStaticMesh* Mesh = Actor->GetStaticMeshComponent()->GetStaticMesh();
+		if (!Mesh || DefaultMesh.ToSoftObjectPath() == FSoftObjectPath(Mesh))
+			return 0;
+		return Palette.FindOrAdd(Mesh);
+	};
+
+	for (int i = 0; i < Tiles.Num() && i < OutCells.TileMeshIds.Num(); i++)
+		OutCells.TileMeshIds[i] = GetMeshId(Tiles[i], BuiltFloorMesh);
+
+	for (int i = 0; i < Walls.Num() && i < OutCells.WallMeshIds.Num(); i++)
+		OutCells.WallMeshIds[i] = GetMeshId(Walls[i], BuiltWallMesh);
+
+	for (int i = 0; i < WallTypes.Num() && i < OutCells.WallMeshIds.Num(); i++)
+		OutCells.SetWallType(i, GetWallType(i));
+}
+
+uint32 APRG_Room::GetRegenerationHash(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh) const
+{
+	FPRGRoomCells Cells;
+	FPRGMeshPalette Palette;
+	CaptureRegenerationCells(Cells, Palette);
+
+	// Default cells hash as cells without a mesh, so the default meshes are hashed on their own
+	uint32 Hash = Cells.GetContentHash(Palette);
+	Hash = HashCombine(Hash, DefaultFloorMesh ? FCrc::StrCrc32(*DefaultFloorMesh->GetPathName()) : 0);
+	Hash = HashCombine(Hash, DefaultWallMesh ? FCrc::StrCrc32(*DefaultWallMesh->GetPathName()) : 0);
+	return Hash;
+}
+
+bool APRG_Room::RegenerateCells(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh, bool bForce)
+{
+	// Cells of a shared layout are regenerated with the layout
+	if (Layout || (!bForce && IsRegenerationCurrent(DefaultFloorMesh, DefaultWallMesh)))
+		return false;
+
+	FPRGRoomCells Cells;
+	FPRGMeshPalette Palette;
+	CaptureRegenerationCells(Cells, Palette);
+
+	// Default cells would lose their actor without a default mesh to build them from
+	if ((!DefaultFloorMesh && Cells.TileMeshIds.Contains(0)) || (!DefaultWallMesh && Cells.WallMeshIds.Contains(0)))
+	{
+		UE_LOG(LogPRGRoom, Warning, TEXT("%s: No default mesh for cells using the default or no mesh, skipped regenerating cells."), *GetName());
+		return false;
 	}
-	// Y-aligned walls
-	else // (RoomSize.X + 1) * SizeY
+
+	FPRGScopedNavigationUpdate NavigationUpdate(this);
+	Modify();
+
+	// Lambda - Give a cell actor the mesh it is built from. Returns true if the mesh changed
+	auto RegenerateCell = [&Palette](AStaticMeshActor* Actor, int32 MeshId, UStaticMesh* DefaultMesh)
 	{
-		Index -= RoomSize.X * (RoomSize.Y + 1);
+		UStaticMesh* Mesh = MeshId == 0 ? DefaultMesh : Palette.GetMesh(MeshId);
+		UStaticMeshComponent* Component = Actor ? Actor->GetStaticMeshComponent() : nullptr;
+		if (!Component || !Mesh || Component->GetStaticMesh() == Mesh)
+			return false;
+
+		Component->Modify();
+		return Component->SetStaticMesh(Mesh);
+	};
+
+	int32 NumChanged = 0;
+	for (int i = 0; i < Tiles.Num() && i < Cells.TileMeshIds.Num(); i++)
+		NumChanged += RegenerateCell(Tiles[i], Cells.TileMeshIds[i], DefaultFloorMesh) ? 1 : 0;
+	for (int i = 0; i < Walls.Num() && i < Cells.WallMeshIds.Num(); i++)
+		NumChanged += RegenerateCell(Walls[i], Cells.WallMeshIds[i], DefaultWallMesh) ? 1 : 0;
+
+	if (DefaultFloorMesh)
+		BuiltFloorMesh = DefaultFloorMesh;
+	if (DefaultWallMesh)
+		BuiltWallMesh = DefaultWallMesh;
+	RegenerationHash = GetRegenerationHash(DefaultFloorMesh, DefaultWallMesh);
 
-		return FVector(
-			(Index % (RoomSize.X + 1)) * TileSizeCM,
-			(Index / (RoomSize.X + 1)) * TileSizeCM + HalfTileSize,
-			0.0f
-		);
+	if (NumChanged > 0)
+		NotifyRoomChanged(ERoomChange::Cells);
+	return NumChanged > 0;
+}
+
+void APRG_Room::SetDefaultMeshes(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh)
+{
+	if (DefaultFloorMesh)
+		BuiltFloorMesh = DefaultFloorMesh;
+	if (DefaultWallMesh)
+		BuiltWallMesh = DefaultWallMesh;
+	RegenerationHash = GetRegenerationHash(BuiltFloorMesh.LoadSynchronous(), BuiltWallMesh.LoadSynchronous());
+}
+
+void APRG_Room::GatherAttachedCells()
+{
+	// Drop saved references first, they can point to cells of another room when only the room actor was duplicated
+	for (auto& Tile : Tiles)
+		Tile = nullptr;
+	for (auto& Wall : Walls)
+		Wall = nullptr;
+
+	TArray<AActor*> ChildActors;
+	GetAttachedActors(ChildActors);
+
+	// Sort the cells by type, then look up the indices of their positions in one pass per type
+	TArray<ATile*> ChildTiles;
+	TArray<AWall*> ChildWalls;
+	TArray<FVector> TilePositions;
+	TArray<FVector> WallPositions;
+	for (auto Child : ChildActors)
+	{
+		if (IsTemporaryCell(Child))
+			continue;
+
+		if (ATile* Tile = Cast<ATile>(Child))
+		{
+			ChildTiles.Add(Tile);
+			TilePositions.Add(Tile->GetStaticMeshComponent()->GetRelativeLocation());
+		}
+		else if (AWall* Wall = Cast<AWall>(Child))
+		{
+			ChildWalls.Add(Wall);
+			WallPositions.Add(Wall->GetStaticMeshComponent()->GetRelativeLocation());
+		}
 	}
+
+	const FPRGGridLayout Grid(RoomSize, TileSizeCM);
+	TArray<int32> Indices;
+	Indices.SetNumUninitialized(ChildTiles.Num());
+	Grid.TileIndicesAt(TilePositions, Indices);
+	for (int i = 0; i < ChildTiles.Num(); i++)
+		SetTileAtIndex(Indices[i], ChildTiles[i]);
+
+	Indices.SetNumUninitialized(ChildWalls.Num());
+	Grid.WallIndicesAt(WallPositions, Indices);
+	for (int i = 0; i < ChildWalls.Num(); i++)
+		SetWallAtIndex(Indices[i], ChildWalls[i]);
 }
 
-void APRG_Room::SetTileAtIndex(int Index, TObjectPtr<ATile> NewTile)
+void APRG_Room::EnsureCellsGathered()
 {
-	if (NewTile && Index < Tiles.Num())
-		Tiles[Index] = NewTile;
+	if (Layout)
+		return;
+
+	bool bValid = Tiles.Num() == FPRGRoomCells::NumTiles(RoomSize) && Walls.Num() == FPRGRoomCells::NumWalls(RoomSize);
+	for (int i = 0; bValid && i < Tiles.Num(); i++)
+		bValid = !Tiles[i] || Tiles[i]->GetAttachParentActor() == this;
+	for (int i = 0; bValid && i < Walls.Num(); i++)
+		bValid = !Walls[i] || Walls[i]->GetAttachParentActor() == this;
+
+	if (bValid)
+		return;
+
+	InitRoom();
+	GatherAttachedCells();
 }
 
-void APRG_Room::SetWallAtIndex(int Index, TObjectPtr<AWall> NewWall)
+void APRG_Room::ResizeCells(FIntPoint NewSize)
 {
-	if (NewWall && Index < Walls.Num())
-		Walls[Index] = NewWall;
+	if (NewSize == RoomSize)
+		return;
+
+	// Move cells to their index in the new size, destroying cells outside of it
+	TArray<TObjectPtr<ATile>> NewTiles;
+	NewTiles.SetNum(FPRGRoomCells::NumTiles(NewSize));
+	for (int i = 0; i < Tiles.Num(); i++)
+	{
+		if (!Tiles[i])
+			continue;
+
+		const int NewIndex = FPRGRoomCells::RemapTileIndex(RoomSize, NewSize, i);
+		if (NewIndex != INDEX_NONE)
+			NewTiles[NewIndex] = Tiles[i];
+		else
+			Tiles[i]->Destroy();
+	}
+
+	TArray<TObjectPtr<AWall>> NewWalls;
+	NewWalls.SetNum(FPRGRoomCells::NumWalls(NewSize));
+	for (int i = 0; i < Walls.Num(); i++)
+	{
+		if (!Walls[i])
+			continue;
+
+		const int NewIndex = FPRGRoomCells::RemapWallIndex(RoomSize, NewSize, i);
+		if (NewIndex != INDEX_NONE)
+			NewWalls[NewIndex] = Walls[i];
+		else
+			Walls[i]->Destroy();
+	}
+
+	// Wall types follow their walls
+	if (WallTypes.Num() > 0)
+	{
+		TArray<EPRGWallType> NewWallTypes;
+		NewWallTypes.Init(EPRGWallType::Solid, FPRGRoomCells::NumWalls(NewSize));
+		for (int i = 0; i < WallTypes.Num(); i++)
+		{
+			const int NewIndex = FPRGRoomCells::RemapWallIndex(RoomSize, NewSize, i);
+			if (NewIndex != INDEX_NONE)
+				NewWallTypes[NewIndex] = WallTypes[i];
+		}
+		WallTypes = MoveTemp(NewWallTypes);
+	}
+
+	Tiles = MoveTemp(NewTiles);
+	Walls = MoveTemp(NewWalls);
+	RoomSize = NewSize;
 }
 
-FRotator APRG_Room::GetWallRotationByIndex(int Index) const
+void APRG_Room::SetCellMeshes(bool bWalls, int32 First, int32 Count, UStaticMesh* Mesh)
+{
+	for (int32 i = First; i < First + Count; i++)
+	{
+		AStaticMeshActor* Cell = nullptr;
+		if (bWalls && Walls.IsValidIndex(i))
+			Cell = Walls[i];
+		else if (!bWalls && Tiles.IsValidIndex(i))
+			Cell = Tiles[i];
+		else
+			break;
+
+		if (!Mesh)
+		{
+			if (Cell)
+				Cell->Destroy();
+			if (bWalls)
+				Walls[i] = nullptr;
+			else
+				Tiles[i] = nullptr;
+		}
+		else if (Cell)
+			Cell->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+		else if (bWalls)
+			Walls[i] = SpawnWall(GetWallPositionFromIndex(i, TileSizeCM), GetWallRotationByIndex(i), Mesh);
+		else
+			Tiles[i] = SpawnTile(GetTilePositionFromIndex(i, TileSizeCM), Mesh);
+
+		// A wall mesh replaces a door, window or opening
+		if (bWalls && Mesh && WallTypes.IsValidIndex(i))
+			WallTypes[i] = EPRGWallType::Solid;
+	}
+}
+
+EPRGWallType APRG_Room::GetWallType(int32 Index) const
 {
-	if (Index < RoomSize.X * (RoomSize.Y + 1))
-		return FRotator(0.0f, 0.0f, 0.0f);
+	if (Layout)
+		return Layout->Cells.GetWallType(Index);
+
+	// Wall actors placed in an opening, e.g. by toggling a temporary wall in the tool, make the slot solid again
+	if (Walls.IsValidIndex(Index) && Walls[Index])
+		return EPRGWallType::Solid;
+
+	return WallTypes.IsValidIndex(Index) ? WallTypes[Index] : EPRGWallType::Solid;
+}
+
+void APRG_Room::SetWallTypes(int32 First, int32 Count, EPRGWallType Type, UStaticMesh* SolidMesh)
+{
+	if (Layout)
+	{
+		UE_LOG(LogPRGRoom, Warning, TEXT("%s: Wall types of a room using a shared layout are set on the layout."), *GetName());
+		return;
+	}
+
+	// Types are only stored once any wall is not solid
+	if (Type != EPRGWallType::Solid && WallTypes.Num() != Walls.Num())
+		WallTypes.SetNum(Walls.Num());
+
+	for (int32 i = First; i < First + Count && Walls.IsValidIndex(i); i++)
+	{
+		if (WallTypes.IsValidIndex(i))
+			WallTypes[i] = Type;
+
+		if (Type != EPRGWallType::Solid)
+		{
+			if (Walls[i])
+				Walls[i]->Destroy();
+			Walls[i] = nullptr;
+		}
+		else if (!Walls[i] && SolidMesh)
+			Walls[i] = SpawnWall(GetWallPositionFromIndex(i, TileSizeCM), GetWallRotationByIndex(i), SolidMesh);
+	}
+}
+
+UStaticMesh* APRG_Room::GetWallTypeMesh(EPRGWallType Type)
+{
+	// Soft pointers keep the resolved mesh, so only the first call per type loads or looks it up, instead of every opening update
+	static const TSoftObjectPtr<UStaticMesh> DoorMesh(FSoftObjectPath(TEXT("/PRG_Plugin/Meshes/SM_PRG_Door.SM_PRG_Door")));
+	static const TSoftObjectPtr<UStaticMesh> WindowMesh(FSoftObjectPath(TEXT("/PRG_Plugin/Meshes/SM_PRG_Window.SM_PRG_Window")));
+
+	const TSoftObjectPtr<UStaticMesh>* Mesh = nullptr;
+	switch (Type)
+	{
+	case EPRGWallType::Door:
+		Mesh = &DoorMesh;
+		break;
+	case EPRGWallType::Window:
+		Mesh = &WindowMesh;
+		break;
+	default:
+		return nullptr;
+	}
+
+	return Mesh->LoadSynchronous();
+}
+
+int32 APRG_Room::ReplaceCellMeshes(bool bWalls, const UStaticMesh* FromMesh, UStaticMesh* ToMesh)
+{
+	if (!ToMesh)
+		return 0;
+
+	FPRGScopedNavigationUpdate NavigationUpdate(this);
+
+	TArray<AStaticMeshActor*> Cells;
+	if (bWalls)
+		Cells.Append(Walls);
+	else
+		Cells.Append(Tiles);
+
+	int32 NumChanged = 0;
+	for (AStaticMeshActor* Cell : Cells)
+	{
+		UStaticMeshComponent* MeshComponent = Cell ? Cell->GetStaticMeshComponent() : nullptr;
+		if (!MeshComponent)
+			continue;
+
+		const UStaticMesh* CurrentMesh = MeshComponent->GetStaticMesh();
+		if (CurrentMesh == ToMesh || (FromMesh && CurrentMesh != FromMesh))
+			continue;
+
+		MeshComponent->SetStaticMesh(ToMesh);
+		Cell->MarkPackageDirty();
+		NumChanged++;
+	}
+
+	// Systems batching this room update once for all swapped cells
+	if (NumChanged > 0)
+		NotifyRoomChanged(ERoomChange::Cells);
+
+	return NumChanged;
+}
+
+int32 APRG_Room::CountCells() const
+{
+	int32 Count = 0;
+	for (const TObjectPtr<ATile>& Tile : Tiles)
+		Count += Tile ? 1 : 0;
+	for (const TObjectPtr<AWall>& Wall : Walls)
+		Count += Wall ? 1 : 0;
+	return Count;
+}
+
+bool APRG_Room::AreCellsLoaded()
+{
+	// Once complete, cells can only change through edits of a fully loaded room, until one of them is unloaded
+	if (!bCellsLoaded)
+		bCellsLoaded = Layout || CountCells() >= SavedCellCount;
+	return bCellsLoaded;
+}
+
+void APRG_Room::OnCellLoaded(AStaticMeshActor* Cell)
+{
+	if (Layout || !Cell->GetStaticMeshComponent() || !GetWorld() || IsTemplate())
+		return;
+
+	// References to cells that were not loaded with the room may not resolve, so cells missing from the arrays are gathered again
+	const FVector CellLocation = Cell->GetStaticMeshComponent()->GetRelativeLocation();
+	if (const ATile* Tile = Cast<ATile>(Cell))
+	{
+		const int Index = GetTileIndexByPosition(CellLocation, TileSizeCM);
+		bCellGatherPending |= !Tiles.IsValidIndex(Index) || Tiles[Index] != Tile;
+	}
+	else if (const AWall* Wall = Cast<AWall>(Cell))
+	{
+		const int Index = GetWallIndexByPosition(CellLocation, TileSizeCM);
+		bCellGatherPending |= !Walls.IsValidIndex(Index) || Walls[Index] != Wall;
+	}
+
+	// Cells streaming in together are applied at once
+	if (bCellLoadPending)
+		return;
+
+	bCellLoadPending = true;
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float)
+	{
+		bCellLoadPending = false;
+		if (bCellGatherPending)
+		{
+			InitRoom();
+			GatherAttachedCells();
+			bCellGatherPending = false;
+		}
+		NotifyRoomChanged(ERoomChange::Cells);
+		return false;
+	}));
+}
+
+void APRG_Room::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	// Repair broken cell references before they are saved. Procedural saves, e.g. when cooking, keep the room as is
+	if (!ObjectSaveContext.IsProceduralSave())
+	{
+		FPRGRoomValidator Validator(true);
+		Validator.ValidateRoom(*this);
+	}
+
+	// Keep the stored count of a partially loaded room, its missing cells still exist on disk
+	if (!Layout && AreCellsLoaded())
+		SavedCellCount = CountCells();
+}
+
+void APRG_Room::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FPRGRoomVersion::GUID);
+}
+
+void APRG_Room::PostLoad()
+{
+	Super::PostLoad();
+
+	// Rooms saved before the tile size was stored still have the class default. Rooms that stored any other size keep it
+	bLegacyTileSize = GetLinkerCustomVersion(FPRGRoomVersion::GUID) < FPRGRoomVersion::StoredTileSize
+		&& TileSizeCM == GetDefault<APRG_Room>()->TileSizeCM;
+	if (bLegacyTileSize)
+		ApplyLegacyTileSize(GetLevel());
+}
+
+bool APRG_Room::ApplyLegacyTileSize(const ULevel* Level)
+{
+	if (!Level)
+		return false;
+
+	for (const AActor* Actor : Level->Actors)
+	{
+		const APRG_Settings* Settings = Cast<APRG_Settings>(Actor);
+		if (!Settings || Settings->TileSize <= 0)
+			continue;
+
+		TileSizeCM = Settings->TileSize * 100;
+		bLegacyTileSize = false;
+		UE_LOG(LogPRGRoom, Log, TEXT("%s: Saved without tile size, using %d cm from the map settings."), *GetName(), TileSizeCM);
+		return true;
+	}
+	return false;
+}
+
+FBox APRG_Room::GetRoomBounds() const
+{
+	// Walls on the border stick out of the grid by half their thickness
+	const FVector Extent = FVector(RoomSize.X * TileSizeCM, RoomSize.Y * TileSizeCM, RoomHeight * 100.0f);
+	return FBox(FVector::ZeroVector, Extent).ExpandBy(TileSizeCM * 0.5f).TransformBy(GetActorTransform());
+}
+
+#if WITH_EDITOR
+FBox APRG_Room::GetStreamingBounds() const
+{
+	const FVector Extent = FVector(RoomSize.X * TileSizeCM, RoomSize.Y * TileSizeCM, RoomHeight * 100.0f);
+	return Super::GetStreamingBounds() + FBox(FVector::ZeroVector, Extent).TransformBy(GetActorTransform());
+}
+
+void APRG_Room::PropagateStreamingSettings()
+{
+	for (const TObjectPtr<ATile>& Tile : Tiles)
+		ApplyStreamingSettings(Tile);
+	for (const TObjectPtr<AWall>& Wall : Walls)
+		ApplyStreamingSettings(Wall);
+}
+
+void APRG_Room::ApplyStreamingSettings(AActor* Cell) const
+{
+	if (!Cell)
+		return;
+
+	// Cells follow the HLOD layer of the room, so a room HLOD builder sees the whole room, see UPRG_RoomHLODBuilder
+	if (Cell->GetRuntimeGrid() != GetRuntimeGrid() || Cell->GetIsSpatiallyLoaded() != GetIsSpatiallyLoaded() || Cell->GetHLODLayer() != GetHLODLayer())
+	{
+		Cell->Modify();
+		Cell->SetRuntimeGrid(GetRuntimeGrid());
+		Cell->SetIsSpatiallyLoaded(GetIsSpatiallyLoaded());
+		Cell->SetHLODLayer(GetHLODLayer());
+	}
+}
+#endif
+
+void APRG_Room::DestroyCells()
+{
+	FPRGScopedNavigationUpdate NavigationUpdate(this);
+
+	for (auto& Tile : Tiles)
+	{
+		if (Tile)
+			Tile->Destroy();
+		Tile = nullptr;
+	}
+
+	for (auto& Wall : Walls)
+	{
+		if (Wall)
+			Wall->Destroy();
+		Wall = nullptr;
+	}
+	NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void APRG_Room::GetCellMeshComponents(TArray<UStaticMeshComponent*>& OutComponents) const
+{
+	for (const TObjectPtr<UInstancedStaticMeshComponent>& OpeningComponent : OpeningComponents)
+	{
+		if (OpeningComponent)
+			OutComponents.Add(OpeningComponent);
+	}
+
+	for (const TObjectPtr<UInstancedStaticMeshComponent>& LayoutComponent : LayoutComponents)
+	{
+		if (LayoutComponent)
+			OutComponents.Add(LayoutComponent);
+	}
+
+	for (const TObjectPtr<AWall>& Wall : Walls)
+	{
+		if (Wall && Wall->GetStaticMeshComponent())
+			OutComponents.Add(Wall->GetStaticMeshComponent());
+	}
+
+	for (const TObjectPtr<ATile>& Tile : Tiles)
+	{
+		if (Tile && Tile->GetStaticMeshComponent())
+			OutComponents.Add(Tile->GetStaticMeshComponent());
+	}
+}
+
+void APRG_Room::GatherCellInstances(TMap<UStaticMesh*, TArray<FTransform>>& OutInstances) const
+{
+	// Doors and windows of all rooms share their mesh, so batching draws them with a few instanced components
+	for (const TObjectPtr<UInstancedStaticMeshComponent>& OpeningComponent : OpeningComponents)
+	{
+		if (!OpeningComponent || !OpeningComponent->GetStaticMesh())
+			continue;
+
+		TArray<FTransform>& MeshInstances = OutInstances.FindOrAdd(OpeningComponent->GetStaticMesh());
+		for (int32 InstanceIndex = 0; InstanceIndex < OpeningComponent->GetInstanceCount(); InstanceIndex++)
+			OpeningComponent->GetInstanceTransform(InstanceIndex, MeshInstances.AddDefaulted_GetRef(), true);
+	}
+
+	// Layout instances are stored in room space
+	if (Layout)
+	{
+		const FTransform RoomTransform = GetActorTransform();
+		for (int32 PaletteIndex = 0; PaletteIndex < Layout->Palette.Num(); PaletteIndex++)
+		{
+			UStaticMesh* Mesh = Layout->Palette.GetMesh(PaletteIndex);
+			const TArray<FTransform>& Instances = Layout->GetInstanceTransforms(PaletteIndex);
+			if (!Mesh || Instances.Num() == 0)
+				continue;
+
+			TArray<FTransform>& MeshInstances = OutInstances.FindOrAdd(Mesh);
+			MeshInstances.Reserve(MeshInstances.Num() + Instances.Num());
+			for (const FTransform& Instance : Instances)
+				MeshInstances.Add(Instance * RoomTransform);
+		}
+		return;
+	}
+
+	// Lambda - Add world transform of a cell actor
+	auto AddCell = [&OutInstances](const AStaticMeshActor* Cell)
+	{
+		if (Cell && Cell->GetStaticMeshComponent() && Cell->GetStaticMeshComponent()->GetStaticMesh())
+			OutInstances.FindOrAdd(Cell->GetStaticMeshComponent()->GetStaticMesh()).Add(Cell->GetStaticMeshComponent()->GetComponentTransform());
+	};
+
+	for (const TObjectPtr<AWall>& Wall : Walls)
+		AddCell(Wall);
+	for (const TObjectPtr<ATile>& Tile : Tiles)
+		AddCell(Tile);
+}
+
+void APRG_Room::SetCellRendering(bool bVisible)
+{
+	// Layout components are only needed while the room renders its own cells
+	const bool bChanged = bCellRendering != bVisible;
+	bCellRendering = bVisible;
+	if (bChanged)
+		UpdateLayoutComponents();
+
+	// Applied every time, so cells spawned since the last call follow as well
+	UpdateRoomVisibility();
+}
+
+void APRG_Room::SetRoomHidden(bool bHidden, ERoomHiddenBy Reason)
+{
+	const ERoomHiddenBy OldHiddenBy = HiddenBy;
+	if (bHidden)
+		EnumAddFlags(HiddenBy, Reason);
 	else
-		return FRotator(0.0f, 90.0f, 0.0f);
+		EnumRemoveFlags(HiddenBy, Reason);
+
+	if (HiddenBy == OldHiddenBy)
+		return;
+
+	UpdateRoomVisibility();
+	NotifyRoomChanged(ERoomChange::Visibility);
+}
+
+void APRG_Room::UpdateRoomVisibility()
+{
+	// Isolation and building levels only declutter the editor viewport, the game keeps rendering those rooms.
+	// Portal culling in the editor viewport only hides temporarily, so it never changes the saved hidden state
+	const bool bGameWorld = GetWorld() && GetWorld()->IsGameWorld();
+	const bool bHiddenInGame = bGameWorld && IsRoomHiddenBy(ERoomHiddenBy::Portals);
+	const bool bHiddenInEditor = IsRoomHidden();
+
+	// Instanced components of the room are not saved, so may be toggled directly
+	for (const TObjectPtr<UInstancedStaticMeshComponent>& OpeningComponent : OpeningComponents)
+	{
+		if (OpeningComponent)
+			OpeningComponent->SetVisibility(bCellRendering);
+	}
+	for (const TObjectPtr<UInstancedStaticMeshComponent>& LayoutComponent : LayoutComponents)
+	{
+		if (LayoutComponent)
+			LayoutComponent->SetVisibility(bCellRendering);
+	}
+
+	// Cell actors are saved, so cells rendered elsewhere are only hidden in game worlds and temporarily in the editor
+	TArray<AActor*> RoomActors = { this };
+	RoomActors.Append(Walls);
+	RoomActors.Append(Tiles);
+	for (AActor* RoomActor : RoomActors)
+	{
+		if (!RoomActor)
+			continue;
+
+		const bool bRenderedElsewhere = RoomActor != this && !bCellRendering;
+		const bool bActorHiddenInGame = bHiddenInGame || (bRenderedElsewhere && bGameWorld);
+		if (RoomActor->IsHidden() != bActorHiddenInGame)
+			RoomActor->SetActorHiddenInGame(bActorHiddenInGame);
+#if WITH_EDITOR
+		RoomActor->SetIsTemporarilyHiddenInEditor(bHiddenInEditor || bRenderedElsewhere);
+#endif
+	}
+}
+
+bool APRG_Room::IsRoomHiddenInWorld() const
+{
+	const bool bGameWorld = GetWorld() && GetWorld()->IsGameWorld();
+	return bGameWorld ? IsRoomHiddenBy(ERoomHiddenBy::Portals) : IsRoomHidden();
+}
+
+APRG_Building* APRG_Room::GetBuilding() const
+{
+	return Cast<APRG_Building>(GetAttachParentActor());
+}
+
+void APRG_Room::UpdateRoomCollision()
+{
+	// Rooms edited cell by cell keep per-cell collision, so the tool can trace single walls and tiles
+	const bool bMergeCollision = bUseRoomCollision && !bExcludedFromBatching && GetWorld() && !IsTemplate();
+	if (bMergeCollision)
+	{
+		if (!RoomCollision)
+		{
+			RoomCollision = NewObject<UPRG_RoomCollisionComponent>(this, NAME_None, RF_Transient);
+			RoomCollision->SetMobility(EComponentMobility::Static);
+			RoomCollision->SetupAttachment(RootComponent);
+			RoomCollision->RegisterComponent();
+			RoomCollisionHash = 0;
+		}
+
+		// Notifications that do not change occupancy or meshes, e.g. when the room is streamed in again, keep the merged boxes
+		FPRGRoomCells Cells;
+		FPRGMeshPalette Palette;
+		CaptureCells(Cells, Palette);
+		const uint32 ContentHash = Cells.GetContentHash(Palette);
+		if (ContentHash != RoomCollisionHash)
+		{
+			RoomCollision->BuildCollision(Cells, Palette);
+			RoomCollisionHash = ContentHash;
+		}
+	}
+	else if (RoomCollision)
+	{
+		RoomCollision->DestroyComponent();
+		RoomCollision = nullptr;
+		RoomCollisionHash = 0;
+	}
+
+	// Lambda - Enable collision of a cell actor only if it is not merged. Cell actors are saved, so their collision is only
+	// turned off in game worlds, which are never saved. Editor worlds also restore cells saved without collision by older versions
+	const bool bGameWorld = GetWorld() && GetWorld()->IsGameWorld();
+	auto ApplyCellCollision = [this, bGameWorld](AStaticMeshActor* Cell)
+	{
+		if (!Cell || !Cell->GetStaticMeshComponent())
+			return;
+
+		const bool bEnableCollision = !bGameWorld || !IsCollisionMerged(Cell->GetStaticMeshComponent()->GetStaticMesh());
+		if (Cell->GetActorEnableCollision() != bEnableCollision)
+			Cell->SetActorEnableCollision(bEnableCollision);
+	};
+
+	for (const TObjectPtr<AWall>& Wall : Walls)
+		ApplyCellCollision(Wall);
+	for (const TObjectPtr<ATile>& Tile : Tiles)
+		ApplyCellCollision(Tile);
+
+	UpdateLayoutComponents();
+}
+
+bool APRG_Room::IsCollisionMerged(const UStaticMesh* Mesh) const
+{
+	FKBoxElem CellBox;
+	return RoomCollision && UPRG_RoomCollisionComponent::GetCellBox(Mesh, CellBox);
+}
+
+void APRG_Room::UpdateRoomOccluder()
+{
+	// Rooms edited cell by cell show the edit materials of the tool, which the depth of the occluder would cover
+	const bool bUseOccluder = bUseRoomOccluder && !bExcludedFromBatching && GetWorld() && !IsTemplate();
+	if (!bUseOccluder)
+	{
+		if (RoomOccluder)
+		{
+			RoomOccluder->DestroyComponent();
+			RoomOccluder = nullptr;
+			RoomOccluderHash = 0;
+		}
+		return;
+	}
+
+	FPRGRoomCells Cells;
+	FPRGMeshPalette Palette;
+	CaptureCells(Cells, Palette);
+	const uint32 ContentHash = Cells.GetContentHash(Palette);
+	if (RoomOccluder && ContentHash == RoomOccluderHash)
+		return;
+
+	static const TSoftObjectPtr<UStaticMesh> OccluderMesh(FSoftObjectPath(TEXT("/Engine/BasicShapes/Cube.Cube")));
+	UStaticMesh* CubeMesh = OccluderMesh.LoadSynchronous();
+	if (!CubeMesh)
+		return;
+
+	if (!RoomOccluder)
+	{
+		// Only rendered to the depth prepass, which the occlusion queries of rooms and actors behind this room test against.
+		// Part of the room actor, so it is hidden with the room, also when the editor only hides the room temporarily
+		RoomOccluder = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+		RoomOccluder->SetMobility(EComponentMobility::Static);
+		RoomOccluder->SetStaticMesh(CubeMesh);
+		RoomOccluder->SetRenderInMainPass(false);
+		RoomOccluder->SetRenderInDepthPass(true);
+		RoomOccluder->SetCastShadow(false);
+		RoomOccluder->bAffectDistanceFieldLighting = false;
+		RoomOccluder->bVisibleInRayTracing = false;
+		RoomOccluder->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		RoomOccluder->SetCanEverAffectNavigation(false);
+		RoomOccluder->bSelectable = false;
+		RoomOccluder->SetupAttachment(RootComponent);
+		RoomOccluder->RegisterComponent();
+	}
+
+	// Doors, windows and other cells that are not a single box are left out, so nothing visible through them is culled
+	TArray<FKBoxElem> Boxes;
+	UPRG_RoomCollisionComponent::MergeCellBoxes(Cells, Palette, Boxes);
+
+	// The cube mesh is 100 cm wide. Boxes are shrunk by 1 cm per side to stay inside the rendered cells
+	TArray<FTransform> Instances;
+	Instances.Reserve(Boxes.Num());
+	for (const FKBoxElem& Box : Boxes)
+	{
+		const FVector BoxSize = FVector(Box.X, Box.Y, Box.Z) - FVector(2.0);
+		if (BoxSize.GetMin() > 0.0)
+			Instances.Emplace(Box.Rotation, Box.Center, BoxSize / 100.0);
+	}
+
+	RoomOccluder->ClearInstances();
+	RoomOccluder->AddInstances(Instances, false);
+	RoomOccluderHash = ContentHash;
+}
+
+void APRG_Room::SetExcludedFromBatching(bool bExclude)
+{
+	if (bExcludedFromBatching == bExclude)
+		return;
+
+	bExcludedFromBatching = bExclude;
+	NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void APRG_Room::SetLayout(UPRG_RoomLayout* NewLayout)
+{
+	Modify();
+	Layout = NewLayout;
+
+	// Cells now come from the layout, so actors would be duplicates
+	if (Layout)
+		DestroyCells();
+
+	BindLayout();
+	RebuildLayoutInstances();
+}
+
+void APRG_Room::BindLayout()
+{
+	if (BoundLayout.Get() == Layout)
+		return;
+
+	if (BoundLayout.IsValid())
+		BoundLayout->OnLayoutChanged.RemoveAll(this);
+
+	BoundLayout = Layout;
+
+	if (Layout)
+		Layout->OnLayoutChanged.AddUObject(this, &APRG_Room::OnLayoutChanged);
+}
+
+void APRG_Room::OnLayoutChanged(UPRG_RoomLayout* ChangedLayout)
+{
+	if (ChangedLayout == Layout)
+		RebuildLayoutInstances();
+}
+
+void APRG_Room::RebuildLayoutInstances()
+{
+	// Layout notifications that do not change its cells, e.g. edits of its properties, keep the instances
+	const uint32 ContentHash = (Layout && Layout->Cells.IsValid()) ? Layout->Cells.GetContentHash(Layout->Palette) : 0;
+	if (ContentHash != 0 && ContentHash == LayoutInstancesHash)
+		return;
+
+	FPRGScopedNavigationUpdate NavigationUpdate(this);
+
+	// Components are created again from the new layout once the room collision was updated
+	for (TObjectPtr<UInstancedStaticMeshComponent>& LayoutComponent : LayoutComponents)
+	{
+		if (LayoutComponent)
+			LayoutComponent->DestroyComponent();
+	}
+	LayoutComponents.Reset();
+	LayoutInstancesHash = ContentHash;
+
+	// Room dimensions follow the layout
+	if (ContentHash != 0)
+		InitRoom(Layout->Cells.RoomSize, Layout->Cells.RoomHeight, Layout->Cells.TileSizeCM);
+
+	NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void APRG_Room::UpdateLayoutComponents()
+{
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> OldComponents = MoveTemp(LayoutComponents);
+	LayoutComponents.Reset();
+
+	// Batched rooms share the layout instances with all rooms of the layout through the renderer. A component per mesh
+	// is only kept while the room renders its own cells, or for meshes whose collision is not part of the room collision
+	if (Layout && LayoutInstancesHash != 0 && GetWorld() && !IsTemplate())
+	{
+		for (int32 PaletteIndex = 0; PaletteIndex < Layout->Palette.Num(); PaletteIndex++)
+		{
+			const TArray<FTransform>& Instances = Layout->GetInstanceTransforms(PaletteIndex);
+			UStaticMesh* Mesh = Layout->Palette.GetMesh(PaletteIndex);
+			if (!Mesh || Instances.Num() == 0 || (!bCellRendering && IsCollisionMerged(Mesh)))
+				continue;
+
+			const int32 OldIndex = OldComponents.IndexOfByPredicate([Mesh](const TObjectPtr<UInstancedStaticMeshComponent>& Component) { return Component && Component->GetStaticMesh() == Mesh; });
+			UInstancedStaticMeshComponent* LayoutComponent = OldIndex != INDEX_NONE ? OldComponents[OldIndex].Get() : nullptr;
+			if (LayoutComponent)
+			{
+				OldComponents.RemoveAtSwap(OldIndex);
+			}
+			else
+			{
+				// Filled from the transforms cached in the shared layout
+				LayoutComponent = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+				LayoutComponent->SetMobility(EComponentMobility::Static);
+				LayoutComponent->SetupAttachment(RootComponent);
+				LayoutComponent->SetStaticMesh(Mesh);
+				LayoutComponent->RegisterComponent();
+				LayoutComponent->AddInstances(Instances, false);
+			}
+
+			LayoutComponent->SetVisibility(bCellRendering);
+			LayoutComponent->SetCollisionEnabled(IsCollisionMerged(Mesh) ? ECollisionEnabled::NoCollision : ECollisionEnabled::QueryAndPhysics);
+			LayoutComponents.Add(LayoutComponent);
+		}
+	}
+
+	for (TObjectPtr<UInstancedStaticMeshComponent>& OldComponent : OldComponents)
+	{
+		if (OldComponent)
+			OldComponent->DestroyComponent();
+	}
+}
+
+void APRG_Room::UpdateOpeningInstances()
+{
+	if (!GetWorld() || IsTemplate())
+		return;
+
+	// Room space transforms of the walls of each type, and a hash of where they are
+	const FPRGGridLayout Grid(RoomSize, TileSizeCM);
+	TArray<FTransform> Instances[uint8(EPRGWallType::Count)];
+	uint32 Hash = HashCombine(GetTypeHash(RoomSize), GetTypeHash(TileSizeCM));
+	for (int32 i = 0; i < Grid.NumWalls(); i++)
+	{
+		const EPRGWallType Type = GetWallType(i);
+		if (Type == EPRGWallType::Solid)
+			continue;
+
+		Instances[uint8(Type)].Emplace(Grid.WallRotation(i), Grid.WallPosition(i));
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(i), GetTypeHash(uint8(Type))));
+	}
+
+	if (Hash == OpeningInstancesHash && OpeningComponents.Num() > 0)
+		return;
+	OpeningInstancesHash = Hash;
+
+	OpeningComponents.SetNum(uint8(EPRGWallType::Count));
+	for (uint8 TypeIndex = 0; TypeIndex < uint8(EPRGWallType::Count); TypeIndex++)
+	{
+		TObjectPtr<UInstancedStaticMeshComponent>& OpeningComponent = OpeningComponents[TypeIndex];
+		UStaticMesh* Mesh = Instances[TypeIndex].Num() > 0 ? GetWallTypeMesh(EPRGWallType(TypeIndex)) : nullptr;
+		if (!Mesh)
+		{
+			if (OpeningComponent)
+				OpeningComponent->DestroyComponent();
+			OpeningComponent = nullptr;
+			continue;
+		}
+
+		if (!OpeningComponent)
+		{
+			OpeningComponent = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+			OpeningComponent->SetMobility(EComponentMobility::Static);
+			OpeningComponent->SetupAttachment(RootComponent);
+			OpeningComponent->SetStaticMesh(Mesh);
+			OpeningComponent->RegisterComponent();
+		}
+
+		OpeningComponent->ClearInstances();
+		OpeningComponent->AddInstances(Instances[TypeIndex], false);
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,175 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomCells.h"
+
+#include "Engine/StaticMesh.h"
+#include "PRG_GridLayout.h"
+
+int32 FPRGMeshPalette::FindOrAdd(UStaticMesh* Mesh)
+{
+	if (!Mesh)
+		return INDEX_NONE;
+
+	// Lookup is not serialized, so rebuild it when the palette was loaded or edited directly
+	if (Lookup.Num() != Meshes.Num())
+	{
+		Lookup.Reset();
+		for (int32 i = 0; i < Meshes.Num(); i++)
+			Lookup.Add(Meshes[i], i);
+	}
+
+	if (const int32* FoundIndex = Lookup.Find(Mesh))
+		return *FoundIndex;
+
+	const int32 NewIndex = Meshes.Add(Mesh);
+	Lookup.Add(Mesh, NewIndex);
+	return NewIndex;
+}
+
+UStaticMesh* FPRGMeshPalette::GetMesh(int32 Index) const
+{
+	return Meshes.IsValidIndex(Index) ? Meshes[Index].Get() : nullptr;
+}
+
+void FPRGMeshPalette::Reset()
+{
+	Meshes.Reset();
+	Lookup.Reset();
+}
+
+void FPRGRoomCells::Init(FIntPoint NewSize, int NewHeight, int NewTileSizeCM)
+{
+	RoomSize = NewSize;
+	RoomHeight = NewHeight;
+	TileSizeCM = NewTileSizeCM;
+
+	TileMeshIds.Init(INDEX_NONE, NumTiles(RoomSize));
+	WallMeshIds.Init(INDEX_NONE, NumWalls(RoomSize));
+	WallTypes.Reset();
+}
+
+bool FPRGRoomCells::IsValid() const
+{
+	return RoomSize.X > 0 && RoomSize.Y > 0 && TileSizeCM > 0
+		&& TileMeshIds.Num() == NumTiles(RoomSize)
+		&& WallMeshIds.Num() == NumWalls(RoomSize)
+		&& (WallTypes.Num() == 0 || WallTypes.Num() == NumWalls(RoomSize));
+}
+
+void FPRGRoomCells::Resize(FIntPoint NewSize)
+{
+	if (NewSize == RoomSize)
+		return;
+
+	TArray<int32> NewTileMeshIds, NewWallMeshIds;
+	NewTileMeshIds.Init(INDEX_NONE, NumTiles(NewSize));
+	NewWallMeshIds.Init(INDEX_NONE, NumWalls(NewSize));
+	TArray<EPRGWallType> NewWallTypes;
+	if (WallTypes.Num() > 0)
+		NewWallTypes.Init(EPRGWallType::Solid, NumWalls(NewSize));
+
+	for (int i = 0; i < TileMeshIds.Num(); i++)
+	{
+		const int NewIndex = RemapTileIndex(RoomSize, NewSize, i);
+		if (NewIndex != INDEX_NONE)
+			NewTileMeshIds[NewIndex] = TileMeshIds[i];
+	}
+	for (int i = 0; i < WallMeshIds.Num(); i++)
+	{
+		const int NewIndex = RemapWallIndex(RoomSize, NewSize, i);
+		if (NewIndex != INDEX_NONE)
+		{
+			NewWallMeshIds[NewIndex] = WallMeshIds[i];
+			if (NewWallTypes.Num() > 0)
+				NewWallTypes[NewIndex] = GetWallType(i);
+		}
+	}
+
+	RoomSize = NewSize;
+	TileMeshIds = MoveTemp(NewTileMeshIds);
+	WallMeshIds = MoveTemp(NewWallMeshIds);
+	WallTypes = MoveTemp(NewWallTypes);
+}
+
+uint32 FPRGRoomCells::GetContentHash(const FPRGMeshPalette& Palette) const
+{
+	// Empty cells hash to 0, occupied cells whose mesh is missing to 1
+	TArray<uint32> MeshHashes;
+	MeshHashes.SetNumUninitialized(Palette.Num());
+	for (int32 i = 0; i < Palette.Num(); i++)
+	{
+		const UStaticMesh* Mesh = Palette.GetMesh(i);
+		MeshHashes[i] = Mesh ? FCrc::StrCrc32(*Mesh->GetPathName()) : 1;
+	}
+
+	// Lambda - Get hash of the mesh of a cell
+	auto GetMeshHash = [&MeshHashes](int32 MeshId) -> uint32
+	{
+		if (MeshId == INDEX_NONE)
+			return 0;
+		return MeshHashes.IsValidIndex(MeshId) ? MeshHashes[MeshId] : 1;
+	};
+
+	uint32 Hash = HashCombine(GetTypeHash(RoomSize), GetTypeHash(RoomHeight));
+	Hash = HashCombine(Hash, GetTypeHash(TileSizeCM));
+	for (const int32 MeshId : TileMeshIds)
+		Hash = HashCombine(Hash, GetMeshHash(MeshId));
+	for (int32 i = 0; i < WallMeshIds.Num(); i++)
+	{
+		Hash = HashCombine(Hash, GetMeshHash(WallMeshIds[i]));
+		// Solid walls add nothing, so hashes of cells stored before wall types existed stay the same
+		if (IsWallOpening(i))
+			Hash = HashCombine(Hash, GetTypeHash(uint8(GetWallType(i))));
+	}
+	return Hash;
+}
+
+void FPRGRoomCells::SetWallType(int Index, EPRGWallType Type)
+{
+	if (!WallMeshIds.IsValidIndex(Index) || GetWallType(Index) == Type)
+		return;
+
+	if (WallTypes.Num() != WallMeshIds.Num())
+		WallTypes.Init(EPRGWallType::Solid, WallMeshIds.Num());
+	WallTypes[Index] = Type;
+}
+
+FVector FPRGRoomCells::GetTilePosition(FIntPoint Size, int Index, int TileSizeCM)
+{
+	return FPRGGridLayout(Size, TileSizeCM).TilePosition(Index);
+}
+
+FVector FPRGRoomCells::GetWallPosition(FIntPoint Size, int Index, int TileSizeCM)
+{
+	return FPRGGridLayout(Size, TileSizeCM).WallPosition(Index);
+}
+
+FRotator FPRGRoomCells::GetWallRotation(FIntPoint Size, int Index)
+{
+	return FPRGGridLayout(Size, 0).WallRotation(Index);
+}
+
+int FPRGRoomCells::RemapTileIndex(FIntPoint OldSize, FIntPoint NewSize, int Index)
+{
+	return FPRGGridLayout(OldSize, 0).RemapTileIndex(Index, FPRGGridLayout(NewSize, 0));
+}
+
+int FPRGRoomCells::RemapWallIndex(FIntPoint OldSize, FIntPoint NewSize, int Index)
+{
+	return FPRGGridLayout(OldSize, 0).RemapWallIndex(Index, FPRGGridLayout(NewSize, 0));
+}
+
+bool FPRGRoomCells::IsExteriorWall(FIntPoint Size, int Index)
+{
+	return FPRGGridLayout(Size, 0).IsExteriorWall(Index);
+}
+
+void FPRGRoomCells::GetTileNeighbours(FIntPoint Size, int Index, TArray<int>& OutNeighbours)
+{
+	FPRGGridLayout(Size, 0).GetTileNeighbours(Index, OutNeighbours);
+}
+
+void FPRGRoomCells::GetWallNeighbours(FIntPoint Size, int Index, TArray<int>& OutNeighbours)
+{
+	FPRGGridLayout(Size, 0).GetWallNeighbours(Index, OutNeighbours);
+}
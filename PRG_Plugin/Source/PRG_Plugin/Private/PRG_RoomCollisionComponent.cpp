@@ -0,0 +1,201 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomCollisionComponent.h"
+
+#include "AI/NavigationSystemBase.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "PRG_RoomCells.h"
+
+namespace
+{
+	// Allowed gap in cm between a cell box and the cell border for neighbouring boxes to merge
+	constexpr float SpanTolerance = 1.0f;
+
+	// Check if a box covers the full cell along one local axis, so it touches the box of the next cell
+	bool SpansCell(double Center, double Size, double TileSize)
+	{
+		return Center - Size * 0.5f <= -TileSize * 0.5f + SpanTolerance
+			&& Center + Size * 0.5f >= TileSize * 0.5f - SpanTolerance;
+	}
+
+	// Stretch the box of the first cell over CountX by CountY cells, and move it from cell space to room space
+	FKBoxElem MakeMergedBox(const FKBoxElem& CellBox, const FTransform& CellTransform, int CountX, int CountY, float TileSize)
+	{
+		const float ExtraX = (CountX - 1) * TileSize;
+		const float ExtraY = (CountY - 1) * TileSize;
+
+		FKBoxElem MergedBox = CellBox;
+		MergedBox.X = CellBox.X + ExtraX;
+		MergedBox.Y = CellBox.Y + ExtraY;
+		MergedBox.Center = CellTransform.TransformPosition(CellBox.Center + FVector(ExtraX * 0.5f, ExtraY * 0.5f, 0.0f));
+		MergedBox.Rotation = CellTransform.Rotator();
+		return MergedBox;
+	}
+}
+
+UPRG_RoomCollisionComponent::UPRG_RoomCollisionComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Block like the cell actors it replaces
+	SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	SetGenerateOverlapEvents(false);
+	bHiddenInGame = true;
+}
+
+int32 UPRG_RoomCollisionComponent::BuildCollision(const FPRGRoomCells& Cells, const FPRGMeshPalette& Palette)
+{
+	if (!RoomBodySetup)
+	{
+		RoomBodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+		RoomBodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		RoomBodySetup->bNeverNeedsCookedCollisionData = true;
+		RoomBodySetup->BodySetupGuid = FGuid::NewGuid();
+	}
+
+	FKAggregateGeom& Geometry = RoomBodySetup->AggGeom;
+	Geometry.EmptyElements();
+	MergeCellBoxes(Cells, Palette, Geometry.BoxElems);
+
+	// Bodies are created from the body setup, so recreate it for the new boxes
+	RecreatePhysicsState();
+	UpdateBounds();
+	// Navigation gathers geometry from the body setup, so it needs the new boxes as well
+	FNavigationSystem::UpdateComponentData(*this);
+
+	return Geometry.BoxElems.Num();
+}
+
+void UPRG_RoomCollisionComponent::MergeCellBoxes(const FPRGRoomCells& Cells, const FPRGMeshPalette& Palette, TArray<FKBoxElem>& OutBoxes)
+{
+	if (!Cells.IsValid())
+		return;
+
+	const FIntPoint Size = Cells.RoomSize;
+	const float TileSize = Cells.TileSizeCM;
+	const FPRGGridLayout Grid(Size, Cells.TileSizeCM);
+
+	// Cell box per palette entry, looked up once per mesh
+	TMap<int32, TOptional<FKBoxElem>> CellBoxes;
+	auto FindCellBox = [&CellBoxes, &Palette](int32 MeshId) -> const FKBoxElem*
+	{
+		if (MeshId == INDEX_NONE)
+			return nullptr;
+
+		TOptional<FKBoxElem>* CellBox = CellBoxes.Find(MeshId);
+		if (!CellBox)
+		{
+			CellBox = &CellBoxes.Add(MeshId);
+			FKBoxElem Box;
+			if (GetCellBox(Palette.GetMesh(MeshId), Box))
+				*CellBox = Box;
+		}
+		return CellBox->GetPtrOrNull();
+	};
+
+	// Lambda - Add one box per run of equal walls along a line. Walls run along their local X axis
+	auto AddWallLine = [&](int NumSteps, TFunctionRef<int(int)> GetWallIndex)
+	{
+		for (int Step = 0; Step < NumSteps;)
+		{
+			const int First = GetWallIndex(Step);
+			// Doors and windows collide through their own instances
+			const int32 MeshId = Cells.IsWallOpening(First) ? INDEX_NONE : Cells.WallMeshIds[First];
+			const FKBoxElem* CellBox = FindCellBox(MeshId);
+			if (!CellBox)
+			{
+				Step++;
+				continue;
+			}
+
+			int RunLength = 1;
+			if (SpansCell(CellBox->Center.X, CellBox->X, TileSize))
+			{
+				while (Step + RunLength < NumSteps && Cells.WallMeshIds[GetWallIndex(Step + RunLength)] == MeshId && !Cells.IsWallOpening(GetWallIndex(Step + RunLength)))
+					RunLength++;
+			}
+
+			const FTransform CellTransform(Grid.WallRotation(First), Grid.WallPosition(First));
+			OutBoxes.Add(MakeMergedBox(*CellBox, CellTransform, RunLength, 1, TileSize));
+			Step += RunLength;
+		}
+	};
+
+	// X-aligned walls run along rows, Y-aligned walls along columns
+	for (int Y = 0; Y <= Size.Y; Y++)
+		AddWallLine(Size.X, [&](int Step) { return Grid.XWallIndex(Step, Y); });
+	for (int X = 0; X <= Size.X; X++)
+		AddWallLine(Size.Y, [&](int Step) { return Grid.YWallIndex(X, Step); });
+
+	// Greedily grow rectangles of equal tiles, first along X, then along Y
+	TBitArray<> Covered(false, Cells.TileMeshIds.Num());
+	for (int Index = 0; Index < Cells.TileMeshIds.Num(); Index++)
+	{
+		const int32 MeshId = Cells.TileMeshIds[Index];
+		const FKBoxElem* CellBox = Covered[Index] ? nullptr : FindCellBox(MeshId);
+		if (!CellBox)
+			continue;
+
+		// Lambda - Check if a tile can join the rectangle
+		auto CanMerge = [&](int TileIndex) { return !Covered[TileIndex] && Cells.TileMeshIds[TileIndex] == MeshId; };
+
+		const int X = Grid.TileX(Index);
+		const int Y = Grid.TileY(Index);
+		int Width = 1;
+		int Height = 1;
+		if (SpansCell(CellBox->Center.X, CellBox->X, TileSize))
+		{
+			while (X + Width < Size.X && CanMerge(Index + Width))
+				Width++;
+		}
+		if (SpansCell(CellBox->Center.Y, CellBox->Y, TileSize))
+		{
+			for (bool bRowMatches = true; bRowMatches && Y + Height < Size.Y; )
+			{
+				const int RowStart = Index + Height * Size.X;
+				for (int i = 0; bRowMatches && i < Width; i++)
+					bRowMatches = CanMerge(RowStart + i);
+				if (bRowMatches)
+					Height++;
+			}
+		}
+
+		for (int j = 0; j < Height; j++)
+		{
+			for (int i = 0; i < Width; i++)
+				Covered[Index + i + j * Size.X] = true;
+		}
+
+		const FTransform CellTransform(Grid.TilePosition(Index));
+		OutBoxes.Add(MakeMergedBox(*CellBox, CellTransform, Width, Height, TileSize));
+	}
+}
+
+int32 UPRG_RoomCollisionComponent::NumBoxes() const
+{
+	return RoomBodySetup ? RoomBodySetup->AggGeom.BoxElems.Num() : 0;
+}
+
+bool UPRG_RoomCollisionComponent::GetCellBox(const UStaticMesh* Mesh, FKBoxElem& OutBox)
+{
+	const UBodySetup* BodySetup = Mesh ? Mesh->GetBodySetup() : nullptr;
+	if (!BodySetup || BodySetup->CollisionTraceFlag == CTF_UseComplexAsSimple)
+		return false;
+
+	const FKAggregateGeom& Geometry = BodySetup->AggGeom;
+	if (Geometry.GetElementCount() != 1 || Geometry.BoxElems.Num() != 1 || !Geometry.BoxElems[0].Rotation.IsNearlyZero())
+		return false;
+
+	OutBox = Geometry.BoxElems[0];
+	return true;
+}
+
+FBoxSphereBounds UPRG_RoomCollisionComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (RoomBodySetup && RoomBodySetup->AggGeom.GetElementCount() > 0)
+		return FBoxSphereBounds(RoomBodySetup->AggGeom.CalcAABB(LocalToWorld));
+
+	return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+}
@@ -0,0 +1,220 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomCost.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "StaticMeshResources.h"
+#include "PRG_Room.h"
+#include "PRG_RoomCollisionComponent.h"
+#include "PRG_RoomLayout.h"
+
+DEFINE_LOG_CATEGORY(LogPRGCost);
+
+namespace
+{
+	// Triangles of the first LOD of a mesh, or 0 if the mesh has no render data, e.g. in a commandlet without rendering
+	int32 GetLOD0Triangles(const UStaticMesh* Mesh)
+	{
+		const FStaticMeshRenderData* RenderData = Mesh ? Mesh->GetRenderData() : nullptr;
+		if (!RenderData || RenderData->LODResources.Num() == 0)
+			return 0;
+
+		return RenderData->LODResources[0].GetNumTriangles();
+	}
+
+	// Count an actor and its components
+	void AddActor(FPRGRoomCost& Cost, const AActor* Actor)
+	{
+		if (!Actor)
+			return;
+
+		Cost.Actors++;
+		Cost.Components += Actor->GetComponents().Num();
+	}
+
+	void RunRoomCostReport(const TArray<FString>& Args, UWorld* World)
+	{
+		FPRGRoomCostReport& Report = FPRGRoomCostReport::Get();
+		Report.LogReport(World);
+
+		if (Args.Num() > 0)
+			Report.ExportCsv(World, Args[0].Equals(TEXT("csv"), ESearchCase::IgnoreCase) ? FPRGRoomCostReport::GetDefaultCsvPath(World) : Args[0]);
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs RoomCostReportCommand(
+		TEXT("PRG.RoomCostReport"),
+		TEXT("Log actors, components, instances, meshes, materials, triangles, collision bodies and cell data of every room. ")
+		TEXT("Pass a file path, or 'csv' for the Saved/PRG folder, to also write the report as CSV"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunRoomCostReport));
+}
+
+FPRGRoomCost FPRGRoomCost::Compute(APRG_Room& Room)
+{
+	FPRGRoomCost Cost;
+
+	AddActor(Cost, &Room);
+	for (const TObjectPtr<AWall>& Wall : Room.GetWalls())
+		AddActor(Cost, Wall);
+	for (const TObjectPtr<ATile>& Tile : Room.GetTiles())
+		AddActor(Cost, Tile);
+
+	TArray<UStaticMeshComponent*> CellComponents;
+	Room.GetCellMeshComponents(CellComponents);
+	for (const UStaticMeshComponent* CellComponent : CellComponents)
+	{
+		const UStaticMesh* Mesh = CellComponent->GetStaticMesh();
+		if (!Mesh)
+			continue;
+
+		const UInstancedStaticMeshComponent* InstancedComponent = Cast<UInstancedStaticMeshComponent>(CellComponent);
+		const int32 NumInstances = InstancedComponent ? InstancedComponent->GetInstanceCount() : 1;
+
+		Cost.Instances += NumInstances;
+		Cost.Triangles += int64(GetLOD0Triangles(Mesh)) * NumInstances;
+		Cost.Meshes.Add(FObjectKey(Mesh));
+
+		// Materials of the mesh asset, not the component, so edit mode materials swapped in by the tool do not change the cost
+		for (const FStaticMaterial& StaticMaterial : Mesh->GetStaticMaterials())
+		{
+			if (StaticMaterial.MaterialInterface)
+				Cost.Materials.Add(FObjectKey(StaticMaterial.MaterialInterface));
+		}
+
+		// Instanced components create a body per instance
+		if (CellComponent->IsCollisionEnabled())
+			Cost.CollisionBodies += NumInstances;
+	}
+
+	// The room collision is a single body holding all merged boxes
+	const UPRG_RoomCollisionComponent* RoomCollision = Room.GetRoomCollision();
+	if (RoomCollision && RoomCollision->NumBoxes() > 0)
+	{
+		Cost.CollisionBodies++;
+		Cost.Objects++;
+	}
+	Cost.Objects += Cost.Actors + Cost.Components;
+
+	Cost.CellDataBytes = Room.GetWalls().GetAllocatedSize() + Room.GetTiles().GetAllocatedSize();
+	if (const UPRG_RoomLayout* Layout = Room.GetLayout())
+		Cost.CellDataBytes += Layout->Cells.TileMeshIds.GetAllocatedSize() + Layout->Cells.WallMeshIds.GetAllocatedSize() + Layout->Cells.WallTypes.GetAllocatedSize();
+
+	return Cost;
+}
+
+void FPRGRoomCost::Accumulate(const FPRGRoomCost& Other)
+{
+	Actors += Other.Actors;
+	Components += Other.Components;
+	Objects += Other.Objects;
+	Instances += Other.Instances;
+	Triangles += Other.Triangles;
+	CollisionBodies += Other.CollisionBodies;
+	CellDataBytes += Other.CellDataBytes;
+	Meshes.Append(Other.Meshes);
+	Materials.Append(Other.Materials);
+}
+
+FPRGRoomCostReport& FPRGRoomCostReport::Get()
+{
+	static FPRGRoomCostReport Report;
+	return Report;
+}
+
+FPRGRoomCostReport::FPRGRoomCostReport()
+{
+	RoomChangedHandle = APRG_Room::OnAnyRoomChanged.AddRaw(this, &FPRGRoomCostReport::OnRoomChanged);
+}
+
+FPRGRoomCostReport::~FPRGRoomCostReport()
+{
+	APRG_Room::OnAnyRoomChanged.Remove(RoomChangedHandle);
+}
+
+const FPRGRoomCost& FPRGRoomCostReport::GetRoomCost(APRG_Room& Room)
+{
+	if (const FPRGRoomCost* CachedCost = CachedCosts.Find(&Room))
+		return *CachedCost;
+
+	return CachedCosts.Add(&Room, FPRGRoomCost::Compute(Room));
+}
+
+void FPRGRoomCostReport::Gather(UWorld* World, TArray<FRow>& OutRows, FPRGRoomCost& OutTotal)
+{
+	if (!World)
+		return;
+
+	for (TActorIterator<APRG_Room> It(World); It; ++It)
+	{
+		APRG_Room* Room = *It;
+		if (!IsValid(Room))
+			continue;
+
+		const FPRGRoomCost& Cost = GetRoomCost(*Room);
+		OutTotal.Accumulate(Cost);
+		OutRows.Add({ Room->GetActorNameOrLabel(), Cost });
+	}
+
+	OutRows.Sort([](const FRow& A, const FRow& B) { return A.Name < B.Name; });
+}
+
+void FPRGRoomCostReport::LogReport(UWorld* World)
+{
+	TArray<FRow> Rows;
+	FPRGRoomCost Total;
+	Gather(World, Rows, Total);
+
+	auto LogRow = [](const FString& Name, const FPRGRoomCost& Cost)
+	{
+		UE_LOG(LogPRGCost, Display, TEXT("%-32s %6d actors %6d components %6d objects %7d instances %4d meshes %4d materials %10lld triangles %6d bodies %8lld bytes"),
+			*Name, Cost.Actors, Cost.Components, Cost.Objects, Cost.Instances, Cost.Meshes.Num(), Cost.Materials.Num(), Cost.Triangles, Cost.CollisionBodies, Cost.CellDataBytes);
+	};
+
+	for (const FRow& Row : Rows)
+		LogRow(Row.Name, Row.Cost);
+	LogRow(FString::Printf(TEXT("Total (%d rooms)"), Rows.Num()), Total);
+}
+
+bool FPRGRoomCostReport::ExportCsv(UWorld* World, const FString& Path)
+{
+	TArray<FRow> Rows;
+	FPRGRoomCost Total;
+	Gather(World, Rows, Total);
+
+	FString Csv = TEXT("Room,Actors,Components,Objects,Instances,Meshes,Materials,Triangles,CollisionBodies,CellDataBytes\n");
+	auto AddRow = [&Csv](const FString& Name, const FPRGRoomCost& Cost)
+	{
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%d,%lld,%d,%lld\n"),
+			*Name, Cost.Actors, Cost.Components, Cost.Objects, Cost.Instances, Cost.Meshes.Num(), Cost.Materials.Num(), Cost.Triangles, Cost.CollisionBodies, Cost.CellDataBytes);
+	};
+
+	for (const FRow& Row : Rows)
+		AddRow(Row.Name.Replace(TEXT(","), TEXT("_")), Row.Cost);
+	AddRow(TEXT("Total"), Total);
+
+	if (!FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogPRGCost, Warning, TEXT("Could not write room cost report to %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogPRGCost, Display, TEXT("Wrote room cost report of %d rooms to %s"), Rows.Num(), *Path);
+	return true;
+}
+
+FString FPRGRoomCostReport::GetDefaultCsvPath(UWorld* World)
+{
+	const FString MapName = World ? UWorld::RemovePIEPrefix(World->GetMapName()) : FString(TEXT("Unknown"));
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PRG"), MapName + TEXT("_RoomCost.csv"));
+}
+
+void FPRGRoomCostReport::OnRoomChanged(APRG_Room* Room, ERoomChange Change)
+{
+	// Moving, hiding or showing a room does not change its cost
+	if (Change == ERoomChange::Cells || Change == ERoomChange::Removed)
+		CachedCosts.Remove(Room);
+}
@@ -0,0 +1,86 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomHLODBuilder.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "PRG_Room.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPRGHLOD, Log, All);
+
+#if WITH_EDITOR
+uint32 UPRG_RoomHLODBuilderSettings::GetCRC() const
+{
+	return HashCombine(Super::GetCRC(), GetTypeHash(bUseBakedMeshes));
+}
+
+TSubclassOf<UHLODBuilderSettings> UPRG_RoomHLODBuilder::GetSettingsClass() const
+{
+	return UPRG_RoomHLODBuilderSettings::StaticClass();
+}
+
+uint32 UPRG_RoomHLODBuilder::ComputeHLODHash(const UActorComponent* InSourceComponent) const
+{
+	// Rebaking a room changes its proxy without touching any cell component
+	const APRG_Room* Room = GetSourceRoom(InSourceComponent);
+	const UStaticMesh* BakedMesh = Room ? Room->GetBakedMesh() : nullptr;
+	return HashCombine(Super::ComputeHLODHash(InSourceComponent), BakedMesh ? FCrc::StrCrc32(*BakedMesh->GetPathName()) : 0);
+}
+
+TArray<UActorComponent*> UPRG_RoomHLODBuilder::Build(const FHLODBuildContext& InHLODBuildContext, const TArray<UActorComponent*>& InSourceComponents) const
+{
+	const UPRG_RoomHLODBuilderSettings* Settings = Cast<UPRG_RoomHLODBuilderSettings>(HLODBuilderSettings);
+	const bool bUseBakedMeshes = !Settings || Settings->bUseBakedMeshes;
+
+	// Source components only tell which rooms are part of this HLOD, proxies are built from the cell data of the rooms
+	TSet<APRG_Room*> Rooms;
+	for (const UActorComponent* SourceComponent : InSourceComponents)
+	{
+		if (APRG_Room* Room = GetSourceRoom(SourceComponent))
+			Rooms.Add(Room);
+		else if (SourceComponent)
+			UE_LOG(LogPRGHLOD, Warning, TEXT("%s is not part of a room and is left out of the room HLOD. Assign the layer to rooms only."), *SourceComponent->GetOwner()->GetName());
+	}
+
+	TArray<UActorComponent*> HLODComponents;
+	TMap<UStaticMesh*, TArray<FTransform>> Instances;
+	for (APRG_Room* Room : Rooms)
+	{
+		if (bUseBakedMeshes && Room->IsBakedMeshCurrent(Room->GetContentHash()))
+		{
+			// Baked meshes are in room space
+			UStaticMeshComponent* BakedComponent = NewObject<UStaticMeshComponent>();
+			BakedComponent->SetStaticMesh(Room->GetBakedMesh());
+			BakedComponent->SetWorldTransform(Room->GetActorTransform());
+			HLODComponents.Add(BakedComponent);
+			continue;
+		}
+
+		Room->GatherCellInstances(Instances);
+	}
+
+	// Cells sharing a mesh are drawn as one instanced component, whichever room they belong to
+	for (TPair<UStaticMesh*, TArray<FTransform>>& MeshInstances : Instances)
+	{
+		UInstancedStaticMeshComponent* InstancedComponent = NewObject<UInstancedStaticMeshComponent>();
+		InstancedComponent->SetStaticMesh(MeshInstances.Key);
+		InstancedComponent->AddInstances(MeshInstances.Value, false, true);
+		HLODComponents.Add(InstancedComponent);
+	}
+
+	UE_LOG(LogPRGHLOD, Verbose, TEXT("%s: %d rooms, %d components."), *InHLODBuildContext.AssetsBaseName, Rooms.Num(), HLODComponents.Num());
+	return HLODComponents;
+}
+
+APRG_Room* UPRG_RoomHLODBuilder::GetSourceRoom(const UActorComponent* SourceComponent)
+{
+	AActor* Owner = SourceComponent ? SourceComponent->GetOwner() : nullptr;
+	if (!Owner)
+		return nullptr;
+
+	if (APRG_Room* Room = Cast<APRG_Room>(Owner))
+		return Room;
+
+	return (Owner->IsA<AWall>() || Owner->IsA<ATile>()) ? Cast<APRG_Room>(Owner->GetAttachParentActor()) : nullptr;
+}
+#endif
@@ -0,0 +1,162 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomLayout.h"
+
+#include "PRG_Room.h"
+
+void UPRG_RoomLayout::CaptureRoom(const APRG_Room& Room)
+{
+	// Room already shows this layout, and capturing would read the palette while it is being rebuilt
+	if (Room.GetLayout() == this)
+		return;
+
+	Modify();
+
+	Palette.Reset();
+	Room.CaptureCells(Cells, Palette);
+
+	NotifyLayoutChanged();
+}
+
+int32 UPRG_RoomLayout::ReplaceCellMeshes(bool bWalls, const UStaticMesh* FromMesh, UStaticMesh* ToMesh)
+{
+	if (!ToMesh)
+		return 0;
+
+	TArray<int32>& MeshIds = bWalls ? Cells.WallMeshIds : Cells.TileMeshIds;
+
+	// Lambda - Check if an occupied cell should get the new mesh
+	auto ShouldReplace = [&](int32 MeshId)
+	{
+		const UStaticMesh* CurrentMesh = Palette.GetMesh(MeshId);
+		return MeshId != INDEX_NONE && CurrentMesh != ToMesh && (!FromMesh || CurrentMesh == FromMesh);
+	};
+
+	// Leave the asset untouched when nothing matches
+	if (!MeshIds.ContainsByPredicate(ShouldReplace))
+		return 0;
+
+	Modify();
+
+	const int32 ToMeshId = Palette.FindOrAdd(ToMesh);
+	int32 NumChanged = 0;
+	for (int32& MeshId : MeshIds)
+	{
+		if (ShouldReplace(MeshId))
+		{
+			MeshId = ToMeshId;
+			NumChanged++;
+		}
+	}
+
+	NotifyLayoutChanged();
+	return NumChanged;
+}
+
+const TArray<FTransform>& UPRG_RoomLayout::GetInstanceTransforms(int32 PaletteIndex) const
+{
+	if (!bInstanceTransformsValid)
+		BuildInstanceTransforms();
+
+	static const TArray<FTransform> NoInstances;
+	return InstanceTransforms.IsValidIndex(PaletteIndex) ? InstanceTransforms[PaletteIndex] : NoInstances;
+}
+
+void UPRG_RoomLayout::NotifyLayoutChanged()
+{
+	bInstanceTransformsValid = false;
+	MarkPackageDirty();
+	OnLayoutChanged.Broadcast(this);
+}
+
+#if WITH_EDITOR
+void UPRG_RoomLayout::PreEditChange(FProperty* PropertyAboutToChange)
+{
+	Super::PreEditChange(PropertyAboutToChange);
+
+	// Undo passes no property
+	PreEditRoomSize.Reset();
+	if (PropertyAboutToChange)
+		PreEditRoomSize = Cells.RoomSize;
+	PreEditContentHash = Cells.GetContentHash(Palette);
+}
+
+void UPRG_RoomLayout::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Move cells to their grid position in a changed room size. The arrays are still sized for the old room size
+	const FIntPoint NewSize = Cells.RoomSize.ComponentMax(FIntPoint(1, 1));
+	if (PreEditRoomSize.IsSet() && PreEditRoomSize.GetValue() != NewSize)
+	{
+		Cells.RoomSize = PreEditRoomSize.GetValue();
+		if (Cells.IsValid())
+			Cells.Resize(NewSize);
+	}
+	Cells.RoomSize = NewSize;
+
+	// Lambda - Resize cell array edited directly, marking added cells as empty
+	auto ResizeCells = [](TArray<int32>& MeshIds, int NewNum)
+	{
+		const int OldNum = MeshIds.Num();
+		MeshIds.SetNum(NewNum);
+		for (int i = OldNum; i < NewNum; i++)
+			MeshIds[i] = INDEX_NONE;
+	};
+
+	// Keep cell arrays in line with the room size, so rooms never index out of range
+	ResizeCells(Cells.TileMeshIds, FPRGRoomCells::NumTiles(Cells.RoomSize));
+	ResizeCells(Cells.WallMeshIds, FPRGRoomCells::NumWalls(Cells.RoomSize));
+	if (Cells.WallTypes.Num() > 0)
+		Cells.WallTypes.SetNum(FPRGRoomCells::NumWalls(Cells.RoomSize));
+
+	// Interactive edits, e.g. dragging a value, call this again for the same edit, so compare with what they built last
+	const uint32 ContentHash = Cells.GetContentHash(Palette);
+	const bool bChanged = ContentHash != PreEditContentHash;
+	PreEditContentHash = ContentHash;
+	PreEditRoomSize.Reset();
+	if (PropertyChangedEvent.ChangeType == EPropertyChangeType::Interactive)
+		PreEditRoomSize = Cells.RoomSize;
+
+	if (bChanged)
+		NotifyLayoutChanged();
+}
+#endif
+
+void UPRG_RoomLayout::BuildInstanceTransforms() const
+{
+	InstanceTransforms.Reset();
+	InstanceTransforms.SetNum(Palette.Num());
+
+	if (Cells.IsValid())
+	{
+		// Positions of all instanced cells are looked up in one pass per type
+		const FPRGGridLayout Grid(Cells.RoomSize, Cells.TileSizeCM);
+		TArray<int32> Indices;
+		TArray<FVector> Positions;
+
+		for (int i = 0; i < Cells.TileMeshIds.Num(); i++)
+		{
+			if (InstanceTransforms.IsValidIndex(Cells.TileMeshIds[i]))
+				Indices.Add(i);
+		}
+		Positions.SetNumUninitialized(Indices.Num());
+		Grid.TilePositions(Indices, Positions);
+		for (int i = 0; i < Indices.Num(); i++)
+			InstanceTransforms[Cells.TileMeshIds[Indices[i]]].Add(FTransform(Positions[i]));
+
+		// Doors, windows and openings are drawn by the rooms using the layout
+		Indices.Reset();
+		for (int i = 0; i < Cells.WallMeshIds.Num(); i++)
+		{
+			if (InstanceTransforms.IsValidIndex(Cells.WallMeshIds[i]) && !Cells.IsWallOpening(i))
+				Indices.Add(i);
+		}
+		Positions.SetNumUninitialized(Indices.Num());
+		Grid.WallPositions(Indices, Positions);
+		for (int i = 0; i < Indices.Num(); i++)
+			InstanceTransforms[Cells.WallMeshIds[Indices[i]]].Add(FTransform(Grid.WallRotation(Indices[i]), Positions[i]));
+	}
+
+	bInstanceTransformsValid = true;
+}
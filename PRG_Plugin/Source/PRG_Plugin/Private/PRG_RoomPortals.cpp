@@ -0,0 +1,483 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomPortals.h"
+
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/StaticMesh.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "PRG_Room.h"
+
+#if WITH_EDITOR
+#include "LevelEditorViewport.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogPRGPortals, Log, All);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarPortalCulling(
+		TEXT("PRG.PortalCulling"),
+		1,
+		TEXT("Hide rooms that cannot be seen through the doors and windows of the room containing the camera. ")
+		TEXT("0: off, 1: game worlds, 2: game worlds and the editor viewport"));
+
+	// Wall meshes that can be seen through. Empty wall slots are always open
+	const TCHAR* const OpeningMeshPaths[] =
+	{
+		TEXT("/PRG_Plugin/Meshes/SM_PRG_Door.SM_PRG_Door"),
+		TEXT("/PRG_Plugin/Meshes/SM_PRG_Window.SM_PRG_Window")
+	};
+
+	// Edge length of the spatial hash buckets, in cm
+	constexpr double BucketSize = 2000.0;
+	// Distance between wall slots of two rooms that still counts as the same slot, in cm
+	constexpr double WallTolerance = 10.0;
+	// Distance between the floor of one room and the ceiling of another that still counts as touching, in cm
+	constexpr double LevelTolerance = 10.0;
+	// Near plane of the culled view, in cm. Portals closer than this cover the whole screen
+	constexpr double NearPlane = 10.0;
+	// Times a room can be reached again through a wider rectangle, so the walk always ends
+	constexpr int32 MaxVisitsPerRoom = 8;
+
+	const FBox2D FullScreen(FVector2D(-1.0, -1.0), FVector2D(1.0, 1.0));
+
+	bool IsOpeningMesh(const UStaticMesh* Mesh)
+	{
+		if (!Mesh)
+			return true;
+
+		const FString Path = Mesh->GetPathName();
+		for (const TCHAR* OpeningMeshPath : OpeningMeshPaths)
+		{
+			if (Path == OpeningMeshPath)
+				return true;
+		}
+		return false;
+	}
+
+	FIntPoint GetBucket(const FVector& Location)
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / BucketSize), FMath::FloorToInt(Location.Y / BucketSize));
+	}
+
+	// Check if a world location lies within the grid volume of a room, given its transform and extent in room space
+	bool IsInsideGrid(const FTransform& Transform, const FVector& Extent, const FVector& Location)
+	{
+		const FVector Local = Transform.InverseTransformPosition(Location);
+		return Local.X >= 0.0 && Local.Y >= 0.0 && Local.Z >= 0.0 && Local.X <= Extent.X && Local.Y <= Extent.Y && Local.Z <= Extent.Z;
+	}
+
+	// Project points to a rectangle in normalized screen space. Returns false if all points are behind the camera
+	bool ProjectRect(const FMatrix& ViewProjection, TArrayView<const FVector> Points, FBox2D& OutRect)
+	{
+		OutRect = FBox2D(ForceInit);
+		int32 NumBehind = 0;
+		for (const FVector& Point : Points)
+		{
+			const FVector4 Clip = ViewProjection.TransformFVector4(FVector4(Point, 1.0));
+			if (Clip.W <= NearPlane)
+			{
+				NumBehind++;
+				continue;
+			}
+			OutRect += FVector2D(Clip.X / Clip.W, Clip.Y / Clip.W);
+		}
+
+		if (NumBehind == Points.Num())
+			return false;
+
+		// Points behind the camera project to the opposite side, so a shape crossing the near plane may cover the whole screen
+		if (NumBehind > 0)
+			OutRect = FullScreen;
+		return true;
+	}
+
+	// Check if Inner lies within Outer, edges included
+	bool ContainsRect(const FBox2D& Outer, const FBox2D& Inner)
+	{
+		return Outer.bIsValid && Outer.Min.X <= Inner.Min.X && Outer.Min.Y <= Inner.Min.Y && Outer.Max.X >= Inner.Max.X && Outer.Max.Y >= Inner.Max.Y;
+	}
+}
+
+void UPRG_RoomPortalSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RoomChangedHandle = APRG_Room::OnAnyRoomChanged.AddUObject(this, &UPRG_RoomPortalSubsystem::OnRoomChanged);
+}
+
+void UPRG_RoomPortalSubsystem::Deinitialize()
+{
+	APRG_Room::OnAnyRoomChanged.Remove(RoomChangedHandle);
+	RoomChangedHandle.Reset();
+
+	ShowAllRooms();
+	Nodes.Reset();
+	Buckets.Reset();
+
+	Super::Deinitialize();
+}
+
+void UPRG_RoomPortalSubsystem::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	const int32 Mode = CVarPortalCulling.GetValueOnGameThread();
+	const bool bEnabled = World && (World->IsGameWorld() ? Mode >= 1 : Mode >= 2);
+
+	FCullView View;
+	if (!bEnabled || !GetView(View))
+	{
+		ShowAllRooms();
+		return;
+	}
+
+	if (bGraphDirty)
+	{
+		RebuildGraph();
+		bGraphDirty = false;
+	}
+
+	TBitArray<> Visible;
+	ComputeVisibility(View, Visible);
+	ApplyVisibility(Visible);
+}
+
+TStatId UPRG_RoomPortalSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPRG_RoomPortalSubsystem, STATGROUP_Tickables);
+}
+
+void UPRG_RoomPortalSubsystem::OnRoomChanged(APRG_Room* Room, ERoomChange Change)
+{
+	// Hiding and showing rooms, including by the visibility pass itself, does not change any opening
+	if (Change == ERoomChange::Visibility || !Room || Room->GetWorld() != GetWorld())
+		return;
+
+	bGraphDirty = true;
+}
+
+void UPRG_RoomPortalSubsystem::RebuildGraph()
+{
+	Nodes.Reset();
+	Buckets.Reset();
+
+	for (TActorIterator<APRG_Room> It(GetWorld()); It; ++It)
+	{
+		APRG_Room* Room = *It;
+		if (!IsValid(Room) || Room->IsTemplate())
+			continue;
+
+		FPRGRoomCells Cells;
+		FPRGMeshPalette Palette;
+		Room->CaptureCells(Cells, Palette);
+		if (!Cells.IsValid())
+			continue;
+
+		const int32 NodeIndex = Nodes.AddDefaulted();
+		FRoomNode& Node = Nodes[NodeIndex];
+		Node.Room = Room;
+		Node.Transform = Room->GetActorTransform();
+		Node.Grid = FPRGGridLayout(Cells.RoomSize, Cells.TileSizeCM);
+		Node.Extent = FVector(Cells.RoomSize.X * Cells.TileSizeCM, Cells.RoomSize.Y * Cells.TileSizeCM, Cells.RoomHeight * 100.0);
+		Node.Bounds = Room->GetRoomBounds();
+
+		Node.OpenWalls.Init(false, Node.Grid.NumWalls());
+		for (int32 WallIndex = 0; WallIndex < Node.Grid.NumWalls(); WallIndex++)
+			Node.OpenWalls[WallIndex] = Cells.IsWallOpening(WallIndex) || IsOpeningMesh(Palette.GetMesh(Cells.WallMeshIds[WallIndex]));
+
+		const FIntPoint MinBucket = GetBucket(Node.Bounds.Min);
+		const FIntPoint MaxBucket = GetBucket(Node.Bounds.Max);
+		for (int32 Y = MinBucket.Y; Y <= MaxBucket.Y; Y++)
+		{
+			for (int32 X = MinBucket.X; X <= MaxBucket.X; X++)
+				Buckets.Add(FIntPoint(X, Y), NodeIndex);
+		}
+	}
+
+	int32 NumPortals = 0;
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+	{
+		AddPortals(NodeIndex);
+		AddStackedNodes(NodeIndex);
+		NumPortals += Nodes[NodeIndex].Portals.Num();
+	}
+
+	// Rooms removed while hidden are gone from the graph
+	for (auto It = HiddenRooms.CreateIterator(); It; ++It)
+	{
+		if (!It->IsValid())
+			It.RemoveCurrent();
+	}
+
+	UE_LOG(LogPRGPortals, Verbose, TEXT("Portal graph of %d rooms with %d portals."), Nodes.Num(), NumPortals);
+}
+
+void UPRG_RoomPortalSubsystem::AddPortals(int32 NodeIndex)
+{
+	FRoomNode& Node = Nodes[NodeIndex];
+	const FPRGGridLayout& Grid = Node.Grid;
+	const double Height = Node.Extent.Z;
+
+	for (int32 WallIndex = 0; WallIndex < Grid.NumWalls(); WallIndex++)
+	{
+		// Walls inside the room do not separate it from other rooms
+		if (!Grid.IsExteriorWall(WallIndex) || !Node.OpenWalls[WallIndex])
+			continue;
+
+		const bool bXWall = Grid.IsXWall(WallIndex);
+		const FVector Position = Grid.WallPosition(WallIndex);
+		const FVector Along = bXWall ? FVector(Grid.HalfTileSize(), 0.0, 0.0) : FVector(0.0, Grid.HalfTileSize(), 0.0);
+		const FVector Outward = bXWall ? FVector(0.0, Grid.WallY(WallIndex) == 0 ? -1.0 : 1.0, 0.0) : FVector(Grid.WallX(WallIndex) == 0 ? -1.0 : 1.0, 0.0, 0.0);
+		const FVector Center = Position + FVector(0.0, 0.0, Height * 0.5);
+
+		// The room on the other side must be open at the same wall slot, or have no wall slot there at all
+		const FVector WallLocation = Node.Transform.TransformPosition(Center);
+		const int32 ToNode = FindNodeAt(Node.Transform.TransformPosition(Center + Outward * Grid.HalfTileSize()), NodeIndex);
+		if (ToNode != INDEX_NONE && !IsOpenAt(Nodes[ToNode], WallLocation))
+			continue;
+
+		FPortal& Portal = Node.Portals.AddDefaulted_GetRef();
+		Portal.Corners[0] = Node.Transform.TransformPosition(Position - Along);
+		Portal.Corners[1] = Node.Transform.TransformPosition(Position + Along);
+		Portal.Corners[2] = Node.Transform.TransformPosition(Position + Along + FVector(0.0, 0.0, Height));
+		Portal.Corners[3] = Node.Transform.TransformPosition(Position - Along + FVector(0.0, 0.0, Height));
+		Portal.ToNode = ToNode;
+	}
+}
+
+void UPRG_RoomPortalSubsystem::AddStackedNodes(int32 NodeIndex)
+{
+	FRoomNode& Node = Nodes[NodeIndex];
+	const double FloorZ = Node.Transform.GetLocation().Z;
+	const double CeilingZ = Node.Transform.TransformPosition(FVector(0.0, 0.0, Node.Extent.Z)).Z;
+
+	// Footprints must overlap by more than the tolerance, so rooms only sharing an edge are not stacked
+	const FBox2D Footprint(FVector2D(Node.Bounds.Min) + FVector2D(LevelTolerance), FVector2D(Node.Bounds.Max) - FVector2D(LevelTolerance));
+	const FIntPoint MinBucket = GetBucket(Node.Bounds.Min);
+	const FIntPoint MaxBucket = GetBucket(Node.Bounds.Max);
+	for (int32 Y = MinBucket.Y; Y <= MaxBucket.Y; Y++)
+	{
+		for (int32 X = MinBucket.X; X <= MaxBucket.X; X++)
+		{
+			for (auto It = Buckets.CreateConstKeyIterator(FIntPoint(X, Y)); It; ++It)
+			{
+				const int32 OtherIndex = It.Value();
+				const FRoomNode& Other = Nodes[OtherIndex];
+				if (OtherIndex == NodeIndex || Node.StackedNodes.Contains(OtherIndex) || !Footprint.Intersect(FBox2D(FVector2D(Other.Bounds.Min), FVector2D(Other.Bounds.Max))))
+					continue;
+
+				const double OtherFloorZ = Other.Transform.GetLocation().Z;
+				const double OtherCeilingZ = Other.Transform.TransformPosition(FVector(0.0, 0.0, Other.Extent.Z)).Z;
+				if (FMath::IsNearlyEqual(FloorZ, OtherCeilingZ, LevelTolerance) || FMath::IsNearlyEqual(CeilingZ, OtherFloorZ, LevelTolerance))
+					Node.StackedNodes.Add(OtherIndex);
+			}
+		}
+	}
+}
+
+int32 UPRG_RoomPortalSubsystem::FindNodeAt(const FVector& Location, int32 Exclude) const
+{
+	for (auto It = Buckets.CreateConstKeyIterator(GetBucket(Location)); It; ++It)
+	{
+		const int32 NodeIndex = It.Value();
+		if (NodeIndex == Exclude)
+			continue;
+
+		if (IsInsideGrid(Nodes[NodeIndex].Transform, Nodes[NodeIndex].Extent, Location))
+			return NodeIndex;
+	}
+	return INDEX_NONE;
+}
+
+bool UPRG_RoomPortalSubsystem::IsOpenAt(const FRoomNode& Node, const FVector& WallLocation)
+{
+	const FVector Local = Node.Transform.InverseTransformPosition(WallLocation);
+	const int32 WallIndex = Node.Grid.WallIndexAt(Local);
+	if (WallIndex == INDEX_NONE)
+		return true;
+
+	// Grids that do not line up have no wall slot exactly here
+	const FVector WallPosition = Node.Grid.WallPosition(WallIndex);
+	if (!FVector2D(WallPosition).Equals(FVector2D(Local), WallTolerance))
+		return true;
+
+	return Node.OpenWalls[WallIndex];
+}
+
+bool UPRG_RoomPortalSubsystem::GetView(FCullView& OutView) const
+{
+	UWorld* World = GetWorld();
+	FRotator Rotation;
+	float FOV = 90.0f;
+	FIntPoint ViewportSize = FIntPoint::ZeroValue;
+
+	if (World->IsGameWorld())
+	{
+		// Split screen would need one pass per player, so only the first player is culled for
+		const APlayerController* PlayerController = World->GetFirstPlayerController();
+		const UGameViewportClient* ViewportClient = World->GetGameViewport();
+		if (!PlayerController || !PlayerController->PlayerCameraManager || !ViewportClient || !ViewportClient->Viewport)
+			return false;
+
+		OutView.Location = PlayerController->PlayerCameraManager->GetCameraLocation();
+		Rotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+		FOV = PlayerController->PlayerCameraManager->GetFOVAngle();
+		ViewportSize = ViewportClient->Viewport->GetSizeXY();
+	}
+	else
+	{
+#if WITH_EDITOR
+		const FLevelEditorViewportClient* ViewportClient = GCurrentLevelEditingViewportClient;
+		if (!ViewportClient || ViewportClient->GetWorld() != World || !ViewportClient->IsPerspective() || !ViewportClient->Viewport)
+			return false;
+
+		OutView.Location = ViewportClient->GetViewLocation();
+		Rotation = ViewportClient->GetViewRotation();
+		FOV = ViewportClient->ViewFOV;
+		ViewportSize = ViewportClient->Viewport->GetSizeXY();
+#else
+		// Editor worlds only exist in editor builds
+		return false;
+#endif
+	}
+
+	if (ViewportSize.X <= 0 || ViewportSize.Y <= 0)
+		return false;
+
+	// Same view and projection as the renderer: X forward becomes Z depth
+	const FMatrix ViewMatrix = FTranslationMatrix(-OutView.Location) * FInverseRotationMatrix(Rotation) * FMatrix(
+		FPlane(0.0, 0.0, 1.0, 0.0),
+		FPlane(1.0, 0.0, 0.0, 0.0),
+		FPlane(0.0, 1.0, 0.0, 0.0),
+		FPlane(0.0, 0.0, 0.0, 1.0));
+	const FMatrix ProjectionMatrix = FReversedZPerspectiveMatrix(FMath::DegreesToRadians(FOV * 0.5), double(ViewportSize.X), double(ViewportSize.Y), NearPlane);
+	OutView.ViewProjection = ViewMatrix * ProjectionMatrix;
+	return true;
+}
+
+void UPRG_RoomPortalSubsystem::ComputeVisibility(const FCullView& View, TBitArray<>& OutVisible) const
+{
+	OutVisible.Init(false, Nodes.Num());
+
+	// Screen rectangle each room is seen through. Rooms containing the camera are seen whole
+	TArray<FBox2D> Rects;
+	Rects.Init(FBox2D(ForceInit), Nodes.Num());
+	TArray<int32> Queue;
+	for (auto It = Buckets.CreateConstKeyIterator(GetBucket(View.Location)); It; ++It)
+	{
+		const int32 NodeIndex = It.Value();
+		if (IsInsideGrid(Nodes[NodeIndex].Transform, Nodes[NodeIndex].Extent, View.Location))
+		{
+			Rects[NodeIndex] = FullScreen;
+			Queue.Add(NodeIndex);
+		}
+	}
+
+	// Outside all rooms everything may be in view
+	if (Queue.Num() == 0)
+	{
+		OutVisible.Init(true, Nodes.Num());
+		return;
+	}
+
+	FBox2D OutsideRect(ForceInit);
+	for (int32 Budget = Nodes.Num() * MaxVisitsPerRoom; Queue.Num() > 0 && Budget > 0; Budget--)
+	{
+		const int32 NodeIndex = Queue.Pop(false);
+		const FBox2D SourceRect = Rects[NodeIndex];
+		OutVisible[NodeIndex] = true;
+
+		for (const FPortal& Portal : Nodes[NodeIndex].Portals)
+		{
+			FBox2D PortalRect;
+			if (!ProjectRect(View.ViewProjection, MakeArrayView(Portal.Corners), PortalRect))
+				continue;
+
+			const FBox2D Rect = SourceRect.Overlap(PortalRect);
+			if (!Rect.bIsValid)
+				continue;
+
+			if (Portal.ToNode == INDEX_NONE)
+			{
+				OutsideRect += Rect;
+				continue;
+			}
+
+			// Walk on only when the room is seen through more of the screen than before
+			FBox2D& TargetRect = Rects[Portal.ToNode];
+			if (ContainsRect(TargetRect, Rect))
+				continue;
+
+			TargetRect += Rect;
+			Queue.Add(Portal.ToNode);
+		}
+	}
+
+	// Rooms seen through openings to the outside are shown, but not walked into
+	if (OutsideRect.bIsValid)
+	{
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+		{
+			if (OutVisible[NodeIndex])
+				continue;
+
+			const FBox& Bounds = Nodes[NodeIndex].Bounds;
+			FVector Corners[8];
+			for (int32 i = 0; i < 8; i++)
+				Corners[i] = FVector((i & 1) ? Bounds.Max.X : Bounds.Min.X, (i & 2) ? Bounds.Max.Y : Bounds.Min.Y, (i & 4) ? Bounds.Max.Z : Bounds.Min.Z);
+
+			FBox2D BoundsRect;
+			if (ProjectRect(View.ViewProjection, MakeArrayView(Corners), BoundsRect) && OutsideRect.Intersect(BoundsRect))
+				OutVisible[NodeIndex] = true;
+		}
+	}
+
+	// Floors and ceilings are not portals, so the rooms directly above and below visible rooms stay visible
+	const TBitArray<> WalkedVisible = OutVisible;
+	for (TConstSetBitIterator<> It(WalkedVisible); It; ++It)
+	{
+		for (const int32 StackedIndex : Nodes[It.GetIndex()].StackedNodes)
+			OutVisible[StackedIndex] = true;
+	}
+}
+
+void UPRG_RoomPortalSubsystem::ApplyVisibility(const TBitArray<>& Visible)
+{
+	NumVisible = 0;
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+	{
+		APRG_Room* Room = Nodes[NodeIndex].Room.Get();
+		if (!Room)
+			continue;
+
+		const bool bHide = !Visible[NodeIndex];
+		if (!bHide)
+			NumVisible++;
+
+		if (bHide == HiddenRooms.Contains(Room))
+			continue;
+
+		Room->SetRoomHidden(bHide, ERoomHiddenBy::Portals);
+		if (bHide)
+			HiddenRooms.Add(Room);
+		else
+			HiddenRooms.Remove(Room);
+	}
+}
+
+void UPRG_RoomPortalSubsystem::ShowAllRooms()
+{
+	NumVisible = Nodes.Num();
+	if (HiddenRooms.Num() == 0)
+		return;
+
+	for (const TWeakObjectPtr<APRG_Room>& Room : HiddenRooms)
+	{
+		if (Room.IsValid())
+			Room->SetRoomHidden(false, ERoomHiddenBy::Portals);
+	}
+	HiddenRooms.Reset();
+}
@@ -0,0 +1,288 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomRenderer.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "EngineUtils.h"
+#include "PRG_Building.h"
+#include "PRG_Room.h"
+
+APRG_RoomRenderer::APRG_RoomRenderer()
+{
+	// Tick to apply collected room changes once per frame
+	PrimaryActorTick.bCanEverTick = true;
+
+	USceneComponent* BaseComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	BaseComponent->SetMobility(EComponentMobility::Type::Static);
+	RootComponent = BaseComponent;
+
+#if WITH_EDITORONLY_DATA
+	// Renders all loaded rooms, so must stay loaded itself
+	bIsSpatiallyLoaded = false;
+#endif
+}
+
+void APRG_RoomRenderer::RebuildAll()
+{
+	ReleaseAll();
+
+	for (TActorIterator<APRG_Room> It(GetWorld()); It; ++It)
+		DirtyRooms.Add(*It);
+}
+
+void APRG_RoomRenderer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (DirtyRooms.Num() > 0)
+		FlushDirtyRooms();
+}
+
+void APRG_RoomRenderer::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	if (IsTemplate() || !GetWorld())
+		return;
+
+	if (!RoomChangedHandle.IsValid())
+		RoomChangedHandle = APRG_Room::OnAnyRoomChanged.AddUObject(this, &APRG_RoomRenderer::OnRoomChanged);
+
+	RebuildAll();
+}
+
+void APRG_RoomRenderer::PostUnregisterAllComponents()
+{
+	APRG_Room::OnAnyRoomChanged.Remove(RoomChangedHandle);
+	RoomChangedHandle.Reset();
+
+	ReleaseAll();
+
+	Super::PostUnregisterAllComponents();
+}
+
+#if WITH_EDITOR
+void APRG_RoomRenderer::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(APRG_RoomRenderer, PartitionSize))
+		RebuildAll();
+}
+#endif
+
+void APRG_RoomRenderer::OnRoomChanged(APRG_Room* Room, ERoomChange Change)
+{
+	// Rooms of other worlds, e.g. the editor world while playing in editor, are handled by their own renderer
+	if (!Room || Room->GetWorld() != GetWorld())
+		return;
+
+	// Drop a removed room right away, its cell actors may already be gone by the next tick
+	if (Change == ERoomChange::Removed)
+	{
+		RemoveRoom(Room);
+		DirtyRooms.Remove(Room);
+		return;
+	}
+
+	DirtyRooms.Add(Room);
+}
+
+void APRG_RoomRenderer::FlushDirtyRooms()
+{
+	for (const TWeakObjectPtr<APRG_Room>& RoomPtr : DirtyRooms)
+		UpdateRoom(RoomPtr);
+	DirtyRooms.Reset();
+
+	// Rebuild touched batches and release the ones no room contributes to anymore
+	for (auto It = Batches.CreateIterator(); It; ++It)
+	{
+		FPRGRoomBatch& Batch = It.Value();
+		if (!Batch.bDirty)
+			continue;
+
+		if (Batch.Rooms.Num() == 0)
+		{
+			if (Batch.Component)
+				Batch.Component->DestroyComponent();
+			It.RemoveCurrent();
+			continue;
+		}
+
+		RebuildBatch(It.Key(), Batch);
+	}
+}
+
+void APRG_RoomRenderer::UpdateRoom(const TWeakObjectPtr<APRG_Room>& RoomPtr)
+{
+	APRG_Room* Room = RoomPtr.Get();
+	if (!IsValid(Room) || Room->IsActorBeingDestroyed())
+	{
+		RemoveRoom(RoomPtr);
+		return;
+	}
+
+	// Room renders its own cells while it is edited cell by cell
+	if (Room->IsExcludedFromBatching())
+	{
+		RemoveRoom(RoomPtr);
+		Room->SetCellRendering(true);
+		return;
+	}
+
+	Room->EnsureCellsGathered();
+
+	FRoomEntry NewEntry;
+	Room->GatherCellInstances(NewEntry.Instances);
+
+	// Hidden rooms, e.g. hidden building levels, keep their instances collapsed, so showing them again does not refill batches
+	if (Room->IsRoomHiddenInWorld())
+	{
+		for (TPair<UStaticMesh*, TArray<FTransform>>& MeshInstances : NewEntry.Instances)
+		{
+			for (FTransform& Instance : MeshInstances.Value)
+				Instance.SetScale3D(FVector::ZeroVector);
+		}
+	}
+
+	// Levels of a building share the partition of the building
+	APRG_Building* Building = Room->GetBuilding();
+	const FIntPoint Partition = GetPartition(Building ? Building->GetActorLocation() : Room->GetActorLocation());
+	const int32 Level = Building ? Building->GetLevelIndex(Room) : INDEX_NONE;
+	for (const TPair<UStaticMesh*, TArray<FTransform>>& MeshInstances : NewEntry.Instances)
+		NewEntry.BatchStarts.Add({ MeshInstances.Key, Partition, Level }, INDEX_NONE);
+
+	FRoomEntry* Entry = RoomEntries.Find(RoomPtr);
+	if (!Entry || !UpdateInstancesInPlace(*Entry, NewEntry))
+	{
+		RemoveRoom(RoomPtr);
+		for (const TPair<FPRGRoomBatchKey, int32>& BatchStart : NewEntry.BatchStarts)
+		{
+			FPRGRoomBatch& Batch = Batches.FindOrAdd(BatchStart.Key);
+			Batch.Rooms.Add(RoomPtr);
+			Batch.bDirty = true;
+		}
+		RoomEntries.Add(RoomPtr, MoveTemp(NewEntry));
+	}
+
+	Room->SetCellRendering(false);
+}
+
+bool APRG_RoomRenderer::UpdateInstancesInPlace(FRoomEntry& Entry, FRoomEntry& NewEntry)
+{
+	// Lambda - Get number of instances of a mesh
+	auto NumInstances = [](const FRoomEntry& RoomEntry, UStaticMesh* Mesh)
+	{
+		const TArray<FTransform>* Instances = RoomEntry.Instances.Find(Mesh);
+		return Instances ? Instances->Num() : 0;
+	};
+
+	// Batches that are refilled this tick anyway, or changes in meshes or counts, need the room's range to move
+	if (Entry.BatchStarts.Num() != NewEntry.BatchStarts.Num())
+		return false;
+	for (const TPair<FPRGRoomBatchKey, int32>& BatchStart : Entry.BatchStarts)
+	{
+		const FPRGRoomBatch* Batch = Batches.Find(BatchStart.Key);
+		if (!Batch || Batch->bDirty || !Batch->Component || BatchStart.Value == INDEX_NONE || !NewEntry.BatchStarts.Contains(BatchStart.Key)
+			|| NumInstances(Entry, BatchStart.Key.Mesh) != NumInstances(NewEntry, BatchStart.Key.Mesh))
+			return false;
+	}
+
+	for (const TPair<FPRGRoomBatchKey, int32>& BatchStart : Entry.BatchStarts)
+	{
+		const TArray<FTransform>& Instances = NewEntry.Instances.FindChecked(BatchStart.Key.Mesh);
+		Batches.FindChecked(BatchStart.Key).Component->BatchUpdateInstancesTransforms(BatchStart.Value, Instances, false, true);
+	}
+	Entry.Instances = MoveTemp(NewEntry.Instances);
+	return true;
+}
+
+void APRG_RoomRenderer::RemoveRoom(const TWeakObjectPtr<APRG_Room>& RoomPtr)
+{
+	FRoomEntry* Entry = RoomEntries.Find(RoomPtr);
+	if (!Entry)
+		return;
+
+	for (const TPair<FPRGRoomBatchKey, int32>& BatchStart : Entry->BatchStarts)
+	{
+		if (FPRGRoomBatch* Batch = Batches.Find(BatchStart.Key))
+		{
+			Batch->Rooms.Remove(RoomPtr);
+			Batch->bDirty = true;
+		}
+	}
+	RoomEntries.Remove(RoomPtr);
+}
+
+void APRG_RoomRenderer::RebuildBatch(const FPRGRoomBatchKey& Key, FPRGRoomBatch& Batch)
+{
+	if (!Batch.Component)
+	{
+		// Instances are stored in world space, so keep the component independent of the renderer's own transform
+		Batch.Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+		Batch.Component->SetMobility(EComponentMobility::Type::Static);
+		Batch.Component->SetUsingAbsoluteLocation(true);
+		Batch.Component->SetUsingAbsoluteRotation(true);
+		Batch.Component->SetUsingAbsoluteScale(true);
+		// Cell actors keep their own collision
+		Batch.Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Batch.Component->SetStaticMesh(Key.Mesh);
+		Batch.Component->SetupAttachment(RootComponent);
+		Batch.Component->RegisterComponent();
+	}
+
+	int32 NumInstances = 0;
+	for (const TWeakObjectPtr<APRG_Room>& RoomPtr : Batch.Rooms)
+	{
+		if (const FRoomEntry* Entry = RoomEntries.Find(RoomPtr))
+		{
+			if (const TArray<FTransform>* Instances = Entry->Instances.Find(Key.Mesh))
+				NumInstances += Instances->Num();
+		}
+	}
+
+	// Remember where the instances of each room start, so later moves of the room update only its own range
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(NumInstances);
+	for (const TWeakObjectPtr<APRG_Room>& RoomPtr : Batch.Rooms)
+	{
+		if (FRoomEntry* Entry = RoomEntries.Find(RoomPtr))
+		{
+			if (const TArray<FTransform>* Instances = Entry->Instances.Find(Key.Mesh))
+			{
+				Entry->BatchStarts.FindOrAdd(Key) = Transforms.Num();
+				Transforms.Append(*Instances);
+			}
+		}
+	}
+
+	// Replacing all instances at once lets the component build its cluster tree a single time
+	Batch.Component->ClearInstances();
+	Batch.Component->AddInstances(Transforms, false);
+	Batch.bDirty = false;
+}
+
+void APRG_RoomRenderer::ReleaseAll()
+{
+	for (const TPair<TWeakObjectPtr<APRG_Room>, FRoomEntry>& Entry : RoomEntries)
+	{
+		APRG_Room* Room = Entry.Key.Get();
+		if (IsValid(Room) && !Room->IsActorBeingDestroyed())
+			Room->SetCellRendering(true);
+	}
+
+	for (TPair<FPRGRoomBatchKey, FPRGRoomBatch>& Batch : Batches)
+	{
+		if (Batch.Value.Component)
+			Batch.Value.Component->DestroyComponent();
+	}
+
+	Batches.Reset();
+	RoomEntries.Reset();
+	DirtyRooms.Reset();
+}
+
+FIntPoint APRG_RoomRenderer::GetPartition(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / PartitionSize), FMath::FloorToInt(Location.Y / PartitionSize));
+}
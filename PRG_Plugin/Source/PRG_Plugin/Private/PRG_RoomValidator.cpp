@@ -0,0 +1,183 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomValidator.h"
+
+#include "BaseGizmos/CombinedTransformGizmo.h"
+#include "BaseGizmos/TransformProxy.h"
+#include "PRG_Room.h"
+
+DEFINE_LOG_CATEGORY(LogPRGValidator);
+
+FPRGRoomValidator::FPRGRoomValidator(bool bInRepair)
+	: bRepair(bInRepair)
+{
+}
+
+void FPRGRoomValidator::SetGizmoRepair(TFunction<void(APRG_Room&)> InRepairGizmo)
+{
+	RepairGizmo = MoveTemp(InRepairGizmo);
+}
+
+int32 FPRGRoomValidator::ValidateRoom(APRG_Room& Room)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 ProblemsBefore = NumProblems;
+	NumRooms++;
+	bRoomModified = false;
+
+	// Cells of a layout are instances, and missing cells of a partially loaded room still exist on disk
+	if (!Room.HasLayout() && Room.AreCellsLoaded())
+		ValidateCells(Room);
+
+	if (RepairGizmo)
+		ValidateGizmo(Room);
+
+	Seconds += FPlatformTime::Seconds() - StartTime;
+	return NumProblems - ProblemsBefore;
+}
+
+void FPRGRoomValidator::LogSummary() const
+{
+	UE_LOG(LogPRGValidator, Display, TEXT("Validated %d rooms in %.2f ms. %d problems found, %d repaired."), NumRooms, Seconds * 1000.0, NumProblems, NumRepaired);
+}
+
+void FPRGRoomValidator::ValidateCells(APRG_Room& Room)
+{
+	const FIntPoint RoomSize = Room.GetRoomSize();
+	const int TileSizeCM = Room.GetTileSizeCM();
+	TArray<TObjectPtr<ATile>>& Tiles = Room.GetTiles();
+	TArray<TObjectPtr<AWall>>& Walls = Room.GetWalls();
+
+	// 1. Cell arrays must match the room size. Indices are meaningless otherwise, so rebuild the arrays from the attached cells
+	bool bRebuild = false;
+	if (Tiles.Num() != FPRGRoomCells::NumTiles(RoomSize) || Walls.Num() != FPRGRoomCells::NumWalls(RoomSize))
+	{
+		Report(Room, FString::Printf(TEXT("Cell arrays of %d tiles and %d walls do not match room size %dx%d."), Tiles.Num(), Walls.Num(), RoomSize.X, RoomSize.Y), bRepair);
+		if (!bRepair)
+			return;
+
+		BeginRepair(Room);
+		Tiles.Init(nullptr, FPRGRoomCells::NumTiles(RoomSize));
+		Walls.Init(nullptr, FPRGRoomCells::NumWalls(RoomSize));
+		bRebuild = true;
+	}
+
+	// 2. Every attached cell must be on the grid and the only cell at its index. Temporary cells of the room tool are not cells of the room
+	TBitArray<> TileSeen(false, Tiles.Num());
+	TBitArray<> WallSeen(false, Walls.Num());
+	TArray<AActor*> ChildActors;
+	Room.GetAttachedActors(ChildActors);
+	for (AActor* Child : ChildActors)
+	{
+		if (APRG_Room::IsTemporaryCell(Child))
+			continue;
+
+		if (ATile* Tile = Cast<ATile>(Child))
+		{
+			const int Index = Room.GetTileIndexByPosition(Tile->GetRootComponent()->GetRelativeLocation(), TileSizeCM);
+			const FVector IndexPosition = Tiles.IsValidIndex(Index) ? Room.GetTilePositionFromIndex(Index, TileSizeCM) : FVector::ZeroVector;
+			ValidateCell(Room, Tile, Index, IndexPosition, Tiles, TileSeen, bRebuild);
+		}
+		else if (AWall* Wall = Cast<AWall>(Child))
+		{
+			const int Index = Room.GetWallIndexByPosition(Wall->GetRootComponent()->GetRelativeLocation(), TileSizeCM);
+			const FVector IndexPosition = Walls.IsValidIndex(Index) ? Room.GetWallPositionFromIndex(Index, TileSizeCM) : FVector::ZeroVector;
+			ValidateCell(Room, Wall, Index, IndexPosition, Walls, WallSeen, bRebuild);
+		}
+	}
+
+	// 3. Array entries not claimed by an attached cell reference destroyed cells or cells of another room
+	ValidateUnclaimed(Room, Tiles, TileSeen);
+	ValidateUnclaimed(Room, Walls, WallSeen);
+
+	// 4. Stored wall types are either absent or one per wall. Types of walls past the array are solid
+	TArray<EPRGWallType>& WallTypes = Room.GetWallTypes();
+	if (WallTypes.Num() > 0 && WallTypes.Num() != Walls.Num())
+	{
+		Report(Room, FString::Printf(TEXT("%d wall types do not match %d walls."), WallTypes.Num(), Walls.Num()), bRepair);
+		if (bRepair)
+		{
+			BeginRepair(Room);
+			WallTypes.SetNum(Walls.Num());
+		}
+	}
+}
+
+template <class T>
+void FPRGRoomValidator::ValidateCell(APRG_Room& Room, T* Cell, int Index, const FVector& IndexPosition, TArray<TObjectPtr<T>>& Cells, TBitArray<>& Seen, bool bRebuild)
+{
+	// Indices of positions off the grid are rejected by the layout, the position check catches cells placed between grid positions
+	const FVector Position = Cell->GetRootComponent()->GetRelativeLocation();
+	const double Tolerance = Room.GetTileSizeCM() / 4;
+	if (!Cells.IsValidIndex(Index) || FMath::Abs(Position.X - IndexPosition.X) > Tolerance || FMath::Abs(Position.Y - IndexPosition.Y) > Tolerance)
+	{
+		Report(Room, FString::Printf(TEXT("%s is not on the room grid."), *Cell->GetName()), false);
+		return;
+	}
+
+	if (Seen[Index])
+	{
+		Report(Room, FString::Printf(TEXT("%s shares index %d with %s."), *Cell->GetName(), Index, Cells[Index] ? *Cells[Index]->GetName() : TEXT("another cell")), false);
+		return;
+	}
+	Seen[Index] = true;
+
+	if (Cells[Index] != Cell)
+	{
+		// Rebuilt arrays are filled here, which was reported once already
+		if (!bRebuild)
+			Report(Room, FString::Printf(TEXT("%s is not stored at index %d."), *Cell->GetName(), Index), bRepair);
+		if (bRepair)
+		{
+			BeginRepair(Room);
+			Cells[Index] = Cell;
+		}
+	}
+}
+
+template <class T>
+void FPRGRoomValidator::ValidateUnclaimed(APRG_Room& Room, TArray<TObjectPtr<T>>& Cells, const TBitArray<>& Seen)
+{
+	for (int i = 0; i < Cells.Num(); i++)
+	{
+		if (!Cells[i] || Seen[i])
+			continue;
+
+		Report(Room, FString::Printf(TEXT("Index %d references %s, which is not attached to the room."), i, IsValid(Cells[i]) ? *Cells[i]->GetName() : TEXT("a destroyed cell")), bRepair);
+		if (bRepair)
+		{
+			BeginRepair(Room);
+			Cells[i] = nullptr;
+		}
+	}
+}
+
+void FPRGRoomValidator::ValidateGizmo(APRG_Room& Room)
+{
+	// The tool finds moved rooms by their proxy, so a room without both cannot be moved
+	if (IsValid(Room.GetRoomGizmo()) && IsValid(Room.GetProxyTransform()))
+		return;
+
+	Report(Room, TEXT("Room has no gizmo bound to its transform proxy."), bRepair);
+	if (bRepair)
+		RepairGizmo(Room);
+}
+
+void FPRGRoomValidator::Report(const APRG_Room& Room, const FString& Problem, bool bRepaired)
+{
+	NumProblems++;
+	if (bRepaired)
+		NumRepaired++;
+
+	UE_LOG(LogPRGValidator, Warning, TEXT("%s: %s%s"), *Room.GetName(), *Problem, bRepaired ? TEXT(" Repaired.") : TEXT(""));
+}
+
+void FPRGRoomValidator::BeginRepair(APRG_Room& Room)
+{
+	if (bRoomModified)
+		return;
+
+	Room.Modify();
+	bRoomModified = true;
+	NumModifiedRooms++;
+}
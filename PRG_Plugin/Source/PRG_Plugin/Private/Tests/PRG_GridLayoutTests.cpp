@@ -0,0 +1,207 @@
+// Copyright 2022 Steven Weijden
+
+#include "Misc/AutomationTest.h"
+#include "PRG_GridLayout.h"
+#include "PRG_RoomCells.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Room sizes and tile sizes covered by the tests, including single rows and columns
+	const FIntPoint TestSizes[] = { { 1, 1 }, { 1, 4 }, { 4, 1 }, { 3, 2 }, { 7, 5 }, { 16, 16 } };
+	const int32 TestTileSizes[] = { 100, 200, 250 };
+
+	// End points of a wall, from its position and direction
+	void GetWallEnds(const FPRGGridLayout& Grid, int32 Index, FVector& OutStart, FVector& OutEnd)
+	{
+		const FVector Half = Grid.IsXWall(Index) ? FVector(Grid.HalfTileSize(), 0.0, 0.0) : FVector(0.0, Grid.HalfTileSize(), 0.0);
+		OutStart = Grid.WallPosition(Index) - Half;
+		OutEnd = Grid.WallPosition(Index) + Half;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPRGGridLayoutRoundTripTest, "PRG.GridLayout.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPRGGridLayoutRoundTripTest::RunTest(const FString& Parameters)
+{
+	for (const FIntPoint& Size : TestSizes)
+	{
+		for (const int32 TileSizeCM : TestTileSizes)
+		{
+			const FPRGGridLayout Grid(Size, TileSizeCM);
+			const FString Context = FString::Printf(TEXT("%dx%d, %d cm"), Size.X, Size.Y, TileSizeCM);
+
+			// Index to position and back, matching the cell data functions and the iteration helpers
+			for (int32 i = 0; i < Grid.NumTiles(); i++)
+			{
+				TestEqual(FString::Printf(TEXT("Tile %d round trip (%s)"), i, *Context), Grid.TileIndexAt(Grid.TilePosition(i)), i);
+				TestEqual(FString::Printf(TEXT("Tile %d remapped to its own size (%s)"), i, *Context), Grid.RemapTileIndex(i, Grid), i);
+				TestEqual(FString::Printf(TEXT("Tile %d position matches cell data (%s)"), i, *Context), Grid.TilePosition(i), FPRGRoomCells::GetTilePosition(Size, i, TileSizeCM));
+			}
+			for (int32 i = 0; i < Grid.NumWalls(); i++)
+			{
+				TestEqual(FString::Printf(TEXT("Wall %d round trip (%s)"), i, *Context), Grid.WallIndexAt(Grid.WallPosition(i)), i);
+				TestEqual(FString::Printf(TEXT("Wall %d remapped to its own size (%s)"), i, *Context), Grid.RemapWallIndex(i, Grid), i);
+				TestEqual(FString::Printf(TEXT("Wall %d position matches cell data (%s)"), i, *Context), Grid.WallPosition(i), FPRGRoomCells::GetWallPosition(Size, i, TileSizeCM));
+			}
+
+			int32 NumVisited = 0;
+			Grid.ForEachTile([&](int32 Index, const FVector& Position)
+			{
+				TestEqual(FString::Printf(TEXT("ForEachTile position of tile %d (%s)"), Index, *Context), Position, Grid.TilePosition(Index));
+				NumVisited++;
+			});
+			TestEqual(FString::Printf(TEXT("ForEachTile visits all tiles (%s)"), *Context), NumVisited, Grid.NumTiles());
+
+			NumVisited = 0;
+			Grid.ForEachWall([&](int32 Index, const FVector& Position, const FRotator& Rotation)
+			{
+				TestEqual(FString::Printf(TEXT("ForEachWall position of wall %d (%s)"), Index, *Context), Position, Grid.WallPosition(Index));
+				TestEqual(FString::Printf(TEXT("ForEachWall rotation of wall %d (%s)"), Index, *Context), Rotation, Grid.WallRotation(Index));
+				NumVisited++;
+			});
+			TestEqual(FString::Printf(TEXT("ForEachWall visits all walls (%s)"), *Context), NumVisited, Grid.NumWalls());
+
+			// Positions just outside the grid do not wrap into the next row or column
+			const double Width = Size.X * TileSizeCM;
+			const double Depth = Size.Y * TileSizeCM;
+			TestEqual(FString::Printf(TEXT("Tile left of the grid (%s)"), *Context), Grid.TileIndexAt(-1.0, Grid.HalfTileSize()), INDEX_NONE);
+			TestEqual(FString::Printf(TEXT("Tile right of the grid (%s)"), *Context), Grid.TileIndexAt(Width + 1.0, Grid.HalfTileSize()), INDEX_NONE);
+			TestEqual(FString::Printf(TEXT("Tile behind the grid (%s)"), *Context), Grid.TileIndexAt(Grid.HalfTileSize(), Depth + 1.0), INDEX_NONE);
+			TestEqual(FString::Printf(TEXT("Wall past the last grid line (%s)"), *Context), Grid.WallIndexAt(Width + TileSizeCM, Grid.HalfTileSize()), INDEX_NONE);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPRGGridLayoutNeighboursTest, "PRG.GridLayout.Neighbours", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPRGGridLayoutNeighboursTest::RunTest(const FString& Parameters)
+{
+	for (const FIntPoint& Size : TestSizes)
+	{
+		const FPRGGridLayout Grid(Size, 200);
+		const FString Context = FString::Printf(TEXT("%dx%d"), Size.X, Size.Y);
+		TArray<int32> Neighbours;
+
+		// Tiles are neighbours when their centers are one tile apart
+		for (int32 i = 0; i < Grid.NumTiles(); i++)
+		{
+			FPRGRoomCells::GetTileNeighbours(Size, i, Neighbours);
+			for (int32 j = 0; j < Grid.NumTiles(); j++)
+			{
+				const bool bExpected = FMath::IsNearlyEqual(FVector::Dist(Grid.TilePosition(i), Grid.TilePosition(j)), double(Grid.TileSizeCM));
+				TestTrue(FString::Printf(TEXT("Tile %d neighbour %d (%s)"), i, j, *Context), Neighbours.Contains(j) == bExpected);
+			}
+		}
+
+		// Walls are neighbours when they share an end point
+		for (int32 i = 0; i < Grid.NumWalls(); i++)
+		{
+			FVector Start, End;
+			GetWallEnds(Grid, i, Start, End);
+
+			FPRGRoomCells::GetWallNeighbours(Size, i, Neighbours);
+			for (int32 j = 0; j < Grid.NumWalls(); j++)
+			{
+				FVector OtherStart, OtherEnd;
+				GetWallEnds(Grid, j, OtherStart, OtherEnd);
+				const bool bExpected = i != j && (Start.Equals(OtherStart) || Start.Equals(OtherEnd) || End.Equals(OtherStart) || End.Equals(OtherEnd));
+				TestTrue(FString::Printf(TEXT("Wall %d neighbour %d (%s)"), i, j, *Context), Neighbours.Contains(j) == bExpected);
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPRGGridLayoutBatchTest, "PRG.GridLayout.Batch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPRGGridLayoutBatchTest::RunTest(const FString& Parameters)
+{
+	for (const FIntPoint& Size : TestSizes)
+	{
+		for (const int32 TileSizeCM : TestTileSizes)
+		{
+			const FPRGGridLayout Grid(Size, TileSizeCM);
+			const FString Context = FString::Printf(TEXT("%dx%d, %d cm"), Size.X, Size.Y, TileSizeCM);
+
+			// Every other cell, so the batch functions are not only tested on contiguous indices
+			TArray<int32> TileIndices;
+			for (int32 i = Grid.NumTiles() - 1; i >= 0; i -= 2)
+				TileIndices.Add(i);
+			TArray<int32> WallIndices;
+			for (int32 i = Grid.NumWalls() - 1; i >= 0; i -= 2)
+				WallIndices.Add(i);
+
+			// Indices to positions match the single cell functions
+			TArray<FVector> TilePositions;
+			TilePositions.SetNumUninitialized(TileIndices.Num());
+			Grid.TilePositions(TileIndices, TilePositions);
+			for (int32 i = 0; i < TileIndices.Num(); i++)
+				TestEqual(FString::Printf(TEXT("Tile %d batch position (%s)"), TileIndices[i], *Context), TilePositions[i], Grid.TilePosition(TileIndices[i]));
+
+			TArray<FVector> WallPositions;
+			WallPositions.SetNumUninitialized(WallIndices.Num());
+			Grid.WallPositions(WallIndices, WallPositions);
+			for (int32 i = 0; i < WallIndices.Num(); i++)
+				TestEqual(FString::Printf(TEXT("Wall %d batch position (%s)"), WallIndices[i], *Context), WallPositions[i], Grid.WallPosition(WallIndices[i]));
+
+			// Positions back to indices, with positions outside the grid mapping to INDEX_NONE
+			TilePositions.Add(FVector(-1.0, 0.0, 0.0));
+			TilePositions.Add(FVector(Size.X * TileSizeCM + 1.0, 0.0, 0.0));
+			TArray<int32> FoundTiles;
+			FoundTiles.SetNumUninitialized(TilePositions.Num());
+			Grid.TileIndicesAt(TilePositions, FoundTiles);
+			for (int32 i = 0; i < TileIndices.Num(); i++)
+				TestEqual(FString::Printf(TEXT("Tile %d batch round trip (%s)"), TileIndices[i], *Context), FoundTiles[i], TileIndices[i]);
+			TestEqual(FString::Printf(TEXT("Tile before the grid (%s)"), *Context), FoundTiles[TileIndices.Num()], int32(INDEX_NONE));
+			TestEqual(FString::Printf(TEXT("Tile past the grid (%s)"), *Context), FoundTiles[TileIndices.Num() + 1], int32(INDEX_NONE));
+
+			WallPositions.Add(FVector(-Grid.HalfTileSize() - 1.0, Grid.HalfTileSize(), 0.0));
+			TArray<int32> FoundWalls;
+			FoundWalls.SetNumUninitialized(WallPositions.Num());
+			Grid.WallIndicesAt(WallPositions, FoundWalls);
+			for (int32 i = 0; i < WallIndices.Num(); i++)
+				TestEqual(FString::Printf(TEXT("Wall %d batch round trip (%s)"), WallIndices[i], *Context), FoundWalls[i], WallIndices[i]);
+			TestEqual(FString::Printf(TEXT("Wall before the grid (%s)"), *Context), FoundWalls[WallIndices.Num()], int32(INDEX_NONE));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPRGGridLayoutBenchmark, "PRG.GridLayout.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FPRGGridLayoutBenchmark::RunTest(const FString& Parameters)
+{
+	const FPRGGridLayout Grid(64, 64, 200);
+	const int32 NumPasses = 200;
+
+	// Index to position and back for every cell, summing the indices so the loops are not optimized away
+	int64 Checksum = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Pass = 0; Pass < NumPasses; Pass++)
+	{
+		for (int32 i = 0; i < Grid.NumTiles(); i++)
+			Checksum += Grid.TileIndexAt(Grid.TilePosition(i));
+		for (int32 i = 0; i < Grid.NumWalls(); i++)
+			Checksum += Grid.WallIndexAt(Grid.WallPosition(i));
+	}
+	const double RoundTripSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// The same positions from the iteration helpers, which step rows instead of dividing per cell
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Pass = 0; Pass < NumPasses; Pass++)
+	{
+		Grid.ForEachTile([&Checksum](int32 Index, const FVector& Position) { Checksum += Index + int64(Position.X); });
+		Grid.ForEachWall([&Checksum](int32 Index, const FVector& Position, const FRotator&) { Checksum += Index + int64(Position.X); });
+	}
+	const double IterateSeconds = FPlatformTime::Seconds() - StartTime;
+
+	const double NumCells = double(NumPasses) * (Grid.NumTiles() + Grid.NumWalls());
+	AddInfo(FString::Printf(TEXT("Round trip: %.2f ns per cell, iteration: %.2f ns per cell, over %.0f cells (checksum %lld)."),
+		RoundTripSeconds * 1.0e9 / NumCells, IterateSeconds * 1.0e9 / NumCells, NumCells, Checksum));
+	return true;
+}
+
+#endif
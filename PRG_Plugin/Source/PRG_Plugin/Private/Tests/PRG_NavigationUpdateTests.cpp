@@ -0,0 +1,45 @@
+// Copyright 2022 Steven Weijden
+
+#include "Misc/AutomationTest.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "PRG_NavigationUpdate.h"
+#include "PRG_Room.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPRGNavigationUpdateTest, "PRG.Room.NavigationUpdate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPRGNavigationUpdateTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FNavigationSystem::AddNavigationSystemToWorld(*World, FNavigationSystemRunMode::GameMode);
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (!TestNotNull(TEXT("Navigation system"), NavigationSystem))
+	{
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	APRG_Room* Room = World->SpawnActor<APRG_Room>();
+	Room->InitRoom(FIntPoint(3, 2), 3, 100);
+	const bool bLockedBefore = NavigationSystem->IsNavigationBuildingLocked();
+
+	// Nested scopes spawning cells leave navigation as it was, so cells register and nothing is rebuilt on unlock
+	{
+		FPRGScopedNavigationUpdate NavigationUpdate(Room);
+		Room->SetTileAtIndex(0, Room->SpawnTile(Room->GetTilePositionFromIndex(0, Room->GetTileSizeCM()), nullptr));
+		{
+			FPRGScopedNavigationUpdate NestedUpdate(Room);
+			Room->SetWallAtIndex(0, Room->SpawnWall(Room->GetWallPositionFromIndex(0, Room->GetTileSizeCM()), Room->GetWallRotationByIndex(0), nullptr));
+		}
+		TestEqual(TEXT("Navigation lock within scope"), NavigationSystem->IsNavigationBuildingLocked(), bLockedBefore);
+	}
+	TestEqual(TEXT("Navigation lock after scope"), NavigationSystem->IsNavigationBuildingLocked(), bLockedBefore);
+	TestEqual(TEXT("Cells after scope"), Room->CountCells(), 2);
+
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
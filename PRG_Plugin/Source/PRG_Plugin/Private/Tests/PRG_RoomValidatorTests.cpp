@@ -0,0 +1,60 @@
+// Copyright 2022 Steven Weijden
+
+#include "Misc/AutomationTest.h"
+#include "Engine/World.h"
+#include "PRG_Room.h"
+#include "PRG_RoomValidator.h"
+#include "UObject/ObjectSaveContext.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPRGRoomSaveTemporaryCellsTest, "PRG.Room.SaveTemporaryCells", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPRGRoomSaveTemporaryCellsTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	APRG_Room* Room = World->SpawnActor<APRG_Room>();
+	Room->InitRoom(FIntPoint(3, 2), 3, 100);
+
+	// One persistent wall, and a placeholder for every empty wall as the room tool shows them in EditWalls mode
+	const int32 PersistentIndex = 0;
+	AWall* PersistentWall = Room->SpawnWall(Room->GetWallPositionFromIndex(PersistentIndex, Room->GetTileSizeCM()), Room->GetWallRotationByIndex(PersistentIndex), nullptr);
+	Room->SetWallAtIndex(PersistentIndex, PersistentWall);
+
+	TArray<AWall*> TemporaryWalls;
+	for (int32 i = 0; i < Room->GetWalls().Num(); i++)
+	{
+		if (i == PersistentIndex)
+			continue;
+
+		AWall* TemporaryWall = Room->SpawnWall(Room->GetWallPositionFromIndex(i, Room->GetTileSizeCM()), Room->GetWallRotationByIndex(i), nullptr);
+		APRG_Room::SetTemporaryCell(TemporaryWall, true);
+		TemporaryWalls.Add(TemporaryWall);
+	}
+
+	// Saving repairs the room, which must not store the placeholders as walls
+	FObjectSaveContextData SaveContext;
+	Room->PreSave(FObjectPreSaveContext(SaveContext));
+	for (int32 i = 0; i < Room->GetWalls().Num(); i++)
+		TestTrue(FString::Printf(TEXT("Wall %d after save"), i), Room->GetWalls()[i].Get() == (i == PersistentIndex ? PersistentWall : nullptr));
+	for (AWall* TemporaryWall : TemporaryWalls)
+		TestTrue(FString::Printf(TEXT("%s is transient"), *TemporaryWall->GetName()), TemporaryWall->HasAnyFlags(RF_Transient));
+	TestFalse(TEXT("Persistent wall is transient"), PersistentWall->HasAnyFlags(RF_Transient));
+
+	FPRGRoomValidator Validator(false);
+	Validator.ValidateRoom(*Room);
+	TestEqual(TEXT("Problems with placeholders"), Validator.GetNumProblems(), 0);
+
+	// Gathering skips the placeholders too, until one is made persistent
+	Room->GatherAttachedCells();
+	TestEqual(TEXT("Gathered walls"), Room->CountCells(), 1);
+	APRG_Room::SetTemporaryCell(TemporaryWalls[0], false);
+	Room->GatherAttachedCells();
+	TestEqual(TEXT("Gathered walls after making a placeholder persistent"), Room->CountCells(), 2);
+	TestFalse(TEXT("Persistent placeholder is transient"), TemporaryWalls[0]->HasAnyFlags(RF_Transient));
+
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
@@ -0,0 +1,178 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PRG_Building.generated.h"
+
+class APRG_Room;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+UENUM()
+enum class EPRGConnectorType : uint8
+{
+	Stairs,	// One mesh per level step, from the bottom level up to the level below the top
+	Shaft		// One mesh per level, from the bottom level up to and including the top level
+};
+
+/**
+ * Vertical connection between building levels. Removes the floor tile it occupies on every level above its bottom level
+ */
+USTRUCT()
+struct PRG_PLUGIN_API FPRGVerticalConnector
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Connector")
+	EPRGConnectorType Type = EPRGConnectorType::Stairs;
+	// Tile occupied on every level the connector spans
+	UPROPERTY(EditAnywhere, Category = "Connector", meta = (ClampMin = "0"))
+	FIntPoint Tile = FIntPoint::ZeroValue;
+	// Lowest level connected
+	UPROPERTY(EditAnywhere, Category = "Connector", meta = (ClampMin = "0"))
+	int32 BottomLevel = 0;
+	// Highest level connected
+	UPROPERTY(EditAnywhere, Category = "Connector", meta = (ClampMin = "1"))
+	int32 TopLevel = 1;
+	// Mesh placed per level step or level, in the room space of each level
+	UPROPERTY(EditAnywhere, Category = "Connector")
+	TObjectPtr<UStaticMesh> Mesh;
+};
+
+/**
+ * Floor tile removed by a connector, with the mesh to restore when no connector needs the opening anymore
+ */
+USTRUCT()
+struct PRG_PLUGIN_API FPRGConnectorOpening
+{
+	GENERATED_BODY()
+
+	// Room of the level the tile was removed from
+	UPROPERTY()
+	TObjectPtr<APRG_Room> Room;
+	// Column and row of the removed tile, so the opening follows the tile when the room is resized
+	UPROPERTY()
+	FIntPoint Tile = FIntPoint::ZeroValue;
+	// Mesh of the removed tile
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> Mesh;
+};
+
+/**
+ * One storey of a building
+ */
+USTRUCT()
+struct PRG_PLUGIN_API FPRGBuildingLevel
+{
+	GENERATED_BODY()
+
+	// Room holding the cell grid of this level
+	UPROPERTY(VisibleAnywhere, Category = "Level")
+	TObjectPtr<APRG_Room> Room;
+	// Show this level and its connectors in the editor
+	UPROPERTY(EditAnywhere, Category = "Level")
+	bool bVisible = true;
+};
+
+/**
+ * Address of a wall or tile within a building: the level and the cell index within the room of that level
+ */
+struct PRG_PLUGIN_API FPRGBuildingCell
+{
+	int32 Level = INDEX_NONE;
+	int32 Index = INDEX_NONE;
+
+	bool IsValid() const { return Level != INDEX_NONE && Index != INDEX_NONE; }
+	bool operator==(const FPRGBuildingCell& Other) const { return Level == Other.Level && Index == Other.Index; }
+	friend uint32 GetTypeHash(const FPRGBuildingCell& Cell) { return HashCombine(GetTypeHash(Cell.Level), GetTypeHash(Cell.Index)); }
+};
+
+/**
+ * Stacks rooms as the levels of one building. Each level is a room attached to the building at a multiple of the level height,
+ * so all levels share the building origin and move together. Cells are addressed by level and cell index.
+ */
+UCLASS(hidecategories = (Input, Collision, Replication, HLOD, Physics, Networking, Cooking))
+class PRG_PLUGIN_API APRG_Building : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	APRG_Building();
+
+	// Height of each level in meters
+	UPROPERTY(EditAnywhere, Category = "Building", meta = (ClampMin = "1", ClampMax = "20", UIMin = "1", UIMax = "20"))
+	int LevelHeight = 3;
+	// Levels from the ground up
+	UPROPERTY(EditAnywhere, Category = "Building", EditFixedSize, meta = (NoElementDuplicate))
+	TArray<FPRGBuildingLevel> Levels;
+	// Stairs and shafts between levels
+	UPROPERTY(EditAnywhere, Category = "Building")
+	TArray<FPRGVerticalConnector> Connectors;
+
+	// Add room as the new top level, attaching it to the building. Returns the new level index
+	int32 AddLevel(APRG_Room* Room);
+	// Remove levels whose room was deleted and move all rooms to the height of their level
+	UFUNCTION(CallInEditor, Category = "Building")
+	void RestackLevels();
+
+	// Number of levels
+	int32 NumLevels() const { return Levels.Num(); }
+	// Get room of a level, or nullptr if the level does not exist
+	APRG_Room* GetLevelRoom(int32 Level) const;
+	// Get level of a room, or INDEX_NONE if the room is not part of this building
+	int32 GetLevelIndex(const APRG_Room* Room) const;
+	// Get level at a height relative to the building origin, in cm. Clamped to existing levels
+	int32 GetLevelByHeight(float LocalZ) const;
+	// Height of a level relative to the building origin, in cm
+	float GetLevelOffsetCM(int32 Level) const { return Level * LevelHeight * 100.0f; }
+
+	// Get tile at a position relative to the building origin
+	FPRGBuildingCell GetTileByPosition(FVector LocalPosition) const;
+	// Get wall at a position relative to the building origin
+	FPRGBuildingCell GetWallByPosition(FVector LocalPosition) const;
+	// Get position of a tile relative to the building origin
+	FVector GetTilePosition(const FPRGBuildingCell& Cell) const;
+	// Get position of a wall relative to the building origin
+	FVector GetWallPosition(const FPRGBuildingCell& Cell) const;
+
+	// Show or hide a level with its connectors in the editor. Hidden levels stay loaded and are skipped by batched rendering
+	void SetLevelVisible(int32 Level, bool bVisible);
+	// Check if a level is shown
+	bool IsLevelVisible(int32 Level) const { return !Levels.IsValidIndex(Level) || Levels[Level].bVisible; }
+
+	// Remove the floor tiles occupied by connectors above their bottom level, and restore tiles no connector occupies anymore
+	void ApplyConnectorOpenings();
+
+protected:
+	// Create connector instances and apply level visibility, neither of which is saved on the cells
+	virtual void PostRegisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
+#endif
+
+private:
+	// Root component
+	UPROPERTY(EditAnywhere, Category = "Building")
+	USceneComponent* BaseComponent;
+
+	// Floor tiles removed by connectors. Saved, so tiles are restored when their connector is moved, shrunk or removed later
+	UPROPERTY()
+	TArray<FPRGConnectorOpening> ConnectorOpenings;
+
+	// Instanced connector meshes, one component per mesh and level so levels can be hidden on their own. Not saved
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> ConnectorComponents;
+	// Level of each connector component
+	TArray<int32> ConnectorComponentLevels;
+
+	// Recreate the instanced components of all connectors
+	void RebuildConnectors();
+	// Apply visibility of all levels to their rooms and connectors
+	void ApplyLevelVisibility();
+	// Get tile index of a connector in the room of a level, or INDEX_NONE if outside that room
+	int32 GetConnectorTileIndex(const FPRGVerticalConnector& Connector, int32 Level) const;
+};
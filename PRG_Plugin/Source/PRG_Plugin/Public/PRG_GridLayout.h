@@ -0,0 +1,255 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Cell math of the room grid, shared by rooms, cell data, the layout file and the tool. Header only and constexpr,
+ * so grid constants can be checked at compile time.
+ *
+ * Tiles are centered in each grid square. Walls run along the grid lines, X-aligned walls first, then Y-aligned walls.
+ * Index progression example on a 3x2 grid:
+ *
+ *     0       1      2
+ *  9     10      11     12
+ *     3       4      5
+ * 13     14      15     16
+ *     6       7      8
+ *
+ * Positions are in room space, in cm. Positions map to the cell they are nearest to, rounding down for negative
+ * positions as well. Positions outside the grid map to INDEX_NONE instead of wrapping into the next row.
+ */
+struct FPRGGridLayout
+{
+	// Room size in tile count
+	int32 SizeX = 1;
+	int32 SizeY = 1;
+	// Size of each tile in cm
+	int32 TileSizeCM = 200;
+
+	constexpr FPRGGridLayout() = default;
+	constexpr FPRGGridLayout(int32 InSizeX, int32 InSizeY, int32 InTileSizeCM)
+		: SizeX(InSizeX), SizeY(InSizeY), TileSizeCM(InTileSizeCM) {}
+	FPRGGridLayout(FIntPoint Size, int32 InTileSizeCM)
+		: SizeX(Size.X), SizeY(Size.Y), TileSizeCM(InTileSizeCM) {}
+
+	// Number of tiles
+	constexpr int32 NumTiles() const { return SizeX * SizeY; }
+	// Number of X-aligned walls, one more row than tiles
+	constexpr int32 NumXWalls() const { return SizeX * (SizeY + 1); }
+	// Number of Y-aligned walls, one more column than tiles
+	constexpr int32 NumYWalls() const { return (SizeX + 1) * SizeY; }
+	// Number of walls
+	constexpr int32 NumWalls() const { return NumXWalls() + NumYWalls(); }
+	// Check if the wall at index is aligned with the X axis
+	constexpr bool IsXWall(int32 Index) const { return Index < NumXWalls(); }
+
+	// Get index of the tile in column X and row Y. Returns INDEX_NONE outside the grid
+	constexpr int32 TileIndex(int32 X, int32 Y) const
+	{
+		return (X >= 0 && X < SizeX && Y >= 0 && Y < SizeY) ? X + Y * SizeX : INDEX_NONE;
+	}
+	// Get index of the X-aligned wall in column X on grid line Y. Returns INDEX_NONE outside the grid
+	constexpr int32 XWallIndex(int32 X, int32 Y) const
+	{
+		return (X >= 0 && X < SizeX && Y >= 0 && Y <= SizeY) ? X + Y * SizeX : INDEX_NONE;
+	}
+	// Get index of the Y-aligned wall on grid line X in row Y. Returns INDEX_NONE outside the grid
+	constexpr int32 YWallIndex(int32 X, int32 Y) const
+	{
+		return (X >= 0 && X <= SizeX && Y >= 0 && Y < SizeY) ? NumXWalls() + X + Y * (SizeX + 1) : INDEX_NONE;
+	}
+
+	// Get column of the tile at index
+	constexpr int32 TileX(int32 Index) const { return Index % SizeX; }
+	// Get row of the tile at index
+	constexpr int32 TileY(int32 Index) const { return Index / SizeX; }
+	// Get column, or grid line for Y-aligned walls, of the wall at index
+	constexpr int32 WallX(int32 Index) const { return IsXWall(Index) ? Index % SizeX : (Index - NumXWalls()) % (SizeX + 1); }
+	// Get grid line, or row for Y-aligned walls, of the wall at index
+	constexpr int32 WallY(int32 Index) const { return IsXWall(Index) ? Index / SizeX : (Index - NumXWalls()) / (SizeX + 1); }
+
+	// Offset of cell centers from the grid lines, in cm
+	constexpr int32 HalfTileSize() const { return TileSizeCM / 2; }
+	// Get local X position of the tile at index
+	constexpr double TilePositionX(int32 Index) const { return TileX(Index) * TileSizeCM + HalfTileSize(); }
+	// Get local Y position of the tile at index
+	constexpr double TilePositionY(int32 Index) const { return TileY(Index) * TileSizeCM + HalfTileSize(); }
+	// Get local X position of the wall at index
+	constexpr double WallPositionX(int32 Index) const { return WallX(Index) * TileSizeCM + (IsXWall(Index) ? HalfTileSize() : 0); }
+	// Get local Y position of the wall at index
+	constexpr double WallPositionY(int32 Index) const { return WallY(Index) * TileSizeCM + (IsXWall(Index) ? 0 : HalfTileSize()); }
+	// Get yaw of the wall at index, in degrees
+	constexpr double WallYaw(int32 Index) const { return IsXWall(Index) ? 0.0 : 90.0; }
+
+	// Get local position of the tile at index
+	FVector TilePosition(int32 Index) const { return FVector(TilePositionX(Index), TilePositionY(Index), 0.0); }
+	// Get local position of the wall at index
+	FVector WallPosition(int32 Index) const { return FVector(WallPositionX(Index), WallPositionY(Index), 0.0); }
+	// Get rotation of the wall at index
+	FRotator WallRotation(int32 Index) const { return FRotator(0.0, WallYaw(Index), 0.0); }
+
+	// Get index of the tile containing the local position. Returns INDEX_NONE outside the grid
+	constexpr int32 TileIndexAt(double X, double Y) const
+	{
+		return TileIndex(FloorToInt(X / TileSizeCM), FloorToInt(Y / TileSizeCM));
+	}
+	// Get index of the wall nearest to the local position. Returns INDEX_NONE outside the grid
+	constexpr int32 WallIndexAt(double X, double Y) const
+	{
+		// X-aligned walls are at half tiles along X, Y-aligned walls on the grid lines
+		const double CellX = X / TileSizeCM;
+		const double FractionX = CellX - FloorToInt(CellX);
+		if (FractionX >= 0.25 && FractionX < 0.75)
+			return XWallIndex(FloorToInt(CellX), RoundToInt(Y / TileSizeCM));
+
+		return YWallIndex(RoundToInt(CellX), FloorToInt(Y / TileSizeCM));
+	}
+	// Get index of the tile containing the local position. Returns INDEX_NONE outside the grid
+	int32 TileIndexAt(const FVector& Position) const { return TileIndexAt(Position.X, Position.Y); }
+	// Get index of the wall nearest to the local position. Returns INDEX_NONE outside the grid
+	int32 WallIndexAt(const FVector& Position) const { return WallIndexAt(Position.X, Position.Y); }
+
+	// Get local positions of the tiles at many indices. Both views must have the same size
+	void TilePositions(TArrayView<const int32> Indices, TArrayView<FVector> OutPositions) const
+	{
+		check(Indices.Num() == OutPositions.Num());
+		for (int32 i = 0; i < Indices.Num(); i++)
+			OutPositions[i] = TilePosition(Indices[i]);
+	}
+	// Get local positions of the walls at many indices. Both views must have the same size
+	void WallPositions(TArrayView<const int32> Indices, TArrayView<FVector> OutPositions) const
+	{
+		check(Indices.Num() == OutPositions.Num());
+		for (int32 i = 0; i < Indices.Num(); i++)
+			OutPositions[i] = WallPosition(Indices[i]);
+	}
+	// Get indices of the tiles containing many local positions, INDEX_NONE outside the grid. Both views must have the same size
+	void TileIndicesAt(TArrayView<const FVector> Positions, TArrayView<int32> OutIndices) const
+	{
+		check(Positions.Num() == OutIndices.Num());
+		for (int32 i = 0; i < Positions.Num(); i++)
+			OutIndices[i] = TileIndexAt(Positions[i].X, Positions[i].Y);
+	}
+	// Get indices of the walls nearest to many local positions, INDEX_NONE outside the grid. Both views must have the same size
+	void WallIndicesAt(TArrayView<const FVector> Positions, TArrayView<int32> OutIndices) const
+	{
+		check(Positions.Num() == OutIndices.Num());
+		for (int32 i = 0; i < Positions.Num(); i++)
+			OutIndices[i] = WallIndexAt(Positions[i].X, Positions[i].Y);
+	}
+
+	// Get index of the same tile in another layout. Returns INDEX_NONE if outside the other layout
+	constexpr int32 RemapTileIndex(int32 Index, const FPRGGridLayout& Other) const
+	{
+		return Other.TileIndex(TileX(Index), TileY(Index));
+	}
+	// Get index of the same wall in another layout. Returns INDEX_NONE if outside the other layout
+	constexpr int32 RemapWallIndex(int32 Index, const FPRGGridLayout& Other) const
+	{
+		return IsXWall(Index) ? Other.XWallIndex(WallX(Index), WallY(Index)) : Other.YWallIndex(WallX(Index), WallY(Index));
+	}
+	// Check if the wall at index lies on the outer edge of the room
+	constexpr bool IsExteriorWall(int32 Index) const
+	{
+		return IsXWall(Index) ? (WallY(Index) == 0 || WallY(Index) == SizeY) : (WallX(Index) == 0 || WallX(Index) == SizeX);
+	}
+
+	// Get indices of the tiles sharing an edge with the tile at index
+	void GetTileNeighbours(int32 Index, TArray<int32>& OutNeighbours) const
+	{
+		OutNeighbours.Reset();
+
+		const int32 X = TileX(Index);
+		const int32 Y = TileY(Index);
+		for (const int32 Neighbour : { TileIndex(X - 1, Y), TileIndex(X + 1, Y), TileIndex(X, Y - 1), TileIndex(X, Y + 1) })
+		{
+			if (Neighbour != INDEX_NONE)
+				OutNeighbours.Add(Neighbour);
+		}
+	}
+	// Get indices of the walls meeting the wall at index at either of its ends
+	void GetWallNeighbours(int32 Index, TArray<int32>& OutNeighbours) const
+	{
+		OutNeighbours.Reset();
+
+		// Lambda - Add all walls meeting at the given grid corner
+		auto AddWallsAtCorner = [this, Index, &OutNeighbours](int32 CornerX, int32 CornerY)
+		{
+			for (const int32 Neighbour : { XWallIndex(CornerX - 1, CornerY), XWallIndex(CornerX, CornerY), YWallIndex(CornerX, CornerY - 1), YWallIndex(CornerX, CornerY) })
+			{
+				if (Neighbour != INDEX_NONE && Neighbour != Index)
+					OutNeighbours.AddUnique(Neighbour);
+			}
+		};
+
+		// Each wall runs between two grid corners
+		const int32 X = WallX(Index);
+		const int32 Y = WallY(Index);
+		AddWallsAtCorner(X, Y);
+		if (IsXWall(Index))
+			AddWallsAtCorner(X + 1, Y);
+		else
+			AddWallsAtCorner(X, Y + 1);
+	}
+
+	// Call Func(Index, Position) for the tiles in columns [FromX, ToX) and rows [FromY, ToY), row by row without dividing per tile
+	template <typename FuncType>
+	void ForEachTileInRange(int32 FromX, int32 ToX, int32 FromY, int32 ToY, FuncType&& Func) const
+	{
+		for (int32 Y = FMath::Max(FromY, 0); Y < FMath::Min(ToY, SizeY); Y++)
+		{
+			const double PositionY = Y * TileSizeCM + HalfTileSize();
+			for (int32 X = FMath::Max(FromX, 0); X < FMath::Min(ToX, SizeX); X++)
+				Func(X + Y * SizeX, FVector(X * TileSizeCM + HalfTileSize(), PositionY, 0.0));
+		}
+	}
+	// Call Func(Index, Position) for all tiles
+	template <typename FuncType>
+	void ForEachTile(FuncType&& Func) const
+	{
+		ForEachTileInRange(0, SizeX, 0, SizeY, Func);
+	}
+	// Call Func(Index, Position, Rotation) for all walls, X-aligned walls first
+	template <typename FuncType>
+	void ForEachWall(FuncType&& Func) const
+	{
+		const FRotator XRotation(0.0, 0.0, 0.0);
+		for (int32 Y = 0; Y <= SizeY; Y++)
+		{
+			for (int32 X = 0; X < SizeX; X++)
+				Func(X + Y * SizeX, FVector(X * TileSizeCM + HalfTileSize(), Y * TileSizeCM, 0.0), XRotation);
+		}
+
+		const FRotator YRotation(0.0, 90.0, 0.0);
+		for (int32 Y = 0; Y < SizeY; Y++)
+		{
+			for (int32 X = 0; X <= SizeX; X++)
+				Func(NumXWalls() + X + Y * (SizeX + 1), FVector(X * TileSizeCM, Y * TileSizeCM + HalfTileSize(), 0.0), YRotation);
+		}
+	}
+
+	// Round down, also for negative values. FMath::FloorToInt is not constexpr
+	static constexpr int32 FloorToInt(double Value)
+	{
+		const int32 Truncated = static_cast<int32>(Value);
+		return Value < Truncated ? Truncated - 1 : Truncated;
+	}
+	// Round to nearest, halves rounding up
+	static constexpr int32 RoundToInt(double Value)
+	{
+		return FloorToInt(Value + 0.5);
+	}
+};
+
+// Compile time checks of the index progression and position round trips, using the 3x2 example above
+static_assert(FPRGGridLayout(3, 2, 200).NumWalls() == 17, "Wall count of a 3x2 room");
+static_assert(FPRGGridLayout(3, 2, 200).WallIndexAt(100.0, 0.0) == 0, "First X-aligned wall");
+static_assert(FPRGGridLayout(3, 2, 200).WallIndexAt(0.0, 100.0) == 9, "First Y-aligned wall");
+static_assert(FPRGGridLayout(3, 2, 200).WallIndexAt(600.0, 300.0) == 16, "Last Y-aligned wall");
+static_assert(FPRGGridLayout(3, 2, 200).WallIndexAt(FPRGGridLayout(3, 2, 200).WallPositionX(13), FPRGGridLayout(3, 2, 200).WallPositionY(13)) == 13, "Wall round trip");
+static_assert(FPRGGridLayout(3, 2, 200).TileIndexAt(FPRGGridLayout(3, 2, 200).TilePositionX(5), FPRGGridLayout(3, 2, 200).TilePositionY(5)) == 5, "Tile round trip");
+static_assert(FPRGGridLayout(3, 2, 200).TileIndexAt(-10.0, 100.0) == INDEX_NONE, "Negative positions are outside the grid");
+static_assert(FPRGGridLayout(3, 2, 200).TileIndexAt(700.0, 100.0) == INDEX_NONE, "Positions past the last column do not wrap");
+static_assert(FPRGGridLayout(3, 2, 200).RemapWallIndex(9, FPRGGridLayout(4, 2, 200)) == 12, "Y-aligned wall remapped to a wider room");
@@ -0,0 +1,101 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PRG_RoomCells.h"
+
+class APRG_Room;
+class FArchive;
+
+/* Binary layout file format, all values little endian:
+ *
+ * Header:   Magic, Version, RoomCount, PaletteOffset
+ * Records:  RoomCount times [Location, Rotation, packed RoomSize/RoomHeight/TileSizeCM, tile runs, wall runs, wall type runs]
+ * Palette:  Mesh count followed by the soft object path of each mesh
+ *
+ * Cell arrays are stored as runs of (packed count, packed palette index + 1), where 0 marks empty cells.
+ * Wall types use the same runs with the type as value, and are only present from version WallTypes on.
+ * The palette is written last so rooms can be streamed to disk without knowing all meshes up front.
+ */
+namespace PRGLayoutFile
+{
+	// "PRGL"
+	constexpr uint32 Magic = 0x4C475250;
+
+	enum class EVersion : uint32
+	{
+		Initial = 1,
+		// Door, window and open wall types
+		WallTypes = 2,
+
+		// Add new versions above this line
+		VersionPlusOne,
+		Latest = VersionPlusOne - 1
+	};
+
+	// File extension used for layout files
+	constexpr const TCHAR* Extension = TEXT("prglayout");
+}
+
+/**
+ * Placement and cell data of one room as stored in a layout file
+ */
+struct PRG_PLUGIN_API FPRGRoomRecord
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FPRGRoomCells Cells;
+};
+
+/**
+ * Writes rooms to a layout file one record at a time
+ */
+class PRG_PLUGIN_API FPRGLayoutWriter
+{
+public:
+	~FPRGLayoutWriter();
+
+	// Create the file and write a placeholder header. Returns false if the file can not be created
+	bool Open(const FString& FilePath);
+	// Append a record for the given room
+	void WriteRoom(const APRG_Room& Room);
+	// Write the palette and patch the header. Returns false if any write failed
+	bool Close();
+
+	// Write all given rooms to a new layout file
+	static bool WriteFile(const FString& FilePath, const TArray<TObjectPtr<APRG_Room>>& Rooms);
+
+private:
+	TUniquePtr<FArchive> Writer;
+	FPRGMeshPalette Palette;
+	int32 RoomCount = 0;
+};
+
+/**
+ * Streams room records from a layout file in chunks, so large files are never held in memory at once
+ */
+class PRG_PLUGIN_API FPRGLayoutReader
+{
+public:
+	~FPRGLayoutReader();
+
+	// Open file and load header and palette. Returns false if the file is missing, corrupt or of a newer version
+	bool Open(const FString& FilePath);
+	// Read up to MaxRecords records, replacing the content of OutRecords. Returns false when no records remain
+	bool ReadRecords(int MaxRecords, TArray<FPRGRoomRecord>& OutRecords);
+	// Spawn a room with all its cells from a record. Cells with meshes missing from the palette use the fallback meshes
+	TObjectPtr<APRG_Room> SpawnRoom(UWorld* World, const FPRGRoomRecord& Record, UStaticMesh* FallbackFloorMesh, UStaticMesh* FallbackWallMesh) const;
+
+	// Number of rooms stored in the file
+	int32 GetRoomCount() const { return RoomCount; }
+	// Number of rooms read so far
+	int32 GetRoomsRead() const { return RoomsRead; }
+
+private:
+	TUniquePtr<FArchive> Reader;
+	FPRGMeshPalette Palette;
+	uint32 FileVersion = 0;
+	int32 RoomCount = 0;
+	int32 RoomsRead = 0;
+};
@@ -0,0 +1,36 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APRG_Room;
+
+/**
+ * Dirties the room bounds before and after an operation that spawns, changes or destroys many cells as one area,
+ * so the navmesh rebuilds the tiles the room covered and covers once. Navigation is not locked, cells register with
+ * navigation as usual and a locked navigation system would rebuild all navigation when unlocked.
+ * Scopes can be nested, also for different rooms. The outermost scope of a world dirties the bounds of all its
+ * nested scopes as one area when it ends.
+ */
+class PRG_PLUGIN_API FPRGScopedNavigationUpdate
+{
+public:
+	explicit FPRGScopedNavigationUpdate(APRG_Room* InRoom);
+	~FPRGScopedNavigationUpdate();
+
+private:
+	TWeakObjectPtr<APRG_Room> Room;
+	TWeakObjectPtr<UWorld> World;
+	// Set when the scope counts towards the depth of its world
+	bool bInScope = false;
+	// Room bounds when the scope started, so cells removed by the operation are covered as well
+	FBox BoundsBefore = FBox(ForceInit);
+	// Active scopes of one world and the bounds they dirtied so far
+	struct FWorldScopes
+	{
+		int32 Depth = 0;
+		FBox DirtyBounds = FBox(ForceInit);
+	};
+	static TMap<TWeakObjectPtr<UWorld>, FWorldScopes> WorldScopes;
+};
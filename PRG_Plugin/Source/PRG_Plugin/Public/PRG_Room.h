@@ -6,12 +6,39 @@
 #include "GameFramework/Actor.h"
 #include "BaseGizmos/GizmoActor.h"
 #include "Engine/StaticMeshActor.h"
+#include "PRG_RoomCells.h"
 #include "PRG_Room.generated.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogPRGRoom, Log, All);
+
+UENUM()
+enum class ERoomChange : uint8
+{
+	Transform,	// Room was moved or rotated
+	Cells,			// Walls or tiles were added, removed or changed
+	Visibility,	// Room was hidden or shown
+	Removed			// Room is being destroyed
+};
+
+// Reasons a room can be hidden for. The room stays hidden while any reason applies
+enum class ERoomHiddenBy : uint8
+{
+	None			= 0,
+	Building	= 1 << 0,	// Level hidden by its building, in the editor only
+	Isolation	= 1 << 1,	// Outside the isolated rooms of the tool, in the editor only
+	Portals		= 1 << 2	// Not seen through the openings of the camera room, in game and editor
+};
+ENUM_CLASS_FLAGS(ERoomHiddenBy);
+
 DECLARE_DELEGATE_OneParam(FOnRoomDeletionDelegate, TObjectPtr<APRG_Room>);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnRoomChangedDelegate, APRG_Room*, ERoomChange);
 
 class UTransformProxy;
 class UCombinedTransformGizmo;
+class UInstancedStaticMeshComponent;
+class UPRG_RoomLayout;
+class UPRG_RoomCollisionComponent;
+class APRG_Building;
 
 UCLASS()
 class PRG_PLUGIN_API AWall : public AStaticMeshActor
@@ -19,6 +46,12 @@ class PRG_PLUGIN_API AWall : public AStaticMeshActor
 	GENERATED_BODY()
 
 	AWall();
+
+protected:
+	// Tell the room that one of its cells was loaded
+	virtual void PostRegisterAllComponents() override;
+	// Tell the room that one of its cells was unloaded
+	virtual void PostUnregisterAllComponents() override;
 };
 
 UCLASS()
@@ -27,6 +60,12 @@ class PRG_PLUGIN_API ATile : public AStaticMeshActor
 	GENERATED_BODY()
 
 	ATile();
+
+protected:
+	// Tell the room that one of its cells was loaded
+	virtual void PostRegisterAllComponents() override;
+	// Tell the room that one of its cells was unloaded
+	virtual void PostUnregisterAllComponents() override;
 };
 
 UCLASS()
@@ -38,20 +77,47 @@ public:
 	// Sets default values for this actor's properties
 	APRG_Room();
 	// Must have default ctor for UObject initialization. So set input based init afterwards
-	void InitRoom(FIntPoint NewSize = FIntPoint(0, 0), int NewHeight = 0);
-	// Empty stored data when tool is exited
+	void InitRoom(FIntPoint NewSize = FIntPoint(0, 0), int NewHeight = 0, int NewTileSizeCM = 0);
+	// Release tool data when tool is exited. Cell arrays are kept, as they are saved with the room
 	void CleanupRoom();
 
 	// Delegate to handle cleanup of room deletion, if not done via tool
 	FOnRoomDeletionDelegate OnRoomDeletion;
+	// Delegate broadcast when any room changes, for systems derived from room content
+	static FOnRoomChangedDelegate OnAnyRoomChanged;
+
+	// Broadcast a change of this room to OnAnyRoomChanged
+	void NotifyRoomChanged(ERoomChange Change);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called after all components are registered. Creates layout instances, which are not saved
+	virtual void PostRegisterAllComponents() override;
+	// Called after all components are unregistered, e.g. when the room's level is streamed out
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditMove(bool bFinished) override;
+#endif
+
 	// Called when this actor is explicitly being destroyed during gameplay or in the editor
 	virtual void Destroyed() override;
 
+	// Store number of occupied cells, to detect partially loaded rooms later
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+	// Record the room data version, see FPRGRoomVersion
+	virtual void Serialize(FArchive& Ar) override;
+	// Take the tile size of rooms saved before it was stored from the map settings
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	// Cover all cells, so World Partition places the room in the cells its content overlaps
+	virtual FBox GetStreamingBounds() const override;
+#endif
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -73,9 +139,9 @@ public:
 	// Get array of persistent tiles of room
 	TArray<TObjectPtr<ATile>>& GetTiles();
 
-	// Calculate the tile index based on the local tile position
+	// Calculate the tile index based on the local tile position. Returns INDEX_NONE outside the room
 	int GetTileIndexByPosition(FVector Position, int TileSizeCM) const;
-	// Calculate the wall index based on the local wall position
+	// Calculate the wall index based on the local wall position. Returns INDEX_NONE outside the room
 	int GetWallIndexByPosition(FVector Position, int TileSizeCM) const;
 
 	// Calculate the local tile position based on tile index
@@ -88,15 +154,127 @@ public:
 	// Assign given wall to persistent wall array at given index
 	void SetWallAtIndex(int Index, TObjectPtr<AWall> NewWall);
 
+	// Mark a wall or tile as a temporary placeholder, e.g. an empty cell shown by the room tool. Temporary cells are transient and not cells of the room
+	static void SetTemporaryCell(AActor* Cell, bool bTemporary);
+	// Check if a wall or tile is a temporary placeholder, see SetTemporaryCell
+	static bool IsTemporaryCell(const AActor* Cell);
+
 	// Calculate wall rotation based on index
 	FRotator GetWallRotationByIndex(int Index) const;
 
+	// Spawn a tile actor at the given local position and attach it to this room
+	TObjectPtr<ATile> SpawnTile(FVector Position, UStaticMesh* Mesh);
+	// Spawn a wall actor at the given local position and rotation and attach it to this room
+	TObjectPtr<AWall> SpawnWall(FVector Position, FRotator Rotation, UStaticMesh* Mesh);
+
+	// Store occupancy and mesh of all cells, adding used meshes to the palette
+	void CaptureCells(FPRGRoomCells& OutCells, FPRGMeshPalette& Palette) const;
+	// Spawn walls and tiles for all occupied cells. Room must be initialized to the size of Cells and be empty
+	void SpawnCells(const FPRGRoomCells& Cells, const FPRGMeshPalette& Palette, UStaticMesh* FallbackFloorMesh, UStaticMesh* FallbackWallMesh);
+	// Fill wall and tile arrays from the actors attached to this room, e.g. after loading a map
+	void GatherAttachedCells();
+	// Hash of the current cells of this room, see FPRGRoomCells::GetContentHash
+	uint32 GetContentHash() const;
+	// Hash of what RegenerateCells builds from: the cells, with occupied cells that have no mesh or the recorded default mesh counted as default, and the given default meshes
+	uint32 GetRegenerationHash(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh) const;
+	// Check if the cells were last regenerated from the same inputs, see GetRegenerationHash
+	bool IsRegenerationCurrent(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh) const { return RegenerationHash != 0 && RegenerationHash == GetRegenerationHash(DefaultFloorMesh, DefaultWallMesh); }
+	// Give cells that use the default meshes, or no mesh, the given default meshes, unless the regeneration hash is current and not forced.
+	// Only cells whose mesh differs are changed, and rooms with a shared layout are skipped. Returns true if any cell changed
+	bool RegenerateCells(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh, bool bForce);
+	// Record the default meshes the cells were built with, so regeneration moves them to new defaults. nullptr keeps the recorded mesh
+	void SetDefaultMeshes(UStaticMesh* DefaultFloorMesh, UStaticMesh* DefaultWallMesh);
+	// Gather cells from attached actors if the cell arrays were never filled or were cleared by CleanupRoom
+	void EnsureCellsGathered();
+	// Destroy all wall and tile actors of this room
+	void DestroyCells();
+	// Change room size, keeping cells inside both sizes at their grid position. Cells outside the new size are destroyed
+	void ResizeCells(FIntPoint NewSize);
+	// Set mesh of a range of walls or tiles. Spawns missing cells, and destroys cells when Mesh is nullptr
+	void SetCellMeshes(bool bWalls, int32 First, int32 Count, UStaticMesh* Mesh);
+	// Swap the mesh of all walls or tiles using FromMesh, or of all of them when FromMesh is nullptr. Keeps the cell actors. Returns number of cells changed
+	int32 ReplaceCellMeshes(bool bWalls, const UStaticMesh* FromMesh, UStaticMesh* ToMesh);
+	// Get type of the wall at index. Slots holding a wall actor are solid, whatever type was set before
+	EPRGWallType GetWallType(int32 Index) const;
+	// Check if the wall at index is a door, window or opening
+	bool IsWallOpening(int32 Index) const { return GetWallType(Index) != EPRGWallType::Solid; }
+	// Set type of a range of walls. Doors, windows and openings destroy the wall actors of their slots, solid walls spawn SolidMesh in empty slots when given
+	void SetWallTypes(int32 First, int32 Count, EPRGWallType Type, UStaticMesh* SolidMesh = nullptr);
+	// Get array of stored wall types, parallel to the wall array. Empty when all walls are solid
+	TArray<EPRGWallType>& GetWallTypes() { return WallTypes; }
+	// Get mesh rendering walls of a type. Returns nullptr for solid walls and openings
+	static UStaticMesh* GetWallTypeMesh(EPRGWallType Type);
+	// Number of walls and tiles currently referenced by this room
+	int32 CountCells() const;
+	// Check that all cells saved with this room are loaded. Rooms in World Partition can be partially loaded in the editor
+	bool AreCellsLoaded();
+	// Called when a cell of this room is unloaded without being destroyed, so the room checks again if it is complete
+	void OnCellUnloaded() { bCellsLoaded = false; }
+	// Called when a cell is loaded after this room, e.g. from another World Partition cell. Room collision follows on the next tick
+	void OnCellLoaded(AStaticMeshActor* Cell);
+
+#if WITH_EDITOR
+	// Copy runtime grid, spatial loading and HLOD layer of the room to all cells, so the room streams as one unit
+	void PropagateStreamingSettings();
+	// Copy runtime grid, spatial loading and HLOD layer of the room to a single cell
+	void ApplyStreamingSettings(AActor* Cell) const;
+#endif
+
+	// Get the static mesh components rendering the cells, from either the cell actors or the layout instances
+	void GetCellMeshComponents(TArray<UStaticMeshComponent*>& OutComponents) const;
+	// Get world transforms of all cells, grouped by mesh
+	void GatherCellInstances(TMap<UStaticMesh*, TArray<FTransform>>& OutInstances) const;
+	// Show or hide the cells of this room, e.g. when another actor renders them. Not saved
+	void SetCellRendering(bool bVisible);
+
+	// Hide room and all its cells for the given reason. Cells stay loaded. Isolated rooms and building levels are not hidden in game
+	void SetRoomHidden(bool bHidden, ERoomHiddenBy Reason = ERoomHiddenBy::Building);
+	// Check if room was hidden with SetRoomHidden for any reason
+	bool IsRoomHidden() const { return HiddenBy != ERoomHiddenBy::None; }
+	// Check if room is hidden in its world, skipping reasons that only apply to the editor while in a game world
+	bool IsRoomHiddenInWorld() const;
+	// Check if room was hidden with SetRoomHidden for the given reason
+	bool IsRoomHiddenBy(ERoomHiddenBy Reason) const { return EnumHasAnyFlags(HiddenBy, Reason); }
+	// Get building this room is a level of, if any
+	APRG_Building* GetBuilding() const;
+
+	// Replace the collision of cells with merged boxes of the room collision, or restore per-cell collision when disabled or edited
+	void UpdateRoomCollision();
+	// Get merged collision of all cells, if the room collision is in use
+	UPRG_RoomCollisionComponent* GetRoomCollision() const { return RoomCollision; }
+	// Rebuild the depth only occluder from merged wall runs and floor rectangles, or remove it when disabled or edited
+	void UpdateRoomOccluder();
+
+	// Exclude room from level-wide batching, so it renders its own cells while being edited
+	void SetExcludedFromBatching(bool bExclude);
+	// Check if room is excluded from level-wide batching
+	bool IsExcludedFromBatching() const { return bExcludedFromBatching; }
+
+	// Reference a shared layout instead of owning wall and tile actors. Destroys existing cell actors
+	void SetLayout(UPRG_RoomLayout* NewLayout);
+	// Get shared layout, if any
+	UPRG_RoomLayout* GetLayout() const { return Layout; }
+	// Check if the cells of this room come from a shared layout
+	bool HasLayout() const { return Layout != nullptr; }
+
+	// Set merged mesh baked from all cells of this room, in room space, and the content hash of the cells it was baked from
+	void SetBakedMesh(TObjectPtr<UStaticMesh> Mesh, uint32 ContentHash) { BakedMesh = Mesh; BakedMeshHash = ContentHash; }
+	// Get merged mesh baked from all cells of this room, in room space
+	TObjectPtr<UStaticMesh> GetBakedMesh() const { return BakedMesh; }
+	// Check if the baked mesh was baked from cells with the given content hash
+	bool IsBakedMeshCurrent(uint32 ContentHash) const { return BakedMesh && BakedMeshHash == ContentHash; }
+
+	// Get world bounds of all cells, including walls on the room border
+	FBox GetRoomBounds() const;
+
 	// Set room size, in tile count
 	void SetRoomSize(FIntPoint NewSize) { RoomSize = NewSize; }
 	// Get room size, in tile count
 	FIntPoint GetRoomSize() { return RoomSize; }
 	// Get room height, in meters
 	int GetRoomHeight() { return RoomHeight; }
+	// Get tile size, in cm
+	int GetTileSizeCM() const { return TileSizeCM; }
 
 protected:
 	// Handle to control room gizmo lifetime
@@ -110,14 +288,104 @@ protected:
 	// Room height in meters
 	UPROPERTY(EditAnywhere, Category = "Room")
 	int RoomHeight = 1;
+	// Tile size in cm, as used when the room was created
+	UPROPERTY(VisibleAnywhere, Category = "Room")
+	int TileSizeCM = 200;
+	// Merged mesh of all cells, created by the room commandlet
+	UPROPERTY(VisibleAnywhere, Category = "Room")
+	TObjectPtr<UStaticMesh> BakedMesh;
+	// Shared cell layout. When set, cells are rendered as instances instead of wall and tile actors
+	UPROPERTY(EditAnywhere, Category = "Room")
+	TObjectPtr<UPRG_RoomLayout> Layout;
+	// Collide with merged boxes for runs of walls and rectangles of tiles instead of one body per cell
+	UPROPERTY(EditAnywhere, Category = "Room")
+	bool bUseRoomCollision = true;
+	// Write merged boxes of solid walls and floors to depth only, so the room hides what is behind it from occlusion culling
+	UPROPERTY(EditAnywhere, Category = "Room")
+	bool bUseRoomOccluder = true;
 
 private:
 	// Root component
 	UPROPERTY(EditAnywhere, Category = "Room")
 	USceneComponent* BaseComponent;
 
-	// Array of all possible walls within a room
+	// Array of all possible walls within a room. Saved, so World Partition keeps the room and its cells in one actor cluster
+	UPROPERTY()
 	TArray<TObjectPtr<AWall>> Walls;
-	// Array of all possible tiles within a room
+	// Array of all possible tiles within a room. Saved, so World Partition keeps the room and its cells in one actor cluster
+	UPROPERTY()
 	TArray<TObjectPtr<ATile>> Tiles;
+	// Type of every wall slot. Empty when all walls are solid
+	UPROPERTY()
+	TArray<EPRGWallType> WallTypes;
+	// Number of occupied cells when the room was last saved
+	UPROPERTY()
+	int32 SavedCellCount = 0;
+	// Default floor and wall mesh the cells were last built with. Cells still using them follow new defaults when regenerated
+	UPROPERTY()
+	TSoftObjectPtr<UStaticMesh> BuiltFloorMesh;
+	UPROPERTY()
+	TSoftObjectPtr<UStaticMesh> BuiltWallMesh;
+	// Regeneration hash when the cells were last spawned or regenerated. Regeneration skips rooms whose inputs did not change since
+	UPROPERTY()
+	uint32 RegenerationHash = 0;
+	// Content hash of the cells the baked mesh was made from
+	UPROPERTY()
+	uint32 BakedMeshHash = 0;
+	// Set once all saved cells were found loaded, cleared when one of them is unloaded
+	bool bCellsLoaded = false;
+	// Set for rooms saved before the tile size was stored, until it is taken from the map settings
+	bool bLegacyTileSize = false;
+	// Set while cells loaded after the room wait to be applied
+	bool bCellLoadPending = false;
+	// Set when a loaded cell was not found in the cell arrays
+	bool bCellGatherPending = false;
+
+	// Instanced mesh component per layout palette entry, while not rendered by the renderer or needed for collision. Recreated from the layout, so not saved
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> LayoutComponents;
+	// Merged collision of all cells. Rebuilt from the cells, so not saved
+	UPROPERTY(Transient)
+	TObjectPtr<UPRG_RoomCollisionComponent> RoomCollision;
+	// Content hash of the cells the room collision was built from
+	uint32 RoomCollisionHash = 0;
+	// Depth only boxes of the walls and floors. Rebuilt from the cells, so not saved
+	UPROPERTY(Transient)
+	TObjectPtr<UInstancedStaticMeshComponent> RoomOccluder;
+	// Content hash of the cells the room occluder was built from
+	uint32 RoomOccluderHash = 0;
+	// Content hash of the layout the layout instances were built from
+	uint32 LayoutInstancesHash = 0;
+	// Instanced mesh component per wall type, rendering all doors or windows of the room. Recreated from the wall types, so not saved
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> OpeningComponents;
+	// Hash of the wall types the opening instances were built from
+	uint32 OpeningInstancesHash = 0;
+	// Layout the delegate is currently bound to
+	TWeakObjectPtr<UPRG_RoomLayout> BoundLayout;
+	// Set while the room is being edited cell by cell
+	bool bExcludedFromBatching = false;
+	// Reasons the room is hidden for. Applied again by the building or tool on load
+	ERoomHiddenBy HiddenBy = ERoomHiddenBy::None;
+	// Cleared while another actor renders the cells. Applied again by that actor on load
+	bool bCellRendering = true;
+
+	// Show or hide room and cells from the hidden reasons and cell rendering
+	void UpdateRoomVisibility();
+	// Store occupancy and mesh of all cell actors for regeneration. Palette index 0 is nullptr and marks cells without a mesh or with the recorded default mesh
+	void CaptureRegenerationCells(FPRGRoomCells& OutCells, FPRGMeshPalette& Palette) const;
+	// Match room size to the layout and recreate the instanced components
+	void RebuildLayoutInstances();
+	// Create or remove layout components, depending on cell rendering and the room collision
+	void UpdateLayoutComponents();
+	// Check if the collision of a cell mesh is part of the room collision
+	bool IsCollisionMerged(const UStaticMesh* Mesh) const;
+	// Fill the instanced components of doors and windows from the wall types
+	void UpdateOpeningInstances();
+	// Bind to changes of the current layout, unbinding from the previous one
+	void BindLayout();
+	// Called when the shared layout changed
+	void OnLayoutChanged(UPRG_RoomLayout* ChangedLayout);
+	// Set the tile size of a legacy room from the settings actor of a level. Returns false if the level has none
+	bool ApplyLegacyTileSize(const ULevel* Level);
 };
\ No newline at end of file
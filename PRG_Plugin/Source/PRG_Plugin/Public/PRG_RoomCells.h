@@ -0,0 +1,117 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PRG_GridLayout.h"
+#include "PRG_RoomCells.generated.h"
+
+class UStaticMesh;
+
+// What fills a wall slot. Doors and windows are rendered as instances of the room, not as wall actors
+UENUM()
+enum class EPRGWallType : uint8
+{
+	Solid,		// Wall actor or layout instance with its own mesh, or nothing when the slot is empty
+	Door,		// Doorway using the door mesh
+	Window,		// Wall with a window, using the window mesh
+	Open,		// Opening without a mesh
+	Count	UMETA(Hidden)
+};
+
+/**
+ * Ordered set of meshes used by room cells. Cells store an index into the palette instead of a mesh reference
+ */
+USTRUCT()
+struct PRG_PLUGIN_API FPRGMeshPalette
+{
+	GENERATED_BODY()
+
+	// Meshes in order of first use
+	UPROPERTY(EditAnywhere, Category = "Palette")
+	TArray<TObjectPtr<UStaticMesh>> Meshes;
+
+	// Get palette index of mesh, adding it when not yet in the palette. Returns INDEX_NONE for nullptr
+	int32 FindOrAdd(UStaticMesh* Mesh);
+	// Get mesh at palette index. Returns nullptr for INDEX_NONE or out of range indices
+	UStaticMesh* GetMesh(int32 Index) const;
+	// Remove all meshes
+	void Reset();
+
+	int32 Num() const { return Meshes.Num(); }
+
+private:
+	// Mesh to index lookup. Rebuilt when out of sync with Meshes, e.g. after loading
+	TMap<UStaticMesh*, int32> Lookup;
+};
+
+/**
+ * Cell grid of a room. Stores occupancy and mesh of every tile and wall as palette indices.
+ * The static cell functions forward to FPRGGridLayout
+ */
+USTRUCT()
+struct PRG_PLUGIN_API FPRGRoomCells
+{
+	GENERATED_BODY()
+
+	// Room size in tile count
+	UPROPERTY(EditAnywhere, Category = "Cells")
+	FIntPoint RoomSize = { 1, 1 };
+	// Room height in meters
+	UPROPERTY(EditAnywhere, Category = "Cells")
+	int RoomHeight = 1;
+	// Size of each tile in cm
+	UPROPERTY(EditAnywhere, Category = "Cells")
+	int TileSizeCM = 200;
+
+	// Palette index per tile. INDEX_NONE for empty tiles
+	UPROPERTY(EditAnywhere, Category = "Cells")
+	TArray<int32> TileMeshIds;
+	// Palette index per wall. INDEX_NONE for empty walls
+	UPROPERTY(EditAnywhere, Category = "Cells")
+	TArray<int32> WallMeshIds;
+	// Type per wall. Empty when all walls are solid, e.g. for cells stored before wall types existed
+	UPROPERTY(EditAnywhere, Category = "Cells")
+	TArray<EPRGWallType> WallTypes;
+
+	// Set room dimensions and mark all cells as empty
+	void Init(FIntPoint NewSize, int NewHeight, int NewTileSizeCM);
+	// Check if cell arrays match the room size
+	bool IsValid() const;
+	// Change room size, keeping cells inside both sizes at their grid position. Other cells are empty
+	void Resize(FIntPoint NewSize);
+	// Hash of dimensions, occupancy, meshes and wall types of all cells. Meshes are hashed by path, so the hash is stable across sessions and palette order
+	uint32 GetContentHash(const FPRGMeshPalette& Palette) const;
+
+	// Get type of the wall at index
+	EPRGWallType GetWallType(int Index) const { return WallTypes.IsValidIndex(Index) ? WallTypes[Index] : EPRGWallType::Solid; }
+	// Check if the wall at index is a door, window or opening
+	bool IsWallOpening(int Index) const { return GetWallType(Index) != EPRGWallType::Solid; }
+	// Set type of the wall at index, filling the type array on the first non-solid wall
+	void SetWallType(int Index, EPRGWallType Type);
+
+	// Number of tiles for given room size
+	static int NumTiles(FIntPoint Size) { return FPRGGridLayout(Size, 0).NumTiles(); }
+	// Number of walls for given room size. X-aligned walls first, then Y-aligned walls
+	static int NumWalls(FIntPoint Size) { return FPRGGridLayout(Size, 0).NumWalls(); }
+
+	// Calculate the local tile position based on tile index
+	static FVector GetTilePosition(FIntPoint Size, int Index, int TileSizeCM);
+	// Calculate the local wall position based on wall index
+	static FVector GetWallPosition(FIntPoint Size, int Index, int TileSizeCM);
+	// Calculate wall rotation based on wall index
+	static FRotator GetWallRotation(FIntPoint Size, int Index);
+
+	// Get index of the same tile in a room of another size. Returns INDEX_NONE if outside the new size
+	static int RemapTileIndex(FIntPoint OldSize, FIntPoint NewSize, int Index);
+	// Get index of the same wall in a room of another size. Returns INDEX_NONE if outside the new size
+	static int RemapWallIndex(FIntPoint OldSize, FIntPoint NewSize, int Index);
+
+	// Check if the wall at index lies on the outer edge of the room
+	static bool IsExteriorWall(FIntPoint Size, int Index);
+
+	// Get indices of the tiles sharing an edge with the given tile
+	static void GetTileNeighbours(FIntPoint Size, int Index, TArray<int>& OutNeighbours);
+	// Get indices of the walls sharing a corner with the given wall, in both orientations
+	static void GetWallNeighbours(FIntPoint Size, int Index, TArray<int>& OutNeighbours);
+};
@@ -0,0 +1,46 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "PRG_RoomCollisionComponent.generated.h"
+
+struct FKBoxElem;
+struct FPRGRoomCells;
+struct FPRGMeshPalette;
+class UBodySetup;
+class UStaticMesh;
+
+/**
+ * Simplified collision of a whole room in a single physics body. Runs of walls become one box per run,
+ * and rectangles of tiles one box per rectangle. Only cells whose mesh has a single box as simple collision are merged,
+ * other cells, e.g. doorways, keep the collision of their own mesh.
+ */
+UCLASS()
+class PRG_PLUGIN_API UPRG_RoomCollisionComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPRG_RoomCollisionComponent();
+
+	// Replace the collision with merged boxes for all cells, in room space. Returns number of boxes
+	int32 BuildCollision(const FPRGRoomCells& Cells, const FPRGMeshPalette& Palette);
+	// Number of boxes in the room collision
+	int32 NumBoxes() const;
+
+	// Merge runs of equal walls and rectangles of equal tiles whose mesh is a single box into boxes, in room space
+	static void MergeCellBoxes(const FPRGRoomCells& Cells, const FPRGMeshPalette& Palette, TArray<FKBoxElem>& OutBoxes);
+
+	// Get the collision box of a cell mesh. Returns false if the mesh has no simple collision made of a single unrotated box
+	static bool GetCellBox(const UStaticMesh* Mesh, FKBoxElem& OutBox);
+
+	virtual UBodySetup* GetBodySetup() override { return RoomBodySetup; }
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	// Body holding the merged boxes. Rebuilt from the cells, so not saved
+	UPROPERTY(Transient)
+	TObjectPtr<UBodySetup> RoomBodySetup;
+};
@@ -0,0 +1,84 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPRGCost, Log, All);
+
+class APRG_Room;
+enum class ERoomChange : uint8;
+
+/**
+ * Memory and render cost of one room, or of all rooms when accumulated.
+ * Meshes and materials are kept as sets, so the totals count assets shared by many rooms once.
+ */
+struct PRG_PLUGIN_API FPRGRoomCost
+{
+	// Room actor and cell actors
+	int32 Actors = 0;
+	// Components of the room and cell actors
+	int32 Components = 0;
+	// Estimated UObjects: actors, components and the body setup of the room collision
+	int32 Objects = 0;
+	// Rendered cell meshes, counting each instance of the layout components
+	int32 Instances = 0;
+	// Estimated triangles rendered at LOD0
+	int64 Triangles = 0;
+	// Physics bodies of the cells and the room collision
+	int32 CollisionBodies = 0;
+	// Memory used by the cell arrays of the room and its layout
+	int64 CellDataBytes = 0;
+	// Unique meshes used by the cells
+	TSet<FObjectKey> Meshes;
+	// Unique materials of the cell meshes, as assigned in the mesh assets
+	TSet<FObjectKey> Materials;
+
+	// Compute the cost of a room from its cell arrays and cell mesh components
+	static FPRGRoomCost Compute(APRG_Room& Room);
+	// Add the cost of another room
+	void Accumulate(const FPRGRoomCost& Other);
+};
+
+/**
+ * Reports the cost of all rooms in a world. Costs are cached per room and only computed again for rooms
+ * that changed since the last report, so repeated reports only walk the rooms, not their cells.
+ */
+class PRG_PLUGIN_API FPRGRoomCostReport
+{
+public:
+	// One line of the report
+	struct FRow
+	{
+		FString Name;
+		FPRGRoomCost Cost;
+	};
+
+	// Shared report, so the console command and the tool use the same cache
+	static FPRGRoomCostReport& Get();
+
+	FPRGRoomCostReport();
+	~FPRGRoomCostReport();
+
+	// Get the cost of a room, computing it if the room changed since it was last computed
+	const FPRGRoomCost& GetRoomCost(APRG_Room& Room);
+	// Get the cost of every room in the world, ordered by name, and their total
+	void Gather(UWorld* World, TArray<FRow>& OutRows, FPRGRoomCost& OutTotal);
+
+	// Log the cost of every room in the world and their total
+	void LogReport(UWorld* World);
+	// Write the cost of every room in the world and their total as CSV. Returns false if the file could not be written
+	bool ExportCsv(UWorld* World, const FString& Path);
+	// Get the default CSV path of a world, in the project's Saved folder
+	static FString GetDefaultCsvPath(UWorld* World);
+
+private:
+	// Drop cached costs of rooms whose cells changed or that were removed
+	void OnRoomChanged(APRG_Room* Room, ERoomChange Change);
+
+	// Cost per room, computed on first use after a change
+	TMap<TWeakObjectPtr<APRG_Room>, FPRGRoomCost> CachedCosts;
+	// Handle of the OnAnyRoomChanged binding
+	FDelegateHandle RoomChangedHandle;
+};
@@ -0,0 +1,49 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldPartition/HLOD/HLODBuilder.h"
+#include "PRG_RoomHLODBuilder.generated.h"
+
+class APRG_Room;
+
+UCLASS()
+class PRG_PLUGIN_API UPRG_RoomHLODBuilderSettings : public UHLODBuilderSettings
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	virtual uint32 GetCRC() const override;
+#endif
+
+	// Use the baked mesh of a room as its proxy when it was baked from the current cells, so the room costs a single draw
+	UPROPERTY(EditAnywhere, Category = "HLOD")
+	bool bUseBakedMeshes = true;
+};
+
+/**
+ * HLOD builder for rooms. Set it as the builder class of a Custom HLOD layer and assign that layer to rooms, their cells
+ * follow the layer of their room. Instead of merging the components of every wall and tile actor, the proxy is built from
+ * the cell data of the rooms in the HLOD cell: rooms with a current baked mesh use it as is, all other cells become one
+ * instanced component per mesh, shared by all rooms of the HLOD cell.
+ */
+UCLASS()
+class PRG_PLUGIN_API UPRG_RoomHLODBuilder : public UHLODBuilder
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	virtual TSubclassOf<UHLODBuilderSettings> GetSettingsClass() const override;
+	virtual uint32 ComputeHLODHash(const UActorComponent* InSourceComponent) const override;
+
+protected:
+	virtual TArray<UActorComponent*> Build(const FHLODBuildContext& InHLODBuildContext, const TArray<UActorComponent*>& InSourceComponents) const override;
+
+private:
+	// Get the room a source component renders cells of, either as its layout instances or as a cell actor's mesh
+	static APRG_Room* GetSourceRoom(const UActorComponent* SourceComponent);
+#endif
+};
@@ -0,0 +1,63 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "PRG_RoomCells.h"
+#include "PRG_RoomLayout.generated.h"
+
+class APRG_Room;
+class UPRG_RoomLayout;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnRoomLayoutChanged, UPRG_RoomLayout*);
+
+/**
+ * Cell grid that can be shared by any number of rooms. Rooms referencing a layout render its cells
+ * as instances from one shared set of instance transforms, instead of spawning wall and tile actors.
+ */
+UCLASS(BlueprintType)
+class PRG_PLUGIN_API UPRG_RoomLayout : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Occupancy and palette index of every tile and wall
+	UPROPERTY(EditAnywhere, Category = "Layout")
+	FPRGRoomCells Cells;
+	// Meshes used by the cells
+	UPROPERTY(EditAnywhere, Category = "Layout")
+	FPRGMeshPalette Palette;
+
+	// Broadcast when cells or palette change, so all rooms using this layout update
+	FOnRoomLayoutChanged OnLayoutChanged;
+
+	// Replace the cells of this layout with the cells of the given room and notify all users
+	void CaptureRoom(const APRG_Room& Room);
+	// Point all walls or tiles using FromMesh, or all of them when FromMesh is nullptr, to ToMesh and notify all users. Returns number of cells changed
+	int32 ReplaceCellMeshes(bool bWalls, const UStaticMesh* FromMesh, UStaticMesh* ToMesh);
+	// Get room space transforms of all cells using the given palette index. Shared by all rooms using this layout
+	const TArray<FTransform>& GetInstanceTransforms(int32 PaletteIndex) const;
+	// Invalidate cached instances and notify all rooms using this layout
+	void NotifyLayoutChanged();
+
+#if WITH_EDITOR
+	virtual void PreEditChange(FProperty* PropertyAboutToChange) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+#if WITH_EDITOR
+	// Room size before a property edit, so the cells can be moved to a new size. Unset for undo, which restores the cells as well
+	TOptional<FIntPoint> PreEditRoomSize;
+	// Content hash before the last edit, so only edits that change the cells or palette notify the rooms
+	uint32 PreEditContentHash = 0;
+#endif
+
+	// Build instance transforms of all palette entries
+	void BuildInstanceTransforms() const;
+
+	// Room space instance transforms per palette index. Built on first use after a change
+	mutable TArray<TArray<FTransform>> InstanceTransforms;
+	mutable bool bInstanceTransformsValid = false;
+};
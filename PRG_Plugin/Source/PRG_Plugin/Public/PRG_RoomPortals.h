@@ -0,0 +1,104 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PRG_GridLayout.h"
+#include "PRG_RoomPortals.generated.h"
+
+class APRG_Room;
+enum class ERoomChange : uint8;
+
+/**
+ * Portal culling of rooms. Rooms are the cells of a graph whose portals are the openings in their outer walls:
+ * empty wall slots, door, window and open wall types and walls using a door or window mesh, where the room on the other
+ * side is open there as well.
+ * Every frame the rooms are walked from the room containing the camera, narrowing the visible screen rectangle at
+ * each portal, and all rooms not reached are hidden. Openings to the outside show the rooms seen through them
+ * without walking on. Rooms whose floor or ceiling touches a visible room, e.g. the building levels above and below it,
+ * stay visible, as portals only connect rooms side by side. Nothing is culled while the camera is outside all rooms.
+ *
+ * Set PRG.PortalCulling to 0 to turn it off, 1 for game worlds and 2 to also cull in the editor viewport.
+ */
+UCLASS()
+class PRG_PLUGIN_API UPRG_RoomPortalSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickableInEditor() const override { return true; }
+	virtual TStatId GetStatId() const override;
+
+	// Number of rooms in the portal graph
+	int32 NumRooms() const { return Nodes.Num(); }
+	// Number of rooms the last visibility pass left visible
+	int32 NumVisibleRooms() const { return NumVisible; }
+
+private:
+	// Opening in an outer wall of a room
+	struct FPortal
+	{
+		// Corners of the opening in world space, covering the whole wall cell
+		FVector Corners[4];
+		// Node on the other side, or INDEX_NONE for the outside
+		int32 ToNode = INDEX_NONE;
+	};
+
+	// Room with its grid volume and portals
+	struct FRoomNode
+	{
+		TWeakObjectPtr<APRG_Room> Room;
+		FTransform Transform;
+		FPRGGridLayout Grid;
+		// Wall slots that can be seen through, per wall index
+		TBitArray<> OpenWalls;
+		// Size of the grid volume in room space, in cm
+		FVector Extent = FVector::ZeroVector;
+		FBox Bounds = FBox(ForceInit);
+		TArray<FPortal> Portals;
+		// Nodes whose floor touches the ceiling of this node or whose ceiling touches its floor, with overlapping footprints
+		TArray<int32> StackedNodes;
+	};
+
+	// Camera of the culled view
+	struct FCullView
+	{
+		FVector Location = FVector::ZeroVector;
+		FMatrix ViewProjection = FMatrix::Identity;
+	};
+
+	// Mark the graph for a rebuild when a room moved, changed its cells or was removed
+	void OnRoomChanged(APRG_Room* Room, ERoomChange Change);
+	// Gather all rooms of the world and connect them through their openings
+	void RebuildGraph();
+	// Add the portals of a node, connecting them to the nodes on the other side
+	void AddPortals(int32 NodeIndex);
+	// Find the nodes stacked directly above and below a node
+	void AddStackedNodes(int32 NodeIndex);
+	// Get the node whose grid volume contains a world location, other than Exclude. Returns INDEX_NONE if none does
+	int32 FindNodeAt(const FVector& Location, int32 Exclude = INDEX_NONE) const;
+	// Check if a node is open at a world wall position. Rooms whose grid has no wall slot there count as open
+	static bool IsOpenAt(const FRoomNode& Node, const FVector& WallLocation);
+
+	// Get the camera to cull for. Returns false if there is none, or it cannot be culled for, e.g. an orthographic viewport
+	bool GetView(FCullView& OutView) const;
+	// Walk the graph from the camera room and mark reached nodes visible
+	void ComputeVisibility(const FCullView& View, TBitArray<>& OutVisible) const;
+	// Hide rooms that are not visible and show all others
+	void ApplyVisibility(const TBitArray<>& Visible);
+	// Show all rooms hidden by portal culling
+	void ShowAllRooms();
+
+	TArray<FRoomNode> Nodes;
+	// Spatial hash of node bounds, used to find the room on the other side of a portal
+	TMultiMap<FIntPoint, int32> Buckets;
+	bool bGraphDirty = true;
+	TSet<TWeakObjectPtr<APRG_Room>> HiddenRooms;
+	int32 NumVisible = 0;
+	FDelegateHandle RoomChangedHandle;
+};
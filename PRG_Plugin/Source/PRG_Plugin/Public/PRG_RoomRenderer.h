@@ -0,0 +1,114 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PRG_RoomRenderer.generated.h"
+
+class APRG_Room;
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMesh;
+enum class ERoomChange : uint8;
+
+// A batch holds all instances of one mesh within one partition and building level
+USTRUCT()
+struct FPRGRoomBatchKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> Mesh = nullptr;
+	UPROPERTY()
+	FIntPoint Partition = FIntPoint::ZeroValue;
+	// Building level, or INDEX_NONE for rooms outside a building
+	UPROPERTY()
+	int32 Level = INDEX_NONE;
+
+	bool operator==(const FPRGRoomBatchKey& Other) const { return Mesh == Other.Mesh && Partition == Other.Partition && Level == Other.Level; }
+	friend uint32 GetTypeHash(const FPRGRoomBatchKey& Key) { return HashCombine(HashCombine(GetTypeHash(Key.Mesh), GetTypeHash(Key.Partition)), GetTypeHash(Key.Level)); }
+};
+
+USTRUCT()
+struct FPRGRoomBatch
+{
+	GENERATED_BODY()
+
+	// Created by the renderer, so not saved
+	UPROPERTY(Transient)
+	TObjectPtr<UHierarchicalInstancedStaticMeshComponent> Component = nullptr;
+	// Rooms contributing instances to this batch
+	TSet<TWeakObjectPtr<APRG_Room>> Rooms;
+	// Set when rooms were added or removed, so the batch is refilled
+	bool bDirty = false;
+};
+
+/**
+ * Optional level actor that renders the walls and tiles of all rooms in its world. Cells sharing a mesh are
+ * batched into one hierarchical instanced component per spatial partition, instead of one draw per cell actor.
+ * Rooms hide their own cell components while batched, and render them again while edited cell by cell.
+ * Levels of a building get batches of their own, so each level is culled and hidden on its own.
+ * Moved rooms, and rooms whose meshes keep their instance count, update their own range of instances in place.
+ */
+UCLASS(hidecategories = (Input, Collision, Replication, HLOD, Physics, Networking, Actor, Cooking))
+class PRG_PLUGIN_API APRG_RoomRenderer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	APRG_RoomRenderer();
+
+	// Edge length of the square partitions rooms are grouped in, in cm. Rooms belong to the partition containing their origin
+	UPROPERTY(EditAnywhere, Category = "Renderer", meta = (ClampMin = "500"))
+	float PartitionSize = 5000.0f;
+
+	// Discard all batches and gather every room again
+	UFUNCTION(CallInEditor, Category = "Renderer")
+	void RebuildAll();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool ShouldTickIfViewportsOnly() const override { return true; }
+
+protected:
+	// Bind to room changes and batch all rooms of the world
+	virtual void PostRegisterAllComponents() override;
+	// Unbind from room changes and hand cell rendering back to the rooms
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	// World transforms of the cells of one room, grouped by mesh, and the first index of its instances in each batch
+	struct FRoomEntry
+	{
+		TMap<UStaticMesh*, TArray<FTransform>> Instances;
+		// INDEX_NONE until the batch was refilled
+		TMap<FPRGRoomBatchKey, int32> BatchStarts;
+	};
+
+	// Handle change of any room. Changes are collected and applied once per tick
+	void OnRoomChanged(APRG_Room* Room, ERoomChange Change);
+	// Gather changed rooms and rebuild the batches they touch
+	void FlushDirtyRooms();
+	// Gather instances of a room again, and either update them in place or move the room to the batches of its meshes
+	void UpdateRoom(const TWeakObjectPtr<APRG_Room>& RoomPtr);
+	// Overwrite the instance ranges of a room, if it still uses the same batches with the same instance counts
+	bool UpdateInstancesInPlace(FRoomEntry& Entry, FRoomEntry& NewEntry);
+	// Remove room from all its batches
+	void RemoveRoom(const TWeakObjectPtr<APRG_Room>& RoomPtr);
+	// Refill component of a batch from the cached instances of its rooms
+	void RebuildBatch(const FPRGRoomBatchKey& Key, FPRGRoomBatch& Batch);
+	// Remove all batches and show cells of all batched rooms again
+	void ReleaseAll();
+
+	// Partition containing a world location
+	FIntPoint GetPartition(const FVector& Location) const;
+
+	UPROPERTY(Transient)
+	TMap<FPRGRoomBatchKey, FPRGRoomBatch> Batches;
+	TMap<TWeakObjectPtr<APRG_Room>, FRoomEntry> RoomEntries;
+	TSet<TWeakObjectPtr<APRG_Room>> DirtyRooms;
+	FDelegateHandle RoomChangedHandle;
+};
@@ -0,0 +1,74 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPRGValidator, Log, All);
+
+class APRG_Room;
+
+/**
+ * Checks rooms for broken cell data and repairs what it can, in one pass over the attached actors and cell arrays:
+ *  - Cell arrays must match the room size. Repaired by rebuilding them from the attached cells
+ *  - Attached walls and tiles must be on the room grid and stored at the index of their position. Misplaced entries are repaired
+ *  - No two attached cells may share an index. Duplicates are reported, not destroyed
+ *  - Cell arrays may not reference cells that are not attached to the room. Repaired by clearing the entry
+ *  - Wall types must be absent or match the wall count. Repaired by resizing them, new walls being solid
+ *  - Optionally, the room must have a gizmo and transform proxy. Repaired by the tool through SetGizmoRepair
+ * Rooms using a shared layout and partially loaded rooms have no cell actors to check, so only their gizmo is checked.
+ */
+class PRG_PLUGIN_API FPRGRoomValidator
+{
+public:
+	explicit FPRGRoomValidator(bool bInRepair);
+
+	// Also check gizmo bindings, repairing them with the given function. Only rooms managed by the tool have a gizmo
+	void SetGizmoRepair(TFunction<void(APRG_Room&)> InRepairGizmo);
+
+	// Validate a single room. Returns number of problems found, including repaired ones
+	int32 ValidateRoom(APRG_Room& Room);
+	// Log number of rooms, problems and time spent over all validated rooms
+	void LogSummary() const;
+
+	// Number of rooms validated
+	int32 GetNumRooms() const { return NumRooms; }
+	// Number of problems found over all rooms
+	int32 GetNumProblems() const { return NumProblems; }
+	// Number of problems left after repairing
+	int32 GetNumUnrepaired() const { return NumProblems - NumRepaired; }
+	// Number of rooms whose saved data was repaired, so they need to be saved again
+	int32 GetNumModifiedRooms() const { return NumModifiedRooms; }
+	// Time spent validating, in seconds
+	double GetSeconds() const { return Seconds; }
+
+private:
+	// Check cell arrays against the room size and attached actors
+	void ValidateCells(APRG_Room& Room);
+	// Check a single attached wall or tile, storing it at its index when repairing
+	template <class T>
+	void ValidateCell(APRG_Room& Room, T* Cell, int Index, const FVector& IndexPosition, TArray<TObjectPtr<T>>& Cells, TBitArray<>& Seen, bool bRebuild);
+	// Clear array entries not claimed by any attached cell
+	template <class T>
+	void ValidateUnclaimed(APRG_Room& Room, TArray<TObjectPtr<T>>& Cells, const TBitArray<>& Seen);
+	// Check gizmo and transform proxy of the room
+	void ValidateGizmo(APRG_Room& Room);
+
+	// Log and count a problem
+	void Report(const APRG_Room& Room, const FString& Problem, bool bRepaired);
+	// Call Modify on the room before its first repair of saved data, so the repair can be undone and the room is saved
+	void BeginRepair(APRG_Room& Room);
+
+	// Repair problems where possible
+	bool bRepair = false;
+	// Recreates the gizmo of a room. Gizmos are not checked when unset
+	TFunction<void(APRG_Room&)> RepairGizmo;
+
+	int32 NumRooms = 0;
+	int32 NumProblems = 0;
+	int32 NumRepaired = 0;
+	int32 NumModifiedRooms = 0;
+	double Seconds = 0.0;
+	// Set once the current room was modified
+	bool bRoomModified = false;
+};
@@ -4,11 +4,33 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
-
-#include <Tools/PRG_PluginRoomTool.h>
+#include "GameFramework/Actor.h"
 
 #include "PRG_Settings.generated.h"
 
+class UStaticMesh;
+
+// Position snapping of rooms in the tool
+UENUM()
+enum class EPosSnap
+{
+	NoSnapping = 0,
+	SnapX10 = 10,
+	SnapX100 = 100,
+	SnapX1000 = 1000
+};
+
+// Rotation snapping of rooms in the tool, in degrees
+UENUM()
+enum class ERotSnap
+{
+	NoSnapping = 0,
+	SnapZ5 = 5,
+	SnapZ15 = 15,
+	SnapZ45 = 45
+};
+
+
 /**
  * PRG settings to be saved in the scene
  */
@@ -18,6 +40,14 @@ class PRG_PLUGIN_API APRG_Settings : public AActor
 	GENERATED_BODY()
 
 public:
+	APRG_Settings()
+	{
+#if WITH_EDITORONLY_DATA
+		// Tool settings apply to the whole map, so keep them loaded in World Partition
+		bIsSpatiallyLoaded = false;
+#endif
+	}
+
 	UPROPERTY()
 	EPosSnap PositionSnap;
 	UPROPERTY()
@@ -0,0 +1,355 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomCommandlet.h"
+
+#include "PRG_Room.h"
+#include "PRG_LayoutFile.h"
+#include "PRG_RoomValidator.h"
+#include "PRG_Settings.h"
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/MeshMerging.h"
+#include "IMeshMergeUtilities.h"
+#include "MeshMergeModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/SavePackage.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionHelpers.h"
+
+DEFINE_LOG_CATEGORY(LogPRGCommandlet);
+
+UPRG_RoomCommandlet::UPRG_RoomCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UPRG_RoomCommandlet::Main(const FString& Params)
+{
+	FString MapPath;
+	if (!FParse::Value(*Params, TEXT("Map="), MapPath))
+	{
+		UE_LOG(LogPRGCommandlet, Error, TEXT("Missing map. Usage: -run=PRG_Room -Map=/Game/Maps/MyMap [-Layout=<File>] [-Regenerate] [-Repair] [-Bake] [-BakePath=<Path>] [-Force] [-NoSave]"));
+		return 1;
+	}
+
+	FString LayoutFile;
+	const bool bImportLayout = FParse::Value(*Params, TEXT("Layout="), LayoutFile);
+	const bool bRegenerate = FParse::Param(*Params, TEXT("Regenerate"));
+	const bool bRepair = FParse::Param(*Params, TEXT("Repair"));
+	const bool bBake = FParse::Param(*Params, TEXT("Bake"));
+	const bool bForce = FParse::Param(*Params, TEXT("Force"));
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+	FString BakePath = TEXT("/Game/PRG_Baked");
+	FParse::Value(*Params, TEXT("BakePath="), BakePath);
+
+	StageTimings.Reset();
+	double StageStart = FPlatformTime::Seconds();
+
+	// Lambda - Store time spent since the end of the previous stage
+	auto EndStage = [&](const TCHAR* StageName)
+	{
+		const double Now = FPlatformTime::Seconds();
+		StageTimings.Emplace(StageName, Now - StageStart);
+		StageStart = Now;
+	};
+
+	// 1. Load map
+	UWorld* World = LoadWorld(MapPath);
+	if (!World)
+	{
+		UE_LOG(LogPRGCommandlet, Error, TEXT("Unable to load map '%s'."), *MapPath);
+		return 1;
+	}
+	EndStage(TEXT("Load"));
+
+	if (World->IsPartitionedWorld() && (bImportLayout || bRegenerate))
+	{
+		UE_LOG(LogPRGCommandlet, Error, TEXT("-Layout and -Regenerate are not supported for World Partition map '%s'."), *MapPath);
+		UnloadWorld(World);
+		return 1;
+	}
+
+	// 2. Discover rooms and restore their cell arrays from the attached actors
+	TArray<APRG_Room*> Rooms;
+	for (TActorIterator<APRG_Room> It(World); It; ++It)
+	{
+		APRG_Room* Room = *It;
+		Room->InitRoom();
+		Room->GatherAttachedCells();
+		Rooms.Add(Room);
+	}
+	UE_LOG(LogPRGCommandlet, Display, TEXT("Found %d rooms in '%s'."), Rooms.Num(), *MapPath);
+	EndStage(TEXT("Discover"));
+
+	// 3. Regenerate
+	if (bImportLayout)
+	{
+		if (!ImportLayout(World, Rooms, LayoutFile))
+		{
+			UnloadWorld(World);
+			return 1;
+		}
+		EndStage(TEXT("Import"));
+	}
+	else if (bRegenerate)
+	{
+		// Defaults of the map settings, or the plugin meshes when the map has none
+		UStaticMesh* DefaultFloorMesh = nullptr;
+		UStaticMesh* DefaultWallMesh = nullptr;
+		if (TActorIterator<APRG_Settings> It(World); It)
+		{
+			DefaultFloorMesh = It->FloorMesh;
+			DefaultWallMesh = It->WallMesh;
+		}
+		if (!DefaultFloorMesh)
+			DefaultFloorMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/PRG_Plugin/Meshes/SM_PRG_Floor.SM_PRG_Floor"));
+		if (!DefaultWallMesh)
+			DefaultWallMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/PRG_Plugin/Meshes/SM_PRG_Wall.SM_PRG_Wall"));
+
+		int NumRegenerated = 0;
+		for (APRG_Room* Room : Rooms)
+		{
+			if (Room->RegenerateCells(DefaultFloorMesh, DefaultWallMesh, bForce))
+			{
+				Room->MarkPackageDirty();
+				NumRegenerated++;
+			}
+		}
+		UE_LOG(LogPRGCommandlet, Display, TEXT("Regenerated %d rooms, %d unchanged."), NumRegenerated, Rooms.Num() - NumRegenerated);
+		EndStage(TEXT("Regenerate"));
+	}
+
+	// 4. Validate
+	FPRGRoomValidator Validator(bRepair);
+	for (APRG_Room* Room : Rooms)
+	{
+		const int32 ModifiedBefore = Validator.GetNumModifiedRooms();
+		if (Validator.ValidateRoom(*Room) > 0 && Validator.GetNumModifiedRooms() > ModifiedBefore)
+			Room->MarkPackageDirty();
+	}
+	Validator.LogSummary();
+	const int Problems = Validator.GetNumUnrepaired();
+	EndStage(TEXT("Validate"));
+
+	// 5. Bake
+	TArray<UPackage*> BakedPackages;
+	if (bBake)
+	{
+		int NumUnchanged = 0;
+		for (APRG_Room* Room : Rooms)
+		{
+			// Merging is the most expensive stage, so rooms baked from the same cells keep their mesh
+			if (!bForce && Room->IsBakedMeshCurrent(Room->GetContentHash()))
+			{
+				NumUnchanged++;
+				continue;
+			}
+
+			if (UPackage* BakedPackage = BakeRoom(World, *Room, BakePath))
+				BakedPackages.Add(BakedPackage);
+		}
+		UE_LOG(LogPRGCommandlet, Display, TEXT("Baked %d rooms, %d unchanged."), BakedPackages.Num(), NumUnchanged);
+		EndStage(TEXT("Bake"));
+	}
+
+	// 6. Save
+	bool bSaveFailed = false;
+	if (bSave)
+	{
+		for (UPackage* BakedPackage : BakedPackages)
+			bSaveFailed |= !SavePackage(BakedPackage, BakedPackage->FindAssetInPackage(), FPackageName::GetAssetPackageExtension());
+
+		bSaveFailed |= !SavePackage(World->GetOutermost(), World, FPackageName::GetMapPackageExtension());
+		if (World->IsPartitionedWorld())
+			bSaveFailed |= !SaveRoomActorPackages(Rooms);
+		EndStage(TEXT("Save"));
+	}
+
+	UnloadWorld(World);
+
+	// Report
+	double TotalSeconds = 0.0;
+	UE_LOG(LogPRGCommandlet, Display, TEXT("Processed %d rooms, %d problems left, %d meshes baked."), Rooms.Num(), Problems, BakedPackages.Num());
+	for (const TPair<FString, double>& Stage : StageTimings)
+	{
+		UE_LOG(LogPRGCommandlet, Display, TEXT("  %-12s %10.2f ms"), *Stage.Key, Stage.Value * 1000.0);
+		TotalSeconds += Stage.Value;
+	}
+	UE_LOG(LogPRGCommandlet, Display, TEXT("  %-12s %10.2f ms"), TEXT("Total"), TotalSeconds * 1000.0);
+
+	return (Problems > 0 || bSaveFailed) ? 1 : 0;
+}
+
+UWorld* UPRG_RoomCommandlet::LoadWorld(const FString& MapPath)
+{
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPath, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World)
+		return nullptr;
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+
+	// Only initialize what is needed to spawn and merge actors, so no rendering resources are required
+	if (!World->bIsWorldInitialized)
+	{
+		UWorld::InitializationValues InitValues;
+		InitValues.RequiresHitProxies(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false);
+		World->InitWorld(InitValues);
+	}
+	World->UpdateWorldComponents(true, false);
+
+	GEditor->GetEditorWorldContext().SetCurrentWorld(World);
+	GWorld = World;
+
+	// Rooms reference their cells, so pinning a room loads its whole actor cluster
+	if (UWorldPartition* WorldPartition = World->GetWorldPartition())
+	{
+		FWorldPartitionHelpers::ForEachActorDesc<APRG_Room>(WorldPartition, [this, WorldPartition](const FWorldPartitionActorDesc* ActorDesc)
+		{
+			LoadedRoomRefs.Emplace(WorldPartition, ActorDesc->GetGuid());
+			return true;
+		});
+	}
+
+	return World;
+}
+
+void UPRG_RoomCommandlet::UnloadWorld(UWorld* World)
+{
+	LoadedRoomRefs.Empty();
+
+	GEditor->GetEditorWorldContext().SetCurrentWorld(nullptr);
+	GWorld = nullptr;
+
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+}
+
+bool UPRG_RoomCommandlet::ImportLayout(UWorld* World, TArray<APRG_Room*>& Rooms, const FString& LayoutFile)
+{
+	FPRGLayoutReader Reader;
+	if (!Reader.Open(LayoutFile))
+		return false;
+
+	// Replace existing rooms. Destroying a room also destroys its cells
+	for (APRG_Room* Room : Rooms)
+		World->DestroyActor(Room);
+	Rooms.Reset();
+
+	UStaticMesh* FallbackFloorMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/PRG_Plugin/Meshes/SM_PRG_Floor.SM_PRG_Floor"));
+	UStaticMesh* FallbackWallMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/PRG_Plugin/Meshes/SM_PRG_Wall.SM_PRG_Wall"));
+
+	TArray<FPRGRoomRecord> Records;
+	while (Reader.ReadRecords(64, Records))
+	{
+		for (const FPRGRoomRecord& Record : Records)
+		{
+			if (APRG_Room* NewRoom = Reader.SpawnRoom(World, Record, FallbackFloorMesh, FallbackWallMesh))
+				Rooms.Add(NewRoom);
+		}
+	}
+
+	UE_LOG(LogPRGCommandlet, Display, TEXT("Imported %d of %d rooms from '%s'."), Rooms.Num(), Reader.GetRoomCount(), *LayoutFile);
+	return Rooms.Num() == Reader.GetRoomCount();
+}
+
+UPackage* UPRG_RoomCommandlet::BakeRoom(UWorld* World, APRG_Room& Room, const FString& BakePath)
+{
+	TArray<UPrimitiveComponent*> Components;
+	for (AWall* Wall : Room.GetWalls())
+	{
+		if (Wall && Wall->GetStaticMeshComponent())
+			Components.Add(Wall->GetStaticMeshComponent());
+	}
+	for (ATile* Tile : Room.GetTiles())
+	{
+		if (Tile && Tile->GetStaticMeshComponent())
+			Components.Add(Tile->GetStaticMeshComponent());
+	}
+
+	if (Components.Num() == 0)
+		return nullptr;
+
+	// Bake in room space so the merged mesh stays valid when the room is moved
+	const FTransform RoomTransform = Room.GetActorTransform();
+	Room.SetActorTransform(FTransform::Identity);
+
+	FMeshMergingSettings MergeSettings;
+	MergeSettings.bPivotPointAtZero = true;
+	MergeSettings.bMergePhysicsData = true;
+
+	TArray<UObject*> CreatedAssets;
+	FVector MergedLocation;
+	const FString PackageName = BakePath / FString::Printf(TEXT("SM_%s_%s"), *World->GetName(), *Room.GetName());
+	const IMeshMergeUtilities& MergeUtilities = FModuleManager::Get().LoadModuleChecked<IMeshMergeModule>("MeshMergeUtilities").GetUtilities();
+	MergeUtilities.MergeComponentsToStaticMesh(Components, World, MergeSettings, nullptr, nullptr, PackageName, CreatedAssets, MergedLocation, TNumericLimits<float>::Max(), true);
+
+	Room.SetActorTransform(RoomTransform);
+
+	for (UObject* Asset : CreatedAssets)
+	{
+		if (UStaticMesh* MergedMesh = Cast<UStaticMesh>(Asset))
+		{
+			Room.SetBakedMesh(MergedMesh, Room.GetContentHash());
+			Room.MarkPackageDirty();
+			return MergedMesh->GetOutermost();
+		}
+	}
+
+	UE_LOG(LogPRGCommandlet, Warning, TEXT("%s: Merging %d cells did not produce a mesh."), *Room.GetName(), Components.Num());
+	return nullptr;
+}
+
+bool UPRG_RoomCommandlet::SavePackage(UPackage* Package, UObject* Asset, const FString& Extension)
+{
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Standalone;
+	SaveArgs.SaveFlags = SAVE_NoError;
+
+	if (!UPackage::SavePackage(Package, Asset, *Filename, SaveArgs))
+	{
+		UE_LOG(LogPRGCommandlet, Error, TEXT("Failed to save '%s'."), *Filename);
+		return false;
+	}
+	return true;
+}
+
+bool UPRG_RoomCommandlet::SaveRoomActorPackages(const TArray<APRG_Room*>& Rooms)
+{
+	TArray<UPackage*> ActorPackages;
+
+	// Lambda - Collect external package of an actor if it was modified
+	auto AddPackage = [&ActorPackages](const AActor* Actor)
+	{
+		UPackage* Package = Actor ? Actor->GetExternalPackage() : nullptr;
+		if (Package && Package->IsDirty())
+			ActorPackages.AddUnique(Package);
+	};
+
+	for (APRG_Room* Room : Rooms)
+	{
+		AddPackage(Room);
+		for (AWall* Wall : Room->GetWalls())
+			AddPackage(Wall);
+		for (ATile* Tile : Room->GetTiles())
+			AddPackage(Tile);
+	}
+
+	bool bSuccess = true;
+	for (UPackage* Package : ActorPackages)
+		bSuccess &= SavePackage(Package, Package->FindAssetInPackage(), FPackageName::GetAssetPackageExtension());
+	return bSuccess;
+}
@@ -0,0 +1,62 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WorldPartition/WorldPartitionHandle.h"
+
+#include "PRG_RoomCommandlet.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPRGCommandlet, Log, All);
+
+class APRG_Room;
+
+/**
+ * Headless batch processing of rooms in a map, for use on build machines. Runs with -nullrhi.
+ *
+ * Usage: UnrealEditor-Cmd <Project> -run=PRG_Room -Map=/Game/Maps/MyMap [options]
+ *   -Layout=<File>    Replace all rooms in the map with the rooms stored in a layout file
+ *   -Regenerate       Respawn the walls and tiles of every room whose cells changed since they were last spawned
+ *   -Repair           Repair broken cell arrays found by validation, see FPRGRoomValidator
+ *   -Bake             Merge the cells of every room whose cells changed since its last bake into a single static mesh
+ *   -BakePath=<Path>  Content path for baked meshes. Defaults to /Game/PRG_Baked
+ *   -Force            Regenerate and bake all rooms, also rooms whose content hash did not change
+ *   -NoSave           Do not save the map or baked meshes
+ *
+ * World Partition maps load all rooms together with their cells. Rooms are saved to their external actor packages.
+ * Layout import and regeneration replace cell actors and are not supported for World Partition maps.
+ *
+ * Returns non-zero when the map could not be loaded or saved, or when validation found broken rooms that were not repaired.
+ */
+UCLASS()
+class UPRG_RoomCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPRG_RoomCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	// Load map package and initialize its world for editing
+	UWorld* LoadWorld(const FString& MapPath);
+	// Release world loaded by LoadWorld
+	void UnloadWorld(UWorld* World);
+
+	// Replace all rooms with the rooms in the layout file
+	bool ImportLayout(UWorld* World, TArray<APRG_Room*>& Rooms, const FString& LayoutFile);
+	// Merge all cells of a room into one static mesh asset. Returns the package of the new mesh
+	UPackage* BakeRoom(UWorld* World, APRG_Room& Room, const FString& BakePath);
+
+	// Save package to disk
+	bool SavePackage(UPackage* Package, UObject* Asset, const FString& Extension);
+	// Save dirty external actor packages of rooms and their cells. Returns false if any save failed
+	bool SaveRoomActorPackages(const TArray<APRG_Room*>& Rooms);
+
+	// Time spent in each stage, in order of execution
+	TArray<TPair<FString, double>> StageTimings;
+	// Keeps the rooms of a World Partition map loaded while processing
+	TArray<FWorldPartitionReference> LoadedRoomRefs;
+};
@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PRG_PluginEditorModule.h"
+#include "PRG_PluginEditorModeCommands.h"
+
+#define LOCTEXT_NAMESPACE "PRG_PluginEditorModule"
+
+void FPRG_PluginEditorModule::StartupModule()
+{
+	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	FPRG_PluginEditorModeCommands::Register();
+}
+
+void FPRG_PluginEditorModule::ShutdownModule()
+{
+	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
+	// we call this function before unloading the module.
+
+	FPRG_PluginEditorModeCommands::Unregister();
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FPRG_PluginEditorModule, PRG_PluginEditor)
\ No newline at end of file
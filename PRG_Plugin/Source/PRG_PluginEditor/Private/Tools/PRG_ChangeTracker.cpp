@@ -0,0 +1,50 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_ChangeTracker.h"
+
+void FPRGChangeTracker::BeginInteraction()
+{
+	InteractionDepth++;
+}
+
+void FPRGChangeTracker::EndInteraction()
+{
+	if (InteractionDepth > 0)
+		InteractionDepth--;
+
+	if (InteractionDepth == 0)
+		Flush();
+}
+
+void FPRGChangeTracker::EndAllInteractions()
+{
+	InteractionDepth = 0;
+	Flush();
+}
+
+void FPRGChangeTracker::MarkDirty(UObject* Object)
+{
+	if (Object)
+		DirtyObjects.Add(Object);
+}
+
+void FPRGChangeTracker::Flush()
+{
+	if (DirtyObjects.Num() == 0)
+		return;
+
+	// Objects sharing a package, e.g. rooms in a level without external actors, dirty it only once
+	TSet<UPackage*> DirtyPackages;
+	for (const TWeakObjectPtr<UObject>& DirtyObject : DirtyObjects)
+	{
+		if (!DirtyObject.IsValid())
+			continue;
+
+		bool bAlreadyDirtied = false;
+		DirtyPackages.Add(DirtyObject->GetPackage(), &bAlreadyDirtied);
+		if (!bAlreadyDirtied)
+			DirtyObject->MarkPackageDirty();
+	}
+
+	DirtyObjects.Reset();
+}
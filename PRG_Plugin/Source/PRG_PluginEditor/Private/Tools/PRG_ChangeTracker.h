@@ -0,0 +1,37 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Collects objects changed during an interaction, such as a gizmo drag or a series of property edits, and marks
+ * their packages dirty once when the interaction ends. Every MarkPackageDirty call notifies listeners like
+ * source control, even for packages that are already dirty, so doing this per drag frame is costly.
+ */
+class FPRGChangeTracker
+{
+public:
+	// Start an interaction. Interactions can be nested, changes are flushed when the outermost one ends
+	void BeginInteraction();
+	// End an interaction, flushing the recorded changes if no interaction is left
+	void EndInteraction();
+	// End all interactions, e.g. when the tool shuts down mid-drag, and flush the recorded changes
+	void EndAllInteractions();
+
+	// Record an object whose package must be marked dirty
+	void MarkDirty(UObject* Object);
+	// Mark the package of each recorded object dirty once
+	void Flush();
+
+	// Check if an interaction is in progress
+	bool IsInInteraction() const { return InteractionDepth > 0; }
+	// Check if any change is waiting to be flushed
+	bool HasPendingChanges() const { return DirtyObjects.Num() > 0; }
+
+private:
+	// Objects changed since the last flush
+	TSet<TWeakObjectPtr<UObject>> DirtyObjects;
+	// Number of interactions in progress
+	int32 InteractionDepth = 0;
+};
@@ -0,0 +1,2425 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_PluginRoomTool.h"
+#include <PRG_Settings.h>
+#include "InteractiveToolManager.h"
+#include "ToolBuilderUtil.h"
+#include "CollisionQueryParams.h"
+#include "Engine/World.h"
+#include "BaseGizmos/TransformGizmoUtil.h"
+#include "BaseBehaviors/MouseHoverBehavior.h"
+#include "SceneManagement.h"
+#include "Editor.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Materials/Material.h"
+#include "Subsystems/EditorActorSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/ScopedSlowTask.h"
+#include "PRG_LayoutFile.h"
+#include "PRG_GridLayout.h"
+#include "PRG_Building.h"
+#include "PRG_RoomLayout.h"
+#include "PRG_RoomValidator.h"
+#include "PRG_RoomCost.h"
+#include "AssetToolsModule.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+
+// localization namespace
+#define LOCTEXT_NAMESPACE "UPRG_PluginRoomTool"
+
+DEFINE_LOG_CATEGORY(LogPRGTool);
+
+namespace
+{
+	// Get a loaded material, or the engine default material as placeholder while it is still loading
+	UMaterial* GetLoadedMaterial(const TSoftObjectPtr<UMaterial>& Material)
+	{
+		UMaterial* LoadedMaterial = Material.Get();
+		return LoadedMaterial ? LoadedMaterial : UMaterial::GetDefaultMaterial(MD_Surface);
+	}
+
+	// Get persistent or temporary actor at index, and whether it is persistent
+	template <class T>
+	TObjectPtr<AStaticMeshActor> FindEditCell(const TArray<TObjectPtr<T>>& TempArray, const TArray<TObjectPtr<T>>& PersistArray, int Index, bool& bOutPersistent)
+	{
+		bOutPersistent = PersistArray.IsValidIndex(Index) && PersistArray[Index];
+		if (bOutPersistent)
+			return PersistArray[Index];
+
+		return TempArray.IsValidIndex(Index) ? TempArray[Index].Get() : nullptr;
+	}
+
+	// Move cell at index between temporary and persistent arrays
+	template <class T>
+	void ToggleEditCell(TArray<TObjectPtr<T>>& TempArray, TArray<TObjectPtr<T>>& PersistArray, int Index)
+	{
+		if (!TempArray.IsValidIndex(Index) || !PersistArray.IsValidIndex(Index))
+			return;
+
+		Swap(TempArray[Index], PersistArray[Index]);
+		APRG_Room::SetTemporaryCell(TempArray[Index], true);
+		APRG_Room::SetTemporaryCell(PersistArray[Index], false);
+	}
+
+	// Get room of a traced wall or tile, or the room itself when its room collision was traced
+	APRG_Room* GetTracedRoom(const FHitResult& TraceResult)
+	{
+		AActor* HitActor = TraceResult.GetActor();
+		if (APRG_Room* Room = Cast<APRG_Room>(HitActor))
+			return Room;
+
+		return HitActor ? Cast<APRG_Room>(HitActor->GetAttachParentActor()) : nullptr;
+	}
+}
+
+ARoomBounds::ARoomBounds()
+{
+	CubeMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Cube.Cube")));
+	CubeMaterial = TSoftObjectPtr<UMaterial>(FSoftObjectPath(TEXT("/PRG_Plugin/Materials/Mat_RoomBounds.Mat_RoomBounds")));
+}
+
+/*
+ * ToolBuilder implementation
+ */
+
+UInteractiveTool* UPRG_PluginRoomToolBuilder::BuildTool(const FToolBuilderState& SceneState) const
+{
+	UPRG_PluginRoomTool* NewTool = NewObject<UPRG_PluginRoomTool>(SceneState.ToolManager);
+	NewTool->SetWorld(SceneState.World);
+	return NewTool;
+}
+
+const FToolTargetTypeRequirements& UPRG_PluginRoomToolBuilder::GetTargetRequirements() const
+{
+	static FToolTargetTypeRequirements TypeRequirements({});
+	return TypeRequirements;
+}
+
+/*
+ * ToolProperties implementation
+ */
+
+UPRG_PluginRoomToolProperties::UPRG_PluginRoomToolProperties()
+{
+	EditMode = EEditMode::CreateRooms;
+	PositionSnap = EPosSnap::SnapX10;
+	RoomSize = { 3, 2 };
+	ShowAllGizmos = true;
+	ResetRoomFloor = false;
+	ClearRoomFloor = false;
+	ResetRoomWalls = false;
+	ClearRoomWalls = false;
+	AddBuildingLevel = false;
+	IsolateMode = EIsolateMode::Off;
+	CutawayHeight = 3;
+	IsolateSelection = false;
+	ReplaceScope = EMeshReplaceScope::CurrentRoom;
+	ReplaceWalls = false;
+	ReplaceFloor = false;
+	SelectionShape = ESelectionShape::Single;
+	ToggleSelection = false;
+	ClearSelection = false;
+	WallType = EPRGWallType::Door;
+	ApplyWallType = false;
+	RebuildAllRooms = false;
+	SpawnWithLayout = false;
+	StoreLayout = false;
+	ApplyLayout = false;
+	UnpackLayout = false;
+	ExportLayout = false;
+	ImportLayout = false;
+	//GizmoScale = 1.0f;
+	InitHeight = 2;
+	TileSize = 2;
+
+	// Set default values for objects. Only paths are set here, the tool loads them asynchronously when it starts
+	DefaultFloorMesh			= TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/PRG_Plugin/Meshes/SM_PRG_Floor.SM_PRG_Floor")));
+	DefaultWallMesh				= TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/PRG_Plugin/Meshes/SM_PRG_Wall.SM_PRG_Wall")));
+	DefaultMat						= TSoftObjectPtr<UMaterial>(FSoftObjectPath(TEXT("/PRG_Plugin/Materials/Mat_Default.Mat_Default")));
+	PersistSelectedMat		= TSoftObjectPtr<UMaterial>(FSoftObjectPath(TEXT("/PRG_Plugin/Materials/Mat_PersistSelected.Mat_PersistSelected")));
+	PersistUnselectedMat	= TSoftObjectPtr<UMaterial>(FSoftObjectPath(TEXT("/PRG_Plugin/Materials/Mat_PersistUnselected.Mat_PersistUnselected")));
+	TempSelectedMat				= TSoftObjectPtr<UMaterial>(FSoftObjectPath(TEXT("/PRG_Plugin/Materials/Mat_TempSelected.Mat_TempSelected")));
+	TempUnselectedMat			= TSoftObjectPtr<UMaterial>(FSoftObjectPath(TEXT("/PRG_Plugin/Materials/Mat_TempUnselected.Mat_TempUnselected")));
+}
+
+#if WITH_EDITOR
+void UPRG_PluginRoomToolProperties::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// The tool is notified with the edited property, which for struct members is shared by every struct of that type
+	if (PropertyChangedEvent.MemberProperty && PropertyChangedEvent.MemberProperty != PropertyChangedEvent.Property
+		&& PropertyChangedEvent.MemberProperty->IsA<FStructProperty>())
+	{
+		FPropertyChangedEvent MemberChangedEvent(PropertyChangedEvent.MemberProperty, PropertyChangedEvent.ChangeType);
+		Super::PostEditChangeProperty(MemberChangedEvent);
+		return;
+	}
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+#endif
+
+/*
+ * Tool implementation
+ */
+
+// ***************************************************************************************************
+// ******************************** PUBLIC FUNCTIONS *************************************************
+// ***************************************************************************************************
+
+UPRG_PluginRoomTool::UPRG_PluginRoomTool()
+{
+	ResetToolState();
+}
+
+void UPRG_PluginRoomTool::SetWorld(UWorld* World)
+{
+	this->TargetWorld = World;
+}
+
+void UPRG_PluginRoomTool::Setup()
+{
+	USingleClickTool::Setup();
+
+	Properties = NewObject<UPRG_PluginRoomToolProperties>(this);
+	AddToolPropertySource(Properties);
+
+	// Find and load or spawn APRG_Settings object
+	if (TargetWorld)
+	{
+		if (AActor* SettingsActor = UGameplayStatics::GetActorOfClass(TargetWorld, APRG_Settings::StaticClass()))
+		{
+			PRGSettings = static_cast<APRG_Settings*>(SettingsActor);
+			Properties->PositionSnap		= PRGSettings->PositionSnap;
+			Properties->RotationSnap		= PRGSettings->RotationSnap;
+			Properties->RoomSize				= PRGSettings->RoomSize;
+			Properties->ShowAllGizmos		= PRGSettings->ShowAllGizmos;
+			//Properties->GizmoScale			= PRGSettings->GizmoScale;
+			Properties->InitHeight			= PRGSettings->InitHeight;
+			Properties->TileSize				= PRGSettings->TileSize;
+			Properties->SpawnPosition		= PRGSettings->SpawnPosition;
+			Properties->FloorMesh				= PRGSettings->FloorMesh;
+			Properties->WallMesh				= PRGSettings->WallMesh;
+			TileSizeCM = Properties->TileSize * 100;
+		}
+		else
+		{
+			const FTransform SpawnLocAndRotation = FTransform(FRotator(0.0f, 0.0f, 0.0f), Properties->SpawnPosition);
+			PRGSettings = TargetWorld->SpawnActorDeferred<APRG_Settings>(APRG_Settings::StaticClass(), SpawnLocAndRotation);
+			PRGSettings->InitSettings(Properties->PositionSnap, Properties->RotationSnap, Properties->RoomSize, 
+				Properties->ShowAllGizmos, /*Properties->GizmoScale,*/ Properties->InitHeight,Properties->TileSize,
+				Properties->SpawnPosition, Properties->FloorMesh, Properties->WallMesh);
+			PRGSettings->FinishSpawning(SpawnLocAndRotation);
+		}
+	}
+
+	RegisterPropertyHandlers();
+	RequestDefaultContent();
+
+	// Highlight the cell under the cursor in EditWalls and EditTiles
+	UMouseHoverBehavior* HoverBehavior = NewObject<UMouseHoverBehavior>(this);
+	HoverBehavior->Initialize(this);
+	AddInputBehavior(HoverBehavior);
+
+	FindRoomsInScene();
+	ToggleGizmoVisibility(Properties->ShowAllGizmos);
+	RoomOverlap.Start(TargetWorld);
+
+	if (GEditor)
+		GEditor->RegisterForUndo(this);
+
+	// Follow regions being loaded and unloaded in World Partition, rooms outside them are not touched
+	LoadedActorAddedHandle = ULevel::OnLoadedActorAddedToLevelEvent.AddUObject(this, &UPRG_PluginRoomTool::OnLoadedActorAdded);
+	LoadedActorRemovedHandle = ULevel::OnLoadedActorRemovedFromLevelEvent.AddUObject(this, &UPRG_PluginRoomTool::OnLoadedActorRemoved);
+
+	SpawnCreateRoomGizmo();
+}
+
+void UPRG_PluginRoomTool::Shutdown(EToolShutdownType ShutdownType)
+{
+	if (GEditor)
+		GEditor->UnregisterForUndo(this);
+
+	// Loads still in progress are not needed anymore
+	if (DefaultMeshesHandle.IsValid())
+		DefaultMeshesHandle->CancelHandle();
+	if (EditContentHandle.IsValid())
+		EditContentHandle->CancelHandle();
+
+	ULevel::OnLoadedActorAddedToLevelEvent.Remove(LoadedActorAddedHandle);
+	ULevel::OnLoadedActorRemovedFromLevelEvent.Remove(LoadedActorRemovedHandle);
+	LoadedRooms.Empty();
+	RoomOverlap.Stop();
+
+	// Gizmos are destroyed below, so a drag in progress never ends
+	ChangeTracker.EndAllInteractions();
+
+	GetToolManager()->GetPairedGizmoManager()->DestroyAllGizmosByOwner(this);
+	ClearIsolation();
+	ResetPersistMaterials(Properties->EditMode);
+	if (CurrentRoom)
+		CurrentRoom->SetExcludedFromBatching(false);
+
+	for (APRG_Room* FoundRoom : Properties->RoomArray)
+	{
+		if (FoundRoom)
+			FoundRoom->CleanupRoom();
+	}
+
+	ResetToolState();
+
+	Properties->RoomArray.Empty();
+	RoomArrayCopy.Empty();
+}
+
+void UPRG_PluginRoomTool::OnTick(float DeltaTime)
+{
+	// Property edits are coalesced per frame, gizmo drags until the drag ends
+	if (!ChangeTracker.IsInInteraction())
+		ChangeTracker.Flush();
+
+	if (LoadedRooms.Num() > 0)
+		SetupLoadedRooms();
+
+	// Mouse moves arrive many times per frame, pick once per tick with the last ray
+	if (bHoverRayChanged)
+		UpdateHoveredCell();
+
+	// Rooms moved or spawned since the last tick are tested against their neighbours only
+	RoomOverlap.Update();
+	if (!ChangeTracker.IsInInteraction())
+	{
+		RoomOverlap.ReportOverlaps([](const FPRGRoomOverlap::FOverlap& Overlap)
+		{
+			UE_LOG(LogPRGTool, Warning, TEXT("%s overlaps %s on %d tiles."), *Overlap.RoomA->GetName(), *Overlap.RoomB->GetName(), Overlap.TilesA.Num());
+		});
+	}
+}
+
+void UPRG_PluginRoomTool::Render(IToolsContextRenderAPI* RenderAPI)
+{
+	RenderOverlaps(RenderAPI);
+
+	bool bPersistent = false;
+	if (HoveredCell == INDEX_NONE || !GetEditCell(HoveredCell, bPersistent))
+		return;
+
+	// Outline the hovered cell in room space, so drawing costs the same for any room size
+	const FPRGGridLayout Grid(CurrentRoom->GetRoomSize(), CurrentRoom->GetTileSizeCM());
+	const double HalfTile = Grid.HalfTileSize();
+	const double Height = CurrentRoom->GetRoomHeight() * 100.0;
+	const double Thickness = HalfTile / 10.0;
+	FBox CellBox;
+	if (Properties->EditMode == EEditMode::EditTiles)
+	{
+		const FVector Position = Grid.TilePosition(HoveredCell);
+		CellBox = FBox(Position - FVector(HalfTile, HalfTile, 0.0), Position + FVector(HalfTile, HalfTile, Thickness));
+	}
+	else
+	{
+		const FVector Position = Grid.WallPosition(HoveredCell);
+		const FVector Extent = Grid.IsXWall(HoveredCell) ? FVector(HalfTile, Thickness, 0.0) : FVector(Thickness, HalfTile, 0.0);
+		CellBox = FBox(Position - Extent, Position + Extent + FVector(0.0, 0.0, Height));
+	}
+
+	const FLinearColor HoverColor = bPersistent ? FLinearColor::Yellow : FLinearColor(0.5f, 0.5f, 0.0f);
+	DrawWireBox(RenderAPI->GetPrimitiveDrawInterface(), CurrentRoom->GetActorTransform().ToMatrixWithScale(), CellBox, HoverColor, SDPG_Foreground, 2.0f);
+}
+
+FInputRayHit UPRG_PluginRoomTool::BeginHoverSequenceHitTest(const FInputDeviceRay& PressPos)
+{
+	// Only hover in edit modes, and never block clicks or gizmos
+	if (Properties->EditMode == EEditMode::EditWalls || Properties->EditMode == EEditMode::EditTiles)
+		return FInputRayHit(TNumericLimits<float>::Max());
+	return FInputRayHit();
+}
+
+void UPRG_PluginRoomTool::OnBeginHover(const FInputDeviceRay& DevicePos)
+{
+	HoverRay = DevicePos.WorldRay;
+	bHoverRayChanged = true;
+}
+
+bool UPRG_PluginRoomTool::OnUpdateHover(const FInputDeviceRay& DevicePos)
+{
+	HoverRay = DevicePos.WorldRay;
+	bHoverRayChanged = true;
+	return true;
+}
+
+void UPRG_PluginRoomTool::OnEndHover()
+{
+	ClearHoveredCell();
+}
+
+void UPRG_PluginRoomTool::OnPropertyModified(UObject* PropertySet, FProperty* Property)
+{
+	if (const FPropertyHandler* Handler = PropertyHandlers.Find(Property))
+		(*Handler)(PropertySet, Property);
+}
+
+void UPRG_PluginRoomTool::RegisterPropertyHandlers()
+{
+	PropertyHandlers.Reset();
+
+	// Enum - EditMode, SelectionShape, IsolateMode, PositionSnap, RotationSnap
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, EditMode), [this]()
+	{
+		ResetRoomEditMode(PrevEditMode);
+		SetRoomEditMode();
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, SelectionShape), [this]()
+	{
+		// Start a new Rectangle or Line selection with the next click
+		SelectionAnchor = INDEX_NONE;
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, IsolateMode), [this]()
+	{
+		ApplyIsolation();
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, PositionSnap), [this]()
+	{
+		PRGSettings->PositionSnap = Properties->PositionSnap;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, RotationSnap), [this]()
+	{
+		PRGSettings->RotationSnap = Properties->RotationSnap;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});
+
+	// Struct - SpawnPosition
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, SpawnPosition), [this]()
+	{
+		PRGSettings->SpawnPosition = Properties->SpawnPosition;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});
+
+	// Bool - ShowAllGizmos
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ShowAllGizmos), [this]()
+	{
+		ToggleGizmoVisibility(Properties->ShowAllGizmos);
+		PRGSettings->ShowAllGizmos = Properties->ShowAllGizmos;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});
+
+	// Bool buttons - only handled when checked, and unchecked again afterwards
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ResetRoomFloor), &UPRG_PluginRoomToolProperties::ResetRoomFloor, [this]()
+	{
+		// Only reset with an already selected current room
+		if (CurrentRoom && CanEditRoomCells(CurrentRoom))
+		{
+			FPRGScopedCellChange CellChange(GetToolManager(), CurrentRoom, LOCTEXT("ResetRoomFloor", "Reset Room Floor"));
+			ResetRoomFloor(CurrentRoom);
+			CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+		}
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ClearRoomFloor), &UPRG_PluginRoomToolProperties::ClearRoomFloor, [this]()
+	{
+		// Only reset with an already selected current room
+		if (CurrentRoom && CanEditRoomCells(CurrentRoom))
+		{
+			FPRGScopedCellChange CellChange(GetToolManager(), CurrentRoom, LOCTEXT("ClearRoomFloor", "Clear Room Floor"));
+			ClearRoomFloor(CurrentRoom);
+			CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+		}
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ResetRoomWalls), &UPRG_PluginRoomToolProperties::ResetRoomWalls, [this]()
+	{
+		// Only reset with an already selected current room
+		if (CurrentRoom && CanEditRoomCells(CurrentRoom))
+		{
+			FPRGScopedCellChange CellChange(GetToolManager(), CurrentRoom, LOCTEXT("ResetRoomWalls", "Reset Room Walls"));
+			ResetRoomWalls(CurrentRoom);
+			CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+		}
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ClearRoomWalls), &UPRG_PluginRoomToolProperties::ClearRoomWalls, [this]()
+	{
+		// Only reset with an already selected current room
+		if (CurrentRoom && CanEditRoomCells(CurrentRoom))
+		{
+			FPRGScopedCellChange CellChange(GetToolManager(), CurrentRoom, LOCTEXT("ClearRoomWalls", "Clear Room Walls"));
+			ClearRoomWalls(CurrentRoom);
+			CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+		}
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, AddBuildingLevel), &UPRG_PluginRoomToolProperties::AddBuildingLevel, [this]()
+	{
+		if (CurrentRoom)
+			AddBuildingLevel(CurrentRoom);
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, IsolateSelection), &UPRG_PluginRoomToolProperties::IsolateSelection, [this]()
+	{
+		Properties->IsolateMode = EIsolateMode::SelectedRooms;
+		ApplyIsolation();
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ReplaceWalls), &UPRG_PluginRoomToolProperties::ReplaceWalls, [this]()
+	{
+		ReplaceRoomMeshes(true);
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ReplaceFloor), &UPRG_PluginRoomToolProperties::ReplaceFloor, [this]()
+	{
+		ReplaceRoomMeshes(false);
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ToggleSelection), &UPRG_PluginRoomToolProperties::ToggleSelection, [this]()
+	{
+		ToggleSelectedCells();
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ClearSelection), &UPRG_PluginRoomToolProperties::ClearSelection, [this]()
+	{
+		ClearCellSelection();
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ApplyWallType), &UPRG_PluginRoomToolProperties::ApplyWallType, [this]()
+	{
+		ApplyWallTypeToSelectedWalls(Properties->WallType);
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, RebuildAllRooms), &UPRG_PluginRoomToolProperties::RebuildAllRooms, [this]()
+	{
+		RebuildAllRooms();
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ValidateRooms), &UPRG_PluginRoomToolProperties::ValidateRooms, [this]()
+	{
+		ValidateRooms();
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, CostReport), &UPRG_PluginRoomToolProperties::CostReport, [this]()
+	{
+		FPRGRoomCostReport& Report = FPRGRoomCostReport::Get();
+		Report.LogReport(TargetWorld);
+		Report.ExportCsv(TargetWorld, FPRGRoomCostReport::GetDefaultCsvPath(TargetWorld));
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, StoreLayout), &UPRG_PluginRoomToolProperties::StoreLayout, [this]()
+	{
+		if (CurrentRoom)
+			StoreRoomLayout(CurrentRoom);
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ApplyLayout), &UPRG_PluginRoomToolProperties::ApplyLayout, [this]()
+	{
+		if (CurrentRoom && Properties->RoomLayout)
+		{
+			CurrentRoom->SetLayout(Properties->RoomLayout);
+			Properties->RoomSize = CurrentRoom->GetRoomSize();
+		}
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, UnpackLayout), &UPRG_PluginRoomToolProperties::UnpackLayout, [this]()
+	{
+		if (CurrentRoom)
+			UnpackRoomLayout(CurrentRoom);
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ExportLayout), &UPRG_PluginRoomToolProperties::ExportLayout, [this]()
+	{
+		ExportLayoutFile();
+	});
+	AddButtonHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, ImportLayout), &UPRG_PluginRoomToolProperties::ImportLayout, [this]()
+	{
+		ImportLayoutFile();
+	});
+
+	// Int - RoomSize, TileSize, InitHeight, CutawayHeight
+	const FPropertyHandler RoomSizeHandler = [this](UObject*, FProperty*)
+	{
+		PRGSettings->RoomSize = Properties->RoomSize;
+		ChangeTracker.MarkDirty(PRGSettings);
+		ResizeRoom();
+	};
+	// Edits of X or Y are reported as RoomSize, see UPRG_PluginRoomToolProperties::PostEditChangeProperty
+	PropertyHandlers.Add(FindFProperty<FProperty>(UPRG_PluginRoomToolProperties::StaticClass(), GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, RoomSize)), RoomSizeHandler);
+
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, TileSize), [this]()
+	{
+		TileSizeCM = Properties->TileSize * 100;
+		PRGSettings->TileSize = Properties->TileSize;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, InitHeight), [this]()
+	{
+		PRGSettings->InitHeight = Properties->InitHeight;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, CutawayHeight), [this]()
+	{
+		if (Properties->IsolateMode == EIsolateMode::Cutaway)
+			ApplyIsolation();
+	});
+
+	// Float - GizmoScale
+	/*AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, GizmoScale), [this]()
+	{
+		SetGizmoScale(Properties->GizmoScale);
+		PRGSettings->GizmoScale = Properties->GizmoScale;
+		ChangeTracker.MarkDirty(PRGSettings);
+	});*/
+
+	// UObject - RoomSelection, WallMesh, FloorMesh
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, RoomSelection), [this]()
+	{
+		if (Properties->RoomSelection && !Properties->RoomSelection->IsPendingKill())
+			SetCurrentRoom(Properties->RoomSelection);
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, WallMesh), [this]()
+	{
+		CellMeshModified(Properties->WallMesh, EEditMode::EditWalls);
+	});
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, FloorMesh), [this]()
+	{
+		CellMeshModified(Properties->FloorMesh, EEditMode::EditTiles);
+	});
+
+	// Array - RoomArray
+	AddPropertyHandler(GET_MEMBER_NAME_CHECKED(UPRG_PluginRoomToolProperties, RoomArray), [this]()
+	{
+		// 1. Delete all Rooms
+		if (Properties->RoomArray.Num() == 0)
+		{
+			for (size_t i = RoomArrayCopy.Num(); i > 0; i--)
+				DeleteRoom(RoomArrayCopy[i-1]);
+		}
+		// 2. Delete a Removed or cleared ArrayRoom entry
+		else if (RoomArraySize >= Properties->RoomArray.Num())
+		{
+			for (APRG_Room* RoomCopy : RoomArrayCopy)
+			{
+				if (!Properties->RoomArray.Contains(RoomCopy))
+				{
+					DeleteRoom(RoomCopy);
+					break;
+				}
+			}
+		}
+		// 3. Added Room
+		else if (RoomArraySize < Properties->RoomArray.Num())
+			SpawnRoom();
+	});
+}
+
+void UPRG_PluginRoomTool::AddPropertyHandler(FName PropertyName, TFunction<void()> Handler)
+{
+	FProperty* Property = FindFProperty<FProperty>(UPRG_PluginRoomToolProperties::StaticClass(), PropertyName);
+	if (!Property)
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("No tool property named %s to handle changes of."), *PropertyName.ToString());
+		return;
+	}
+
+	PropertyHandlers.Add(Property, [Handler = MoveTemp(Handler)](UObject*, FProperty*) { Handler(); });
+}
+
+void UPRG_PluginRoomTool::AddButtonHandler(FName PropertyName, bool UPRG_PluginRoomToolProperties::* Button, TFunction<void()> OnPressed)
+{
+	AddPropertyHandler(PropertyName, [this, Button, OnPressed = MoveTemp(OnPressed)]()
+	{
+		if (Properties->*Button)
+			OnPressed();
+
+		Properties->*Button = false;
+	});
+}
+
+void UPRG_PluginRoomTool::CellMeshModified(UStaticMesh* StaticMesh, EEditMode MeshEditMode)
+{
+	// Apply a new static mesh to all cells selected with a selection shape
+	if (HasCellSelection())
+	{
+		if (StaticMesh && Properties->EditMode == MeshEditMode)
+			ApplyMeshToSelectedCells(StaticMesh);
+	}
+	// Apply a new static mesh to CurrentSelectedActorInRoom
+	else if (CurrentSelectedActorInRoom.Value)
+	{
+		if (StaticMesh)
+		{
+			// Store original materials of new static mesh
+			OriginalMaterials[CurrentSelectedActorInRoom.Key].Empty();
+			auto& OutMaterials = StaticMesh->GetStaticMaterials();
+			for (int j = 0; j < OutMaterials.Num(); j++)
+				OriginalMaterials[CurrentSelectedActorInRoom.Key].Add(OutMaterials[j].MaterialInterface->GetMaterial());
+
+			// Assign new static mesh. Only persistent actors are part of the room, so only those are recorded for undo
+			const AStaticMeshActor* SelectedActor = CurrentSelectedActorInRoom.Value;
+			const int SelectedIndex = CurrentSelectedActorInRoom.Key;
+			const bool bPersistent = CurrentRoom &&
+				((CurrentRoom->GetWalls().IsValidIndex(SelectedIndex) && CurrentRoom->GetWalls()[SelectedIndex].Get() == SelectedActor) ||
+				 (CurrentRoom->GetTiles().IsValidIndex(SelectedIndex) && CurrentRoom->GetTiles()[SelectedIndex].Get() == SelectedActor));
+			FPRGScopedCellChange CellChange(GetToolManager(), bPersistent ? CurrentRoom.Get() : nullptr, LOCTEXT("SetCellMesh", "Set Room Cell Mesh"));
+			if (Properties->EditMode == MeshEditMode)
+				CurrentSelectedActorInRoom.Value->GetStaticMeshComponent()->SetStaticMesh(StaticMesh);
+		}
+	}
+	// Set a new static mesh as default
+	else
+	{
+		if (MeshEditMode == EEditMode::EditWalls)
+			PRGSettings->WallMesh = StaticMesh;
+		else
+			PRGSettings->FloorMesh = StaticMesh;
+		ChangeTracker.MarkDirty(PRGSettings);
+	}
+}
+
+void UPRG_PluginRoomTool::PostUndo(bool bSuccess)
+{
+	ResyncRooms();
+}
+
+void UPRG_PluginRoomTool::PostRedo(bool bSuccess)
+{
+	ResyncRooms();
+}
+
+void UPRG_PluginRoomTool::OnClicked(const FInputDeviceRay& ClickPos)
+{
+	// Trace a ray into the World
+	FCollisionObjectQueryParams QueryParams(FCollisionObjectQueryParams::AllObjects);
+	FHitResult Result;
+	bool bHitWorld = TargetWorld->LineTraceSingleByObjectType(Result, ClickPos.WorldRay.Origin, ClickPos.WorldRay.PointAt(999999), QueryParams);
+	if (bHitWorld)
+	{
+		// Handle trace based on current EditMode
+		switch (Properties->EditMode)
+		{
+		// Set spawn position for new room
+		case EEditMode::CreateRooms:
+			Properties->SpawnPosition = Result.ImpactPoint;
+			PRGSettings->SpawnPosition = Properties->SpawnPosition;
+			ChangeTracker.MarkDirty(PRGSettings);
+			UpdateCreateRoomGizmo(Properties->SpawnPosition);
+			break;
+
+		// Select a room when clicking on a child of a room
+		case EEditMode::ManageRooms:
+			if (APRG_Room* Room = GetTracedRoom(Result))
+				SetCurrentRoom(Room);
+			break;
+
+		// Edit walls in viewport
+		case EEditMode::EditWalls:
+			if (Result.GetActor()->IsA(AWall::StaticClass()))
+				OnClickEditModeInteraction(EEditMode::EditWalls, Result, TempWalls, CurrentRoom->GetWalls());
+			else if (APRG_Room* Room = Cast<APRG_Room>(Result.GetActor()))
+				SwitchEditRoom(Room);
+			break;
+
+		// Edit tiles in viewport
+		case EEditMode::EditTiles:
+			if (Result.GetActor()->IsA(ATile::StaticClass()))
+				OnClickEditModeInteraction(EEditMode::EditTiles, Result, TempTiles, CurrentRoom->GetTiles());
+			else if (APRG_Room* Room = Cast<APRG_Room>(Result.GetActor()))
+				SwitchEditRoom(Room);
+			break;
+
+		// Ignore input for EEditMode::ManageRooms
+		default:
+			break;
+		}
+	}
+}
+
+// ***************************************************************************************************
+// ******************************** PROTECTED FUNCTIONS **********************************************
+// ***************************************************************************************************
+
+// ********************************** Room Functions *************************************************
+
+TObjectPtr<APRG_Room> UPRG_PluginRoomTool::TryGetCurrentRoom()
+{
+	if (CurrentRoom && CurrentRoom->IsPendingKill())
+		CurrentRoom = nullptr;
+
+	// If no current room is set
+	if (CurrentRoom == nullptr)
+	{
+		// Try to recover last room selection
+		if (LastActiveRoom && !LastActiveRoom->IsPendingKill())
+			CurrentRoom = LastActiveRoom;
+		// Take first entry in room array, if valid
+		else if (Properties->RoomArray.Num() > 0)
+		{
+			if (Properties->RoomArray[0])
+			{
+				CurrentRoom = Properties->RoomArray[0];
+				CurrentRoom->InitRoom();
+				SetCurrentRoom(CurrentRoom);
+			}
+		}
+	}
+
+	// Can still be nullptr
+	return CurrentRoom;
+}
+
+void UPRG_PluginRoomTool::SetCurrentRoom(TObjectPtr<APRG_Room> SetRoom)
+{
+	// Reset current room state
+	if (CurrentRoom && !CurrentRoom->IsPendingKill())
+	{
+		if (CurrentRoom != SetRoom)
+			RemoveRoomBoundingBox();
+
+		if (CurrentRoom->GetRoomGizmo())
+			CurrentRoom->GetRoomGizmo()->SetVisibility(Properties->ShowAllGizmos);
+
+		LastActiveRoom = CurrentRoom;
+	}
+	else
+		LastActiveRoom = nullptr;
+
+	CurrentRoom = SetRoom;
+
+	// Set new room state
+	if (SetRoom)
+	{
+		// Room restored by undo has no gizmo yet
+		EnsureRoomGizmo(SetRoom);
+
+		if (Properties->EditMode == EEditMode::ManageRooms)
+		{
+			SpawnRoomBoundingBox();
+			Properties->RoomSize = SetRoom->GetRoomSize();
+			Properties->InitHeight = SetRoom->GetRoomHeight();
+		}
+
+		SetRoom->GetRoomGizmo()->SetVisibility(Properties->EditMode != EEditMode::CreateRooms || Properties->ShowAllGizmos);
+		Properties->RoomSelection = SetRoom;
+
+#if WITH_EDITOR
+		GEditor->SelectNone(false, true, false);
+		GEditor->SelectActor(SetRoom, true, false, false, true);
+#endif
+	}
+
+	// The selected room always stays visible, so the previous room may need hiding again
+	if (Properties->IsolateMode != EIsolateMode::Off)
+	{
+		if (SetRoom && Properties->IsolateMode == EIsolateMode::SelectedRooms)
+			IsolatedRooms.AddUnique(SetRoom);
+		if (LastActiveRoom)
+			ApplyRoomIsolation(LastActiveRoom);
+		if (SetRoom)
+			ApplyRoomIsolation(SetRoom);
+	}
+}
+
+void UPRG_PluginRoomTool::FindRoomsInScene()
+{
+	if (TargetWorld)
+	{
+		TArray<AActor*> FoundActors;
+		UGameplayStatics::GetAllActorsOfClass(TargetWorld, APRG_Room::StaticClass(), FoundActors);
+
+		for (AActor* Actor : FoundActors)
+		{
+			APRG_Room* Room = static_cast<APRG_Room*>(Actor);
+			SetupFoundRoom(Room);
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::SpawnRoom()
+{
+	// Validate room array size to catch if something changed with the array behind the tool's back
+	if (RoomArraySize != Properties->RoomArray.Num() - 1)
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("RoomArraySize mismatching Properties->RoomArray. Resyncing rooms."));
+		Properties->RoomArray.RemoveAll([](const TObjectPtr<APRG_Room>& Room) { return Room == nullptr; });
+		ResyncRooms();
+		Properties->RoomArray.Add(nullptr);
+	}
+
+	// Spawn new room object
+	const FTransform SpawnLocAndRotation = FTransform(FRotator(0.0f, 0.0f, 0.0f), Properties->SpawnPosition);
+	TObjectPtr<APRG_Room> NewRoom = TargetWorld->SpawnActorDeferred<APRG_Room>(APRG_Room::StaticClass(), SpawnLocAndRotation);
+	NewRoom->InitRoom(Properties->RoomSize, Properties->InitHeight, TileSizeCM);
+	NewRoom->FinishSpawning(SpawnLocAndRotation);
+	FPRGScopedNavigationUpdate NavigationUpdate(NewRoom);
+	NewRoom->OnRoomDeletion.BindUObject(this, &UPRG_PluginRoomTool::DeleteRoomInScene);
+	CreateCustomRoomGizmo(NewRoom, false);
+
+	// Store room in arrays
+	int EmptyIndex = Properties->RoomArray.Find(nullptr);
+	if (EmptyIndex != INDEX_NONE)
+		Properties->RoomArray[EmptyIndex] = NewRoom;
+	else
+		Properties->RoomArray[RoomArraySize] = NewRoom;
+	RoomArrayCopy.Add(NewRoom);
+
+	SetCurrentRoom(NewRoom);
+	RoomArraySize = Properties->RoomArray.Num();
+
+	// Rooms using a shared layout get their cells from the layout
+	if (Properties->SpawnWithLayout && Properties->RoomLayout)
+	{
+		NewRoom->SetLayout(Properties->RoomLayout);
+		return;
+	}
+
+	SetRoomFloorDefault(NewRoom);
+	SetRoomWallsDefault(NewRoom);
+	NewRoom->SetDefaultMeshes(Properties->FloorMesh, Properties->WallMesh);
+	NewRoom->NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void UPRG_PluginRoomTool::SetRoomFloorDefault(TObjectPtr<APRG_Room> SetRoom)
+{
+	FPRGGridLayout(Properties->RoomSize, TileSizeCM).ForEachTile([&](int32 Index, const FVector& Position)
+	{
+		ATile* NewTile = SpawnTile(*SetRoom, Index, Position);
+		SetRoom->SetTileAtIndex(Index, NewTile);
+	});
+}
+
+void UPRG_PluginRoomTool::SetRoomWallsDefault(TObjectPtr<APRG_Room> SetRoom)
+{
+	// Spawn initial room walls on the outer edges only. See FPRGGridLayout for the index progression
+	const FPRGGridLayout Grid(Properties->RoomSize, TileSizeCM);
+	Grid.ForEachWall([&](int32 Index, const FVector& Position, const FRotator& Rotation)
+	{
+		if (!Grid.IsExteriorWall(Index))
+			return;
+
+		AWall* NewWall = SpawnWallRot(*SetRoom, Position, Rotation);
+		SetRoom->SetWallAtIndex(Index, NewWall);
+	});
+}
+
+void UPRG_PluginRoomTool::ClearRoomFloor(TObjectPtr<APRG_Room> SetRoom)
+{
+	// Clear any old tiles
+	TArray<TObjectPtr<ATile>>& OldTiles = SetRoom->GetTiles();
+	for (size_t i = 0; i < OldTiles.Num(); i++)
+	{
+		if (OldTiles[i])
+		{
+			TargetWorld->DestroyActor(OldTiles[i]);
+			OldTiles[i] = nullptr;
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::ClearRoomWalls(TObjectPtr<APRG_Room> SetRoom)
+{
+	// Clear any old walls
+	TArray<TObjectPtr<AWall>>& OldWalls = SetRoom->GetWalls();
+	for (size_t i = 0; i < OldWalls.Num(); i++)
+	{
+		if (OldWalls[i])
+		{
+			TargetWorld->DestroyActor(OldWalls[i]);
+			OldWalls[i] = nullptr;
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::ResetRoomFloor(TObjectPtr<APRG_Room> SetRoom)
+{
+	WaitForDefaultMeshes();
+	if (!Properties->FloorMesh)
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("No Floor Object set, unable to reset the floor of %s."), *SetRoom->GetName());
+		return;
+	}
+
+	// Existing tiles only swap their mesh, missing tiles are spawned
+	SetRoom->SetCellMeshes(false, 0, SetRoom->GetTiles().Num(), Properties->FloorMesh);
+	SetRoom->SetDefaultMeshes(Properties->FloorMesh, nullptr);
+}
+
+void UPRG_PluginRoomTool::ResetRoomWalls(TObjectPtr<APRG_Room> SetRoom)
+{
+	WaitForDefaultMeshes();
+	if (!Properties->WallMesh)
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("No Wall Object set, unable to reset the walls of %s."), *SetRoom->GetName());
+		return;
+	}
+
+	// Exterior walls only swap their mesh or are spawned when missing, interior walls are removed
+	const FIntPoint Size = SetRoom->GetRoomSize();
+	for (int i = 0; i < SetRoom->GetWalls().Num(); i++)
+		SetRoom->SetCellMeshes(true, i, 1, FPRGRoomCells::IsExteriorWall(Size, i) ? Properties->WallMesh.Get() : nullptr);
+	SetRoom->SetDefaultMeshes(nullptr, Properties->WallMesh);
+}
+
+void UPRG_PluginRoomTool::AddBuildingLevel(TObjectPtr<APRG_Room> BaseRoom)
+{
+	GetToolManager()->BeginUndoTransaction(LOCTEXT("AddBuildingLevel", "Add Building Level"));
+
+	// Room becomes the ground level of a new building
+	APRG_Building* Building = BaseRoom->GetBuilding();
+	if (!Building)
+	{
+		Building = TargetWorld->SpawnActor<APRG_Building>(BaseRoom->GetActorLocation(), BaseRoom->GetActorRotation());
+		Building->LevelHeight = BaseRoom->GetRoomHeight();
+		Building->AddLevel(BaseRoom);
+	}
+
+	// New level matches the size of the current top level
+	APRG_Room* TopRoom = Building->GetLevelRoom(Building->NumLevels() - 1);
+	const FTransform SpawnTransform = FTransform(FVector(0.0f, 0.0f, Building->GetLevelOffsetCM(Building->NumLevels()))) * Building->GetActorTransform();
+	TObjectPtr<APRG_Room> NewRoom = TargetWorld->SpawnActorDeferred<APRG_Room>(APRG_Room::StaticClass(), SpawnTransform);
+	NewRoom->InitRoom(TopRoom->GetRoomSize(), TopRoom->GetRoomHeight(), TopRoom->GetTileSizeCM());
+	NewRoom->FinishSpawning(SpawnTransform);
+	Building->AddLevel(NewRoom);
+
+	// Register after placing the room, so its gizmo starts at the level position
+	RegisterRoom(NewRoom);
+	{
+		FPRGScopedNavigationUpdate NavigationUpdate(NewRoom);
+		ResetRoomFloor(NewRoom);
+		ResetRoomWalls(NewRoom);
+		NewRoom->NotifyRoomChanged(ERoomChange::Cells);
+	}
+
+	GetToolManager()->EndUndoTransaction();
+
+	SetCurrentRoom(NewRoom);
+}
+
+void UPRG_PluginRoomTool::ReplaceRoomMeshes(bool bWalls)
+{
+	WaitForDefaultMeshes();
+	UStaticMesh* ToMesh = bWalls ? Properties->WallMesh : Properties->FloorMesh;
+	if (!ToMesh)
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("No %s Object set to replace meshes with."), bWalls ? TEXT("Wall") : TEXT("Floor"));
+		return;
+	}
+
+	TArray<TObjectPtr<APRG_Room>> Rooms;
+	GatherReplaceRooms(Rooms);
+
+	const FText Description = bWalls ? LOCTEXT("ReplaceWallMeshes", "Replace Wall Meshes") : LOCTEXT("ReplaceFloorMeshes", "Replace Floor Meshes");
+	GetToolManager()->BeginUndoTransaction(Description);
+
+	TSet<UPRG_RoomLayout*> ChangedLayouts;
+	int NumChanged = 0;
+	for (TObjectPtr<APRG_Room>& Room : Rooms)
+	{
+		// Shared layouts are changed once, which updates every room using them
+		if (UPRG_RoomLayout* Layout = Room->GetLayout())
+		{
+			if (!ChangedLayouts.Contains(Layout))
+			{
+				ChangedLayouts.Add(Layout);
+				NumChanged += Layout->ReplaceCellMeshes(bWalls, Properties->ReplaceFromMesh, ToMesh);
+			}
+			continue;
+		}
+
+		if (!Room->AreCellsLoaded())
+		{
+			UE_LOG(LogPRGTool, Warning, TEXT("%s is only partially loaded, skipped replacing its meshes."), *Room->GetName());
+			continue;
+		}
+
+		FPRGScopedCellChange CellChange(GetToolManager(), Room, Description);
+		NumChanged += Room->ReplaceCellMeshes(bWalls, Properties->ReplaceFromMesh, ToMesh);
+	}
+
+	GetToolManager()->EndUndoTransaction();
+
+	UE_LOG(LogPRGTool, Log, TEXT("Replaced the mesh of %d %s in %d rooms."), NumChanged, bWalls ? TEXT("walls") : TEXT("tiles"), Rooms.Num());
+}
+
+void UPRG_PluginRoomTool::GatherReplaceRooms(TArray<TObjectPtr<APRG_Room>>& OutRooms)
+{
+	switch (Properties->ReplaceScope)
+	{
+	case EMeshReplaceScope::CurrentRoom:
+		if (auto ActiveRoom = TryGetCurrentRoom())
+			OutRooms.Add(ActiveRoom);
+		break;
+
+	case EMeshReplaceScope::SelectedRooms:
+		GatherSelectedRooms(OutRooms);
+		break;
+
+	case EMeshReplaceScope::AllRooms:
+		for (TObjectPtr<APRG_Room>& Room : RoomArrayCopy)
+		{
+			if (IsValid(Room))
+				OutRooms.Add(Room);
+		}
+		break;
+	}
+}
+
+void UPRG_PluginRoomTool::GatherSelectedRooms(TArray<TObjectPtr<APRG_Room>>& OutRooms)
+{
+	UEditorActorSubsystem* EditorActorSubsystem = GEditor ? GEditor->GetEditorSubsystem<UEditorActorSubsystem>() : nullptr;
+	if (!EditorActorSubsystem)
+		return;
+
+	for (AActor* SelectedActor : EditorActorSubsystem->GetSelectedLevelActors())
+	{
+		// Selected walls and tiles stand for their room
+		APRG_Room* Room = Cast<APRG_Room>(SelectedActor);
+		if (!Room && SelectedActor)
+			Room = Cast<APRG_Room>(SelectedActor->GetAttachParentActor());
+
+		if (Room && RoomArrayCopy.Contains(Room))
+			OutRooms.AddUnique(Room);
+	}
+}
+
+void UPRG_PluginRoomTool::ApplyIsolation()
+{
+	IsolatedRooms.Reset();
+	if (Properties->IsolateMode == EIsolateMode::SelectedRooms)
+	{
+		GatherSelectedRooms(IsolatedRooms);
+		if (CurrentRoom)
+			IsolatedRooms.AddUnique(CurrentRoom);
+	}
+
+	// Rooms only flag their change, so batched rendering rebuilds once for all of them on the next tick
+	int32 NumHidden = 0;
+	for (TObjectPtr<APRG_Room>& Room : RoomArrayCopy)
+	{
+		if (!IsValid(Room))
+			continue;
+
+		ApplyRoomIsolation(Room);
+		if (Room->IsRoomHiddenBy(ERoomHiddenBy::Isolation))
+			NumHidden++;
+	}
+
+	if (Properties->IsolateMode != EIsolateMode::Off)
+		UE_LOG(LogPRGTool, Log, TEXT("Isolation hides %d of %d rooms."), NumHidden, RoomArrayCopy.Num());
+}
+
+void UPRG_PluginRoomTool::ApplyRoomIsolation(TObjectPtr<APRG_Room> SetRoom)
+{
+	if (!IsValid(SetRoom))
+		return;
+
+	bool bHide = false;
+	if (SetRoom != CurrentRoom)
+	{
+		switch (Properties->IsolateMode)
+		{
+		case EIsolateMode::Cutaway:
+			// Rooms are placed by their floor, so this also hides all building levels from the cut upwards
+			bHide = SetRoom->GetActorLocation().Z >= Properties->CutawayHeight * 100.0f;
+			break;
+
+		case EIsolateMode::SelectedRooms:
+			bHide = !IsolatedRooms.Contains(SetRoom);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	SetRoom->SetRoomHidden(bHide, ERoomHiddenBy::Isolation);
+}
+
+void UPRG_PluginRoomTool::ClearIsolation()
+{
+	IsolatedRooms.Reset();
+	for (TObjectPtr<APRG_Room>& Room : RoomArrayCopy)
+	{
+		if (IsValid(Room))
+			Room->SetRoomHidden(false, ERoomHiddenBy::Isolation);
+	}
+}
+
+void UPRG_PluginRoomTool::SetupFoundRoom(TObjectPtr<APRG_Room> FoundRoom)
+{
+	// Initialize room data
+	FoundRoom->InitRoom();
+
+	// Editing a room with unloaded cells would orphan or duplicate them, so leave it until its region is loaded
+	if (!FoundRoom->AreCellsLoaded())
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("%s is only partially loaded and is ignored by the tool. Load its region to edit it."), *FoundRoom->GetName());
+		return;
+	}
+
+	RegisterRoom(FoundRoom);
+
+	// Recreate room from map in room data
+	FoundRoom->GatherAttachedCells();
+}
+
+void UPRG_PluginRoomTool::RegisterRoom(TObjectPtr<APRG_Room> AddRoom)
+{
+	// Bind cleanup delegate
+	AddRoom->OnRoomDeletion.BindUObject(this, &UPRG_PluginRoomTool::DeleteRoomInScene);
+
+	// Register tool with plugin variables
+	RoomArrayCopy.Add(AddRoom);
+	Properties->RoomArray.Add(AddRoom);
+	RoomArraySize = Properties->RoomArray.Num();
+
+	// Create a room gizmo
+	CreateCustomRoomGizmo(AddRoom, true);
+
+	// Rooms loaded while isolating are hidden like the others
+	ApplyRoomIsolation(AddRoom);
+}
+
+void UPRG_PluginRoomTool::ReleaseRoom(TObjectPtr<APRG_Room> ReleasedRoom)
+{
+	if (!RoomArrayCopy.Contains(ReleasedRoom))
+		return;
+
+	if (ReleasedRoom == CurrentRoom)
+	{
+		ResetRoomEditMode(Properties->EditMode);
+		RemoveRoomBoundingBox();
+		CurrentRoom = nullptr;
+		CurrentSelectedActorInRoom = { -1, nullptr };
+	}
+	if (ReleasedRoom == LastActiveRoom)
+		LastActiveRoom = nullptr;
+
+	if (ReleasedRoom->GetRoomGizmo())
+		ReleasedRoom->RemoveRoomGizmo(GetToolManager()->GetPairedGizmoManager());
+	if (IsValid(ReleasedRoom))
+		ReleasedRoom->SetRoomHidden(false, ERoomHiddenBy::Isolation);
+	ReleasedRoom->CleanupRoom();
+
+	RoomArrayCopy.RemoveSingle(ReleasedRoom);
+	Properties->RoomArray.RemoveSingle(ReleasedRoom);
+	RoomArraySize = Properties->RoomArray.Num();
+}
+
+void UPRG_PluginRoomTool::ResyncRooms()
+{
+	// Rooms removed by undo of their creation or redo of their deletion
+	for (int i = RoomArrayCopy.Num() - 1; i >= 0; i--)
+	{
+		if (!IsValid(RoomArrayCopy[i]))
+			ReleaseRoom(RoomArrayCopy[i]);
+	}
+	Properties->RoomArray.RemoveAll([](const TObjectPtr<APRG_Room>& Room) { return !IsValid(Room); });
+	RoomArraySize = Properties->RoomArray.Num();
+
+	// Rooms restored by undo of their deletion or redo of their creation
+	for (TActorIterator<APRG_Room> It(TargetWorld); It; ++It)
+	{
+		if (!RoomArrayCopy.Contains(*It))
+			SetupFoundRoom(*It);
+	}
+
+	// Rebuild temporary actors and materials, as cells of the current room may have been respawned
+	if (TryGetCurrentRoom() && (Properties->EditMode == EEditMode::EditWalls || Properties->EditMode == EEditMode::EditTiles))
+	{
+		ResetRoomEditMode(Properties->EditMode);
+		SetRoomEditMode();
+	}
+	else if (CurrentRoom && Properties->EditMode == EEditMode::ManageRooms)
+	{
+		Properties->RoomSize = CurrentRoom->GetRoomSize();
+		RemoveRoomBoundingBox();
+		SpawnRoomBoundingBox();
+	}
+
+	ToggleGizmoVisibility(Properties->ShowAllGizmos);
+}
+
+void UPRG_PluginRoomTool::RebuildAllRooms()
+{
+	WaitForDefaultMeshes();
+	ResyncRooms();
+
+	// Rooms are checked by hash first, so unchanged rooms are neither captured for undo nor marked dirty
+	GetToolManager()->BeginUndoTransaction(LOCTEXT("RebuildAllRooms", "Rebuild All Rooms"));
+	int NumRebuilt = 0;
+	int NumChecked = 0;
+	for (APRG_Room* Room : RoomArrayCopy)
+	{
+		if (!IsValid(Room) || !CanEditRoomCells(Room))
+			continue;
+
+		NumChecked++;
+		if (Room->IsRegenerationCurrent(Properties->FloorMesh, Properties->WallMesh))
+			continue;
+
+		FPRGScopedCellChange CellChange(GetToolManager(), Room, LOCTEXT("RebuildRoom", "Rebuild Room"));
+		if (Room->RegenerateCells(Properties->FloorMesh, Properties->WallMesh, false))
+		{
+			ChangeTracker.MarkDirty(Room);
+			NumRebuilt++;
+		}
+	}
+	GetToolManager()->EndUndoTransaction();
+
+	UE_LOG(LogPRGTool, Log, TEXT("Rebuilt %d rooms, %d unchanged."), NumRebuilt, NumChecked - NumRebuilt);
+}
+
+void UPRG_PluginRoomTool::ValidateRooms()
+{
+	// Rooms created or deleted behind the tool's back are picked up first, so every room in the world is validated
+	ResyncRooms();
+
+	FPRGRoomValidator Validator(true);
+	Validator.SetGizmoRepair([this](APRG_Room& Room)
+	{
+		if (Room.GetRoomGizmo())
+			Room.RemoveRoomGizmo(GetToolManager()->GetPairedGizmoManager());
+		CreateCustomRoomGizmo(&Room, true);
+	});
+
+	// Rooms whose problems were only reported, or only had their gizmo recreated, are left unchanged
+	bool bRepaired = false;
+	for (APRG_Room* Room : RoomArrayCopy)
+	{
+		const int32 ModifiedBefore = Validator.GetNumModifiedRooms();
+		if (IsValid(Room) && Validator.ValidateRoom(*Room) > 0 && Validator.GetNumModifiedRooms() > ModifiedBefore)
+		{
+			Room->NotifyRoomChanged(ERoomChange::Cells);
+			ChangeTracker.MarkDirty(Room);
+			bRepaired = true;
+		}
+	}
+	Validator.LogSummary();
+
+	// Rebuild temporary actors and materials from the repaired cell arrays
+	if (bRepaired)
+		ResyncRooms();
+}
+
+void UPRG_PluginRoomTool::EnsureRoomGizmo(TObjectPtr<APRG_Room> SetRoom)
+{
+	if (SetRoom && !SetRoom->GetRoomGizmo())
+	{
+		UE_LOG(LogPRGTool, Log, TEXT("%s has no gizmo, creating a new one."), *SetRoom->GetName());
+		CreateCustomRoomGizmo(SetRoom, true);
+	}
+}
+
+void UPRG_PluginRoomTool::OnLoadedActorAdded(AActor& Actor)
+{
+	if (Actor.GetWorld() != TargetWorld)
+		return;
+
+	// A loaded cell can complete a room that was skipped as partially loaded
+	APRG_Room* Room = Cast<APRG_Room>(&Actor);
+	if (!Room && (Actor.IsA<AWall>() || Actor.IsA<ATile>()))
+		Room = Cast<APRG_Room>(Actor.GetAttachParentActor());
+
+	if (Room && !RoomArrayCopy.Contains(Room))
+		LoadedRooms.AddUnique(Room);
+}
+
+void UPRG_PluginRoomTool::OnLoadedActorRemoved(AActor& Actor)
+{
+	if (APRG_Room* Room = Cast<APRG_Room>(&Actor))
+	{
+		LoadedRooms.Remove(Room);
+		ReleaseRoom(Room);
+	}
+	// Losing a cell leaves the room partially loaded
+	else if (Actor.IsA<AWall>() || Actor.IsA<ATile>())
+	{
+		if (APRG_Room* ParentRoom = Cast<APRG_Room>(Actor.GetAttachParentActor()))
+			ReleaseRoom(ParentRoom);
+	}
+}
+
+void UPRG_PluginRoomTool::SetupLoadedRooms()
+{
+	for (const TWeakObjectPtr<APRG_Room>& LoadedRoom : LoadedRooms)
+	{
+		if (APRG_Room* Room = LoadedRoom.Get())
+		{
+			if (!RoomArrayCopy.Contains(Room))
+				SetupFoundRoom(Room);
+		}
+	}
+	LoadedRooms.Empty();
+
+	ToggleGizmoVisibility(Properties->ShowAllGizmos);
+}
+
+void UPRG_PluginRoomTool::ExportLayoutFile()
+{
+	const FString FilePath = Properties->LayoutFile.FilePath;
+	if (FilePath.IsEmpty())
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("No layout file set to export to."));
+		return;
+	}
+
+	if (FPRGLayoutWriter::WriteFile(FilePath, RoomArrayCopy))
+		UE_LOG(LogPRGTool, Log, TEXT("Exported %d rooms to '%s'."), RoomArrayCopy.Num(), *FilePath);
+}
+
+void UPRG_PluginRoomTool::ImportLayoutFile()
+{
+	// Default meshes replace meshes missing from the file
+	WaitForDefaultMeshes();
+	FPRGLayoutReader Reader;
+	if (!Reader.Open(Properties->LayoutFile.FilePath))
+		return;
+
+	// Importing is not recorded in the transaction buffer, as that would snapshot every spawned actor
+	TGuardValue<ITransaction*> DisableUndo(GUndo, nullptr);
+
+	FScopedSlowTask SlowTask(Reader.GetRoomCount(), LOCTEXT("ImportLayout", "Importing room layout..."));
+	SlowTask.MakeDialog(true);
+
+	// Spawn rooms in chunks, so memory use stays bounded for large layout files
+	TArray<FPRGRoomRecord> Records;
+	int ImportedRooms = 0;
+	while (!SlowTask.ShouldCancel() && Reader.ReadRecords(ImportChunkSize, Records))
+	{
+		SlowTask.EnterProgressFrame(Records.Num());
+
+		for (const FPRGRoomRecord& Record : Records)
+		{
+			if (TObjectPtr<APRG_Room> NewRoom = Reader.SpawnRoom(TargetWorld, Record, Properties->FloorMesh, Properties->WallMesh))
+			{
+				RegisterRoom(NewRoom);
+				ImportedRooms++;
+			}
+		}
+	}
+
+	// Rooms were spawned at their stored transform, but the gizmo visibility still needs to match the current settings
+	ToggleGizmoVisibility(Properties->ShowAllGizmos);
+
+	UE_LOG(LogPRGTool, Log, TEXT("Imported %d of %d rooms from '%s'."), ImportedRooms, Reader.GetRoomCount(), *Properties->LayoutFile.FilePath);
+}
+
+void UPRG_PluginRoomTool::StoreRoomLayout(TObjectPtr<APRG_Room> SetRoom)
+{
+	if (!Properties->RoomLayout)
+		Properties->RoomLayout = CreateLayoutAsset(SetRoom->GetName());
+
+	if (!Properties->RoomLayout || SetRoom->GetLayout() == Properties->RoomLayout)
+		return;
+
+	// Updating the layout also updates all other rooms already using it
+	Properties->RoomLayout->CaptureRoom(*SetRoom);
+	SetRoom->SetLayout(Properties->RoomLayout);
+}
+
+void UPRG_PluginRoomTool::UnpackRoomLayout(TObjectPtr<APRG_Room> SetRoom)
+{
+	UPRG_RoomLayout* Layout = SetRoom->GetLayout();
+	if (!Layout)
+		return;
+
+	// Default meshes replace meshes missing from the palette
+	WaitForDefaultMeshes();
+
+	SetRoom->SetLayout(nullptr);
+	SetRoom->InitRoom(Layout->Cells.RoomSize, Layout->Cells.RoomHeight, Layout->Cells.TileSizeCM);
+	SetRoom->SpawnCells(Layout->Cells, Layout->Palette, Properties->FloorMesh, Properties->WallMesh);
+}
+
+UPRG_RoomLayout* UPRG_PluginRoomTool::CreateLayoutAsset(const FString& BaseName)
+{
+	FString PackageName, AssetName;
+	IAssetTools& AssetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
+	AssetTools.CreateUniqueAssetName(TEXT("/Game/PRG_Layouts/L_") + BaseName, TEXT(""), PackageName, AssetName);
+
+	UPackage* Package = CreatePackage(*PackageName);
+	UPRG_RoomLayout* NewLayout = NewObject<UPRG_RoomLayout>(Package, *AssetName, RF_Public | RF_Standalone | RF_Transactional);
+	FAssetRegistryModule::AssetCreated(NewLayout);
+	Package->MarkPackageDirty();
+
+	return NewLayout;
+}
+
+bool UPRG_PluginRoomTool::CanEditRoomCells(TObjectPtr<APRG_Room> SetRoom) const
+{
+	if (SetRoom && SetRoom->HasLayout())
+	{
+		UE_LOG(LogPRGTool, Warning, TEXT("%s uses a shared layout. Unpack the layout to edit its cells."), *SetRoom->GetName());
+		return false;
+	}
+	return true;
+}
+
+void UPRG_PluginRoomTool::ResizeRoom()
+{
+	/* INFO: Resizes the walls and tiles arrays
+	 * Note that the UI allows changing only 1 axis at a time
+	 * 
+	 * If new size is smaller:	remove walls and tiles
+	 * If new size is larger:		spawn only tiles
+	 */
+
+	if (Properties->EditMode != EEditMode::ManageRooms)
+		return;
+
+	auto ActiveRoom = TryGetCurrentRoom();
+	if (ActiveRoom && !CanEditRoomCells(ActiveRoom))
+	{
+		Properties->RoomSize = ActiveRoom->GetRoomSize();
+		return;
+	}
+
+	if (ActiveRoom)
+	{
+		const FIntPoint OldRoomSize = ActiveRoom->GetRoomSize();
+		const FIntPoint NewRoomSize = Properties->RoomSize;
+
+		// Validate if anything changed
+		if (OldRoomSize.X == NewRoomSize.X && OldRoomSize.Y == NewRoomSize.Y)
+			return;
+
+		FPRGScopedCellChange CellChange(GetToolManager(), ActiveRoom, LOCTEXT("ResizeRoom", "Resize Room"));
+
+		// Keep cells inside the new bounds, destroy the others
+		ActiveRoom->ResizeCells(NewRoomSize);
+
+		// Add new tiles based on RoomSizes
+		const FPRGGridLayout NewGrid(NewRoomSize, TileSizeCM);
+
+		// Lambda - Spawn a tile in the grown area
+		auto SpawnNewTile = [&](int32 NewIndex, const FVector& Position)
+		{
+			ATile* NewTile = SpawnTile(*ActiveRoom, NewIndex, Position);
+			ActiveRoom->SetTileAtIndex(NewIndex, NewTile);
+		};
+
+		// Check to spawn new tiles, if X larger
+		NewGrid.ForEachTileInRange(OldRoomSize.X, NewRoomSize.X, 0,             OldRoomSize.Y, SpawnNewTile);
+		// Check to spawn new tiles, if Y larger
+		NewGrid.ForEachTileInRange(0,             NewRoomSize.X, OldRoomSize.Y, NewRoomSize.Y, SpawnNewTile);
+
+		ActiveRoom->NotifyRoomChanged(ERoomChange::Cells);
+
+		// Reset bounding box
+		RemoveRoomBoundingBox();
+		SpawnRoomBoundingBox();
+	}
+}
+
+void UPRG_PluginRoomTool::DeleteRoomInScene(TObjectPtr<APRG_Room> DeletedRoom)
+{
+	Properties->RoomArray.Remove(DeletedRoom);
+	DeleteRoom(DeletedRoom);
+}
+
+void UPRG_PluginRoomTool::DeleteRoom(TObjectPtr<APRG_Room> removeRoom)
+{
+	// Validation
+	if (!TargetWorld || !removeRoom || !RoomArrayCopy.Contains(removeRoom))
+		return;
+
+	if (removeRoom == CurrentRoom)
+		SetCurrentRoom(nullptr);
+
+	RemoveRoomBoundingBox();
+	DeleteTempActors();
+
+	// If an entry was cleared, then delete the empty entry from RoomArray
+	if (RoomArrayCopy.Num() == Properties->RoomArray.Num())
+		Properties->RoomArray.RemoveSingle(nullptr);
+
+	// Remove gizmo from scene
+	removeRoom->RemoveRoomGizmo(GetToolManager()->GetPairedGizmoManager());
+
+	RoomArrayCopy.RemoveSingle(removeRoom);
+	APRG_Building* Building = removeRoom->GetBuilding();
+	TargetWorld->DestroyActor(removeRoom);
+
+	// Close the gap left in the building
+	if (Building)
+		Building->RestackLevels();
+
+	CurrentSelectedActorInRoom = { -1, nullptr };
+
+	RoomArraySize = Properties->RoomArray.Num();
+
+	// Set the first room as selected
+	TryGetCurrentRoom();
+}
+
+void UPRG_PluginRoomTool::DeleteTempActors()
+{
+	for (auto& TempWall : TempWalls)
+	{
+		if (TempWall)
+			TargetWorld->DestroyActor(TempWall);
+	}
+	TempWalls.Empty();
+
+	for (auto& TempTile : TempTiles)
+	{
+		if (TempTile)
+			TargetWorld->DestroyActor(TempTile);
+	}
+	TempTiles.Empty();
+}
+
+// ********************************** Gizmo Functions ************************************************
+
+void UPRG_PluginRoomTool::CreateCustomRoomGizmo(TObjectPtr<APRG_Room> room, bool loadTransform)
+{
+	FTransform StartTransform = FTransform::Identity;
+
+	// When restoring, set initial transform to room transform
+	if (loadTransform)
+	{
+		StartTransform = room->GetActorTransform();
+		Properties->SpawnPosition = room->GetActorLocation();
+	}
+	else
+		StartTransform.SetTranslation(Properties->SpawnPosition);
+
+	TransformProxy = NewObject<UTransformProxy>(this);
+	TransformProxy->SetTransform(StartTransform);
+	TransformGizmo = UE::TransformGizmoUtil::CreateCustomTransformGizmo(GetToolManager()->GetPairedGizmoManager(),
+		ETransformGizmoSubElements::TranslateAllAxes | ETransformGizmoSubElements::TranslateAllPlanes | ETransformGizmoSubElements::RotateAxisZ, this);
+	
+	if (Properties->EditMode == EEditMode::CreateRooms && !Properties->ShowAllGizmos)
+		TransformGizmo->SetVisibility(false);
+	
+	TransformGizmo->SetActiveTarget(TransformProxy, GetToolManager());
+
+	// Listen for changes to the proxy and update the room when that happens
+	TransformProxy->OnTransformChanged.AddUObject(this, &UPRG_PluginRoomTool::GizmoTransformChanged);
+	TransformProxy->OnBeginTransformEdit.AddUObject(this, &UPRG_PluginRoomTool::GizmoTransformStarted);
+	TransformProxy->OnEndTransformEdit.AddUObject(this, &UPRG_PluginRoomTool::GizmoTransformEnded);
+
+	// Store proxy with room
+	room->SetRoomGizmo(TransformGizmo);
+	room->SetProxyTransform(TransformProxy);
+}
+
+void UPRG_PluginRoomTool::GizmoTransformChanged(UTransformProxy* Proxy, FTransform Transform)
+{
+	// Handle position snapping
+	if (Properties->PositionSnap != EPosSnap::NoSnapping)
+	{
+		int SnapPosSize = int(Properties->PositionSnap);
+		FVector3d TransformPos = Transform.GetLocation();
+		TransformPos.X = roundf(TransformPos.X / SnapPosSize) * SnapPosSize;
+		TransformPos.Y = roundf(TransformPos.Y / SnapPosSize) * SnapPosSize;
+		TransformPos.Z = roundf(TransformPos.Z / SnapPosSize) * SnapPosSize;
+		Transform.SetLocation(TransformPos);
+	}
+
+	// Handle rotation snapping
+	if (Properties->RotationSnap != ERotSnap::NoSnapping)
+	{
+		FQuat4d TransformRot = Transform.GetRotation();
+		float RotSnapped = TransformRot.Euler().Z;
+		int SnapRotSize = int(Properties->RotationSnap);
+		RotSnapped = roundf(RotSnapped / SnapRotSize) * SnapRotSize;
+		TransformRot = FQuat4d::MakeFromEuler(FVector3d(0, 0, RotSnapped));
+		Transform.SetRotation(TransformRot);
+	}
+
+	// Check if able to modify gizmo's
+	if (Properties->EditMode != EEditMode::CreateRooms || Properties->ShowAllGizmos)
+	{
+		// Find Room matching activated gizmo
+		for (APRG_Room* FoundRoom : Properties->RoomArray)
+		{
+			if (!FoundRoom)
+				return;
+
+			if (FoundRoom->GetProxyTransform() == Proxy)
+			{
+				if (FoundRoom != CurrentRoom)
+				{
+					ResetRoomEditMode(Properties->EditMode);
+					SetCurrentRoom(FoundRoom);
+					SetRoomEditMode();
+				}
+
+				// Set room as selected actor
+				if (UEditorActorSubsystem* EditorActorSubsystem = GEditor->GetEditorSubsystem<UEditorActorSubsystem>())
+					EditorActorSubsystem->SetSelectedLevelActors({ FoundRoom });
+
+				// Levels of a building move together, so move the building instead
+				if (APRG_Building* Building = FoundRoom->GetBuilding())
+				{
+					Building->SetActorTransform(FoundRoom->GetRootComponent()->GetRelativeTransform().Inverse() * Transform);
+					ChangeTracker.MarkDirty(Building);
+
+					for (int32 Level = 0; Level < Building->NumLevels(); Level++)
+					{
+						APRG_Room* LevelRoom = Building->GetLevelRoom(Level);
+						if (!LevelRoom)
+							continue;
+
+						LevelRoom->NotifyRoomChanged(ERoomChange::Transform);
+						if (LevelRoom != FoundRoom && LevelRoom->GetRoomGizmo())
+							LevelRoom->GetRoomGizmo()->ReinitializeGizmoTransform(LevelRoom->GetActorTransform());
+					}
+					return;
+				}
+
+				FoundRoom->SetActorTransform(Transform);
+				ChangeTracker.MarkDirty(FoundRoom);
+				FoundRoom->NotifyRoomChanged(ERoomChange::Transform);
+
+				return;
+			}
+		}
+	}
+
+	// Update SpawnPosition only if not already changing an existing room gizmo
+	if (Properties->EditMode == EEditMode::CreateRooms)
+	{
+		if (SpawnProxy->GetTransform().GetLocation() != Transform.GetLocation())
+		{
+			SpawnProxy->SetTransform(Transform);
+			Properties->SpawnPosition = Transform.GetLocation();
+			PRGSettings->SpawnPosition = Properties->SpawnPosition;
+			ChangeTracker.MarkDirty(PRGSettings);
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::GizmoTransformStarted(UTransformProxy* Proxy)
+{
+	ChangeTracker.BeginInteraction();
+}
+
+void UPRG_PluginRoomTool::GizmoTransformEnded(UTransformProxy* Proxy)
+{
+	ChangeTracker.EndInteraction();
+}
+
+//void UPRG_PluginRoomTool::SetGizmoScale(float Scale)
+//{
+//	if (TargetWorld)
+//	{
+//		TArray<AActor*> FoundActors;
+//		UGameplayStatics::GetAllActorsOfClass(TargetWorld, APRG_Room::StaticClass(), FoundActors);
+//
+//		for (AActor* Actor : FoundActors)
+//		{
+//      // NOPE - RESCALES EVERYTHING EXCEPT GIZMO
+//			//APRG_Room* Room = static_cast<APRG_Room*>(Actor);
+//			//FTransform Transform = Room->GetRoomGizmo()->GetGizmoTransform();
+//			//Room->SetProxyTransform(Proxy);
+//
+//			// NOPE - NOTHING
+//			//APRG_Room* Room = static_cast<APRG_Room*>(Actor);
+//			//TObjectPtr<UCombinedTransformGizmo> Gizmo = Room->GetRoomGizmo();
+//			//Gizmo->GetGizmoActor()->SetActorScale3D(FVector3d(Scale));
+//		}
+//	}
+//}
+
+void UPRG_PluginRoomTool::ToggleGizmoVisibility(bool Visible)
+{
+	// Only rooms registered with the tool have gizmos. Partially loaded rooms are skipped
+	for (APRG_Room* Room : Properties->RoomArray)
+	{
+		if (Room && Room->GetRoomGizmo())
+		{
+			if (CurrentRoom != Room)
+			{
+				Room->GetRoomGizmo()->SetVisibility(Visible);
+				if (Visible)
+					Room->GetRoomGizmo()->SetActiveTarget(Room->GetProxyTransform());
+			}
+			// Ensure that outside CreateRooms mode the CurrentRoom always has its gizmo
+			else
+			{
+				Room->GetRoomGizmo()->SetVisibility(Properties->EditMode != EEditMode::CreateRooms || Properties->ShowAllGizmos);
+			}
+		}
+	}
+}
+
+// ******************************** Edit Mode Functions **********************************************
+
+// Reset room from edit state. Deletes temporary actors and resets materials
+void UPRG_PluginRoomTool::ResetRoomEditMode(EEditMode EditMode)
+{
+	// Clear old state. Materials of selected cells are reset with the others
+	SelectedCells.Reset();
+	SelectionAnchor = INDEX_NONE;
+	ClearHoveredCell();
+	DeleteTempActors();
+	ResetPersistMaterials(EditMode);
+
+	// Hand the room back to level-wide batching
+	if (CurrentRoom && !CurrentRoom->IsPendingKill())
+		CurrentRoom->SetExcludedFromBatching(false);
+}
+
+void UPRG_PluginRoomTool::SwitchEditRoom(TObjectPtr<APRG_Room> SetRoom)
+{
+	// Rooms not being edited are traced through their room collision as a whole, so this click only switches rooms.
+	// The edited room collides per cell again, so the next click selects a wall or tile
+	if (!SetRoom || SetRoom == CurrentRoom || !RoomArrayCopy.Contains(SetRoom))
+		return;
+
+	CurrentSelectedActorInRoom = { -1, nullptr };
+	ResetRoomEditMode(Properties->EditMode);
+	SetCurrentRoom(SetRoom);
+	SetRoomEditMode();
+}
+
+// Set room to selected EditMode. Spawns appropriate temporary actors and changes material
+void UPRG_PluginRoomTool::SetRoomEditMode()
+{
+	// Only spawn temporary actors if there is a room available
+	if (auto ActiveRoom = TryGetCurrentRoom())
+	{
+		// Room restored by undo has no gizmo yet
+		EnsureRoomGizmo(ActiveRoom);
+
+		// Rooms using a shared layout own no cell actors, so skip them instead of spawning temporary actors for every cell
+		const bool bEditCells = (Properties->EditMode == EEditMode::EditWalls || Properties->EditMode == EEditMode::EditTiles) && CanEditRoomCells(ActiveRoom);
+
+		// Render the room's own cell actors while editing, so edit materials and temporary actors show
+		ActiveRoom->SetExcludedFromBatching(bEditCells);
+
+		if (bEditCells && Properties->EditMode == EEditMode::EditWalls)
+		{
+			SetEditModeMaterials(TempWalls, ActiveRoom->GetWalls(), &UPRG_PluginRoomTool::SpawnWall, &APRG_Room::GetWallPositionFromIndex);
+		}
+		else if (bEditCells && Properties->EditMode == EEditMode::EditTiles)
+		{
+			SetEditModeMaterials(TempTiles, ActiveRoom->GetTiles(), &UPRG_PluginRoomTool::SpawnTile, &APRG_Room::GetTilePositionFromIndex);
+		}
+
+		if (Properties->EditMode != EEditMode::CreateRooms)
+		{
+			Properties->RoomSize = ActiveRoom->GetRoomSize();
+			Properties->InitHeight = ActiveRoom->GetRoomHeight();
+			ActiveRoom->GetRoomGizmo()->SetVisibility(true);
+		}
+	}
+
+	// Update gizmo's when switching to CreateRooms mode
+	if (Properties->EditMode == EEditMode::CreateRooms)
+	{
+		SetCurrentRoom(nullptr);
+		SpawnCreateRoomGizmo();
+	}
+	else
+		RemoveCreateRoomGizmo();
+
+	// Create or remove the room selection bounding box
+	if (Properties->EditMode == EEditMode::ManageRooms)
+		SpawnRoomBoundingBox();
+	else
+		RemoveRoomBoundingBox();
+
+	PrevEditMode = Properties->EditMode;
+
+	CurrentSelectedActorInRoom = { -1, nullptr };
+	SelectedCells.Reset();
+	SelectionAnchor = INDEX_NONE;
+}
+
+void UPRG_PluginRoomTool::SetEditModeMaterial(TObjectPtr<AStaticMeshActor> Actor, TObjectPtr<UMaterial> Material)
+{
+	if (UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent())
+	{
+		for (int i = 0; i < Mesh->GetNumMaterials(); i++)
+			Mesh->SetMaterial(i, Material);
+	}
+}
+
+void UPRG_PluginRoomTool::SetArrayMaterials(TObjectPtr<AStaticMeshActor> Actor, TArray<TObjectPtr<UMaterial>> Materials)
+{
+	if (UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent())
+	{
+		for (int i = 0; i < Mesh->GetNumMaterials(); i++)
+		{
+			// Cells respawned by undo have no stored materials, so fall back to the mesh materials
+			if (!Materials.IsValidIndex(i))
+				Mesh->SetMaterial(i, nullptr);
+			else if (Materials[i])
+				Mesh->SetMaterial(i, Materials[i]);
+			else
+				Mesh->SetMaterial(i, GetLoadedMaterial(Properties->DefaultMat));
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::ResetPersistMaterials(EEditMode EditMode)
+{
+	// Reset materials based on selected mode
+	if (CurrentRoom && !CurrentRoom->IsPendingKill())
+	{
+		if (EditMode == EEditMode::EditWalls)
+		{
+			TArray<TObjectPtr<AWall>>& Walls = CurrentRoom->GetWalls();
+
+			// Check if room was deleted during edit mode
+			if (Walls.Num() != OriginalMaterials.Num())
+				return;
+
+			for (size_t i = 0; i < Walls.Num(); i++)
+			{
+				if (Walls[i])
+				{
+					// Reset original materials
+					SetArrayMaterials(Walls[i], OriginalMaterials[i]);
+				}
+			}
+		}
+		else if (EditMode == EEditMode::EditTiles)
+		{
+			TArray<TObjectPtr<ATile>>& Tiles = CurrentRoom->GetTiles();
+
+			// Check if room was deleted during edit mode
+			if (Tiles.Num() != OriginalMaterials.Num())
+				return;
+
+			for (size_t i = 0; i < Tiles.Num(); i++)
+			{
+				if (Tiles[i])
+				{
+					//  Reset original materials
+					SetArrayMaterials(Tiles[i], OriginalMaterials[i]);
+				}
+			}
+		}
+	}
+}
+
+// ******************************** Cell Selection Functions *****************************************
+
+TObjectPtr<UMaterial> UPRG_PluginRoomTool::GetEditModeMaterial(bool bPersistent, bool bSelected) const
+{
+	if (bPersistent)
+		return GetLoadedMaterial(bSelected ? Properties->PersistSelectedMat : Properties->PersistUnselectedMat);
+	else
+		return GetLoadedMaterial(bSelected ? Properties->TempSelectedMat : Properties->TempUnselectedMat);
+}
+
+void UPRG_PluginRoomTool::RefreshEditModeMaterials()
+{
+	for (int i = 0; i < GetNumEditCells(); i++)
+	{
+		bool bPersistent = false;
+		if (TObjectPtr<AStaticMeshActor> Cell = GetEditCell(i, bPersistent))
+		{
+			const bool bSelected = CurrentSelectedActorInRoom.Value == Cell || (SelectedCells.IsValidIndex(i) && SelectedCells[i]);
+			SetEditModeMaterial(Cell, GetEditModeMaterial(bPersistent, bSelected));
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::RequestDefaultContent()
+{
+	FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+
+	// Meshes are only waited for when a cell is spawned before they are loaded
+	TArray<FSoftObjectPath> MeshPaths = { Properties->DefaultFloorMesh.ToSoftObjectPath(), Properties->DefaultWallMesh.ToSoftObjectPath() };
+	DefaultMeshesHandle = StreamableManager.RequestAsyncLoad(MeshPaths, FStreamableDelegate::CreateUObject(this, &UPRG_PluginRoomTool::ApplyDefaultMeshes));
+
+	// Edit mode materials and room bounds show placeholders until loaded
+	const ARoomBounds* RoomBounds = GetDefault<ARoomBounds>();
+	TArray<FSoftObjectPath> EditContentPaths = {
+		Properties->DefaultMat.ToSoftObjectPath(),
+		Properties->PersistSelectedMat.ToSoftObjectPath(), Properties->PersistUnselectedMat.ToSoftObjectPath(),
+		Properties->TempSelectedMat.ToSoftObjectPath(), Properties->TempUnselectedMat.ToSoftObjectPath(),
+		RoomBounds->CubeMesh.ToSoftObjectPath(), RoomBounds->CubeMaterial.ToSoftObjectPath()
+	};
+	EditContentHandle = StreamableManager.RequestAsyncLoad(EditContentPaths, FStreamableDelegate::CreateUObject(this, &UPRG_PluginRoomTool::OnEditContentLoaded));
+
+	// Content loaded before, e.g. on an earlier tool start, completes immediately
+	if (!DefaultMeshesHandle.IsValid() || DefaultMeshesHandle->HasLoadCompleted())
+		ApplyDefaultMeshes();
+}
+
+void UPRG_PluginRoomTool::WaitForDefaultMeshes()
+{
+	if (DefaultMeshesHandle.IsValid() && DefaultMeshesHandle->IsLoadingInProgress())
+	{
+		DefaultMeshesHandle->WaitUntilComplete();
+		ApplyDefaultMeshes();
+	}
+}
+
+void UPRG_PluginRoomTool::ApplyDefaultMeshes()
+{
+	// Meshes stored in the settings or picked by the user take precedence
+	if (!Properties->FloorMesh)
+		Properties->FloorMesh = Properties->DefaultFloorMesh.Get();
+	if (!Properties->WallMesh)
+		Properties->WallMesh = Properties->DefaultWallMesh.Get();
+
+	// Settings created before the meshes were loaded store them now
+	if (PRGSettings && !PRGSettings->FloorMesh && Properties->FloorMesh)
+	{
+		PRGSettings->FloorMesh = Properties->FloorMesh;
+		ChangeTracker.MarkDirty(PRGSettings);
+	}
+	if (PRGSettings && !PRGSettings->WallMesh && Properties->WallMesh)
+	{
+		PRGSettings->WallMesh = Properties->WallMesh;
+		ChangeTracker.MarkDirty(PRGSettings);
+	}
+}
+
+void UPRG_PluginRoomTool::OnEditContentLoaded()
+{
+	if (Properties->EditMode == EEditMode::EditWalls || Properties->EditMode == EEditMode::EditTiles)
+		RefreshEditModeMaterials();
+
+	// Bounds spawned before the cube was loaded have no mesh
+	if (CurrentBoundingBox)
+	{
+		RemoveRoomBoundingBox();
+		SpawnRoomBoundingBox();
+	}
+}
+
+int UPRG_PluginRoomTool::PickEditCell(const FRay& WorldRay) const
+{
+	if (!CurrentRoom || (Properties->EditMode != EEditMode::EditWalls && Properties->EditMode != EEditMode::EditTiles))
+		return INDEX_NONE;
+
+	// Intersect in room space with the floor for tiles, and halfway up the walls for walls
+	const FTransform RoomTransform = CurrentRoom->GetActorTransform();
+	const FVector Origin = RoomTransform.InverseTransformPosition(WorldRay.Origin);
+	const FVector Direction = RoomTransform.InverseTransformVector(WorldRay.Direction);
+	const bool bWalls = Properties->EditMode == EEditMode::EditWalls;
+	const double PlaneZ = bWalls ? CurrentRoom->GetRoomHeight() * 50.0 : 0.0;
+	if (FMath::IsNearlyZero(Direction.Z))
+		return INDEX_NONE;
+
+	const double Distance = (PlaneZ - Origin.Z) / Direction.Z;
+	if (Distance < 0.0)
+		return INDEX_NONE;
+
+	const FVector Hit = Origin + Direction * Distance;
+	const FPRGGridLayout Grid(CurrentRoom->GetRoomSize(), CurrentRoom->GetTileSizeCM());
+	return bWalls ? Grid.WallIndexAt(Hit) : Grid.TileIndexAt(Hit);
+}
+
+void UPRG_PluginRoomTool::UpdateHoveredCell()
+{
+	bHoverRayChanged = false;
+	HoveredCell = PickEditCell(HoverRay);
+}
+
+void UPRG_PluginRoomTool::RenderOverlaps(IToolsContextRenderAPI* RenderAPI) const
+{
+	// Lambda - Outline tiles of a room in room space
+	auto DrawTiles = [RenderAPI](APRG_Room* Room, const TArray<int32>& TileIndices)
+	{
+		if (!Room)
+			return;
+
+		const FPRGGridLayout Grid(Room->GetRoomSize(), Room->GetTileSizeCM());
+		const FVector Extent = FVector(Grid.HalfTileSize(), Grid.HalfTileSize(), Grid.HalfTileSize() / 10.0);
+		const FMatrix RoomMatrix = Room->GetActorTransform().ToMatrixWithScale();
+		TArray<FVector> Positions;
+		Positions.SetNumUninitialized(TileIndices.Num());
+		Grid.TilePositions(TileIndices, Positions);
+		for (const FVector& Position : Positions)
+		{
+			DrawWireBox(RenderAPI->GetPrimitiveDrawInterface(), RoomMatrix, FBox(Position - Extent, Position + Extent), FLinearColor::Red, SDPG_Foreground, 2.0f);
+		}
+	};
+
+	for (const FPRGRoomOverlap::FOverlap& Overlap : RoomOverlap.GetOverlaps())
+	{
+		DrawTiles(Overlap.RoomA.Get(), Overlap.TilesA);
+		DrawTiles(Overlap.RoomB.Get(), Overlap.TilesB);
+	}
+}
+
+void UPRG_PluginRoomTool::ClearHoveredCell()
+{
+	bHoverRayChanged = false;
+	HoveredCell = INDEX_NONE;
+}
+
+TObjectPtr<AStaticMeshActor> UPRG_PluginRoomTool::GetEditCell(int Index, bool& bOutPersistent)
+{
+	bOutPersistent = false;
+	if (!CurrentRoom)
+		return nullptr;
+
+	if (Properties->EditMode == EEditMode::EditWalls)
+		return FindEditCell(TempWalls, CurrentRoom->GetWalls(), Index, bOutPersistent);
+	else if (Properties->EditMode == EEditMode::EditTiles)
+		return FindEditCell(TempTiles, CurrentRoom->GetTiles(), Index, bOutPersistent);
+
+	return nullptr;
+}
+
+int UPRG_PluginRoomTool::GetNumEditCells() const
+{
+	if (!CurrentRoom)
+		return 0;
+
+	if (Properties->EditMode == EEditMode::EditWalls)
+		return CurrentRoom->GetWalls().Num();
+	else if (Properties->EditMode == EEditMode::EditTiles)
+		return CurrentRoom->GetTiles().Num();
+
+	return 0;
+}
+
+void UPRG_PluginRoomTool::SelectCellsWithShape(int ClickedIndex)
+{
+	TArray<int> Indices;
+
+	switch (Properties->SelectionShape)
+	{
+	// First click sets the anchor, second click selects all cells in between
+	case ESelectionShape::Rectangle:
+	case ESelectionShape::Line:
+		if (SelectionAnchor == INDEX_NONE || SelectionAnchor >= GetNumEditCells())
+		{
+			Indices.Add(ClickedIndex);
+			SelectionAnchor = ClickedIndex;
+		}
+		else
+		{
+			GatherShapeCells(SelectionAnchor, ClickedIndex, Indices);
+			SelectionAnchor = INDEX_NONE;
+		}
+		break;
+
+	case ESelectionShape::FloodFill:
+		GatherFloodFillCells(ClickedIndex, Indices);
+		break;
+
+	default:
+		Indices.Add(ClickedIndex);
+		break;
+	}
+
+	SetCellSelection(Indices);
+}
+
+void UPRG_PluginRoomTool::GatherShapeCells(int FromIndex, int ToIndex, TArray<int>& OutIndices) const
+{
+	if (!CurrentRoom)
+		return;
+
+	const FIntPoint Size = CurrentRoom->GetRoomSize();
+	const bool bWalls = Properties->EditMode == EEditMode::EditWalls;
+
+	// Lambda - Cell position in half tiles, so walls and tiles both land on whole numbers
+	auto GetGridPos = [&](int Index)
+	{
+		return bWalls ? FPRGRoomCells::GetWallPosition(Size, Index, 2) : FPRGRoomCells::GetTilePosition(Size, Index, 2);
+	};
+
+	const FVector From = GetGridPos(FromIndex);
+	const FVector To = GetGridPos(ToIndex);
+	const FVector Min = From.ComponentMin(To);
+	const FVector Max = From.ComponentMax(To);
+
+	const int NumCells = GetNumEditCells();
+	for (int i = 0; i < NumCells; i++)
+	{
+		const FVector Pos = GetGridPos(i);
+		if (Pos.X < Min.X || Pos.Y < Min.Y || Pos.X > Max.X || Pos.Y > Max.Y)
+			continue;
+
+		// Lines keep cells within half a tile of the line between both cells
+		if (Properties->SelectionShape == ESelectionShape::Line && FMath::PointDistToSegment(Pos, From, To) > 1.0f + KINDA_SMALL_NUMBER)
+			continue;
+
+		OutIndices.Add(i);
+	}
+}
+
+void UPRG_PluginRoomTool::GatherFloodFillCells(int SeedIndex, TArray<int>& OutIndices)
+{
+	bool bSeedPersistent = false;
+	TObjectPtr<AStaticMeshActor> SeedCell = GetEditCell(SeedIndex, bSeedPersistent);
+	if (!SeedCell || !SeedCell->GetStaticMeshComponent())
+		return;
+
+	const FIntPoint Size = CurrentRoom->GetRoomSize();
+	const bool bWalls = Properties->EditMode == EEditMode::EditWalls;
+	const UStaticMesh* SeedMesh = SeedCell->GetStaticMeshComponent()->GetStaticMesh();
+
+	TBitArray<> Visited(false, GetNumEditCells());
+	TArray<int> Pending = { SeedIndex };
+	TArray<int> Neighbours;
+	Visited[SeedIndex] = true;
+
+	while (Pending.Num() > 0)
+	{
+		const int Index = Pending.Pop(false);
+		OutIndices.Add(Index);
+
+		if (bWalls)
+			FPRGRoomCells::GetWallNeighbours(Size, Index, Neighbours);
+		else
+			FPRGRoomCells::GetTileNeighbours(Size, Index, Neighbours);
+
+		for (int Neighbour : Neighbours)
+		{
+			if (!Visited.IsValidIndex(Neighbour) || Visited[Neighbour])
+				continue;
+			Visited[Neighbour] = true;
+
+			// Spread to cells in the same state with the same mesh
+			bool bPersistent = false;
+			TObjectPtr<AStaticMeshActor> Cell = GetEditCell(Neighbour, bPersistent);
+			if (Cell && Cell->GetStaticMeshComponent() && bPersistent == bSeedPersistent && Cell->GetStaticMeshComponent()->GetStaticMesh() == SeedMesh)
+				Pending.Add(Neighbour);
+		}
+	}
+}
+
+void UPRG_PluginRoomTool::SetCellSelection(const TArray<int>& Indices)
+{
+	const int NumCells = GetNumEditCells();
+
+	TBitArray<> NewSelection(false, NumCells);
+	for (int Index : Indices)
+	{
+		if (NewSelection.IsValidIndex(Index))
+			NewSelection[Index] = true;
+	}
+
+	// Cells changed since the last selection, e.g. by a resize or undo
+	if (SelectedCells.Num() != NumCells)
+		SelectedCells.Init(false, NumCells);
+
+	// Only touch materials of cells whose selection changed
+	for (int i = 0; i < NumCells; i++)
+	{
+		if (SelectedCells[i] == NewSelection[i])
+			continue;
+
+		bool bPersistent = false;
+		if (TObjectPtr<AStaticMeshActor> Cell = GetEditCell(i, bPersistent))
+			SetEditModeMaterial(Cell, GetEditModeMaterial(bPersistent, NewSelection[i]));
+	}
+
+	SelectedCells = MoveTemp(NewSelection);
+}
+
+void UPRG_PluginRoomTool::ClearCellSelection()
+{
+	if (HasCellSelection())
+		SetCellSelection(TArray<int>());
+
+	SelectedCells.Reset();
+	SelectionAnchor = INDEX_NONE;
+}
+
+bool UPRG_PluginRoomTool::HasCellSelection() const
+{
+	return SelectedCells.Num() > 0 && SelectedCells.Num() == GetNumEditCells() && SelectedCells.Find(true) != INDEX_NONE;
+}
+
+void UPRG_PluginRoomTool::ToggleSelectedCells()
+{
+	if (!HasCellSelection() || !CanEditRoomCells(CurrentRoom))
+		return;
+
+	FPRGScopedCellChange CellChange(GetToolManager(), CurrentRoom, LOCTEXT("ToggleCells", "Toggle Room Cells"));
+
+	for (TConstSetBitIterator<> It(SelectedCells); It; ++It)
+	{
+		const int Index = It.GetIndex();
+		if (Properties->EditMode == EEditMode::EditWalls)
+			ToggleEditCell(TempWalls, CurrentRoom->GetWalls(), Index);
+		else
+			ToggleEditCell(TempTiles, CurrentRoom->GetTiles(), Index);
+
+		bool bPersistent = false;
+		if (TObjectPtr<AStaticMeshActor> Cell = GetEditCell(Index, bPersistent))
+			SetEditModeMaterial(Cell, GetEditModeMaterial(bPersistent, true));
+	}
+
+	// Update room occupancy and rendering once for the whole selection
+	CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void UPRG_PluginRoomTool::ApplyMeshToSelectedCells(UStaticMesh* Mesh)
+{
+	if (!Mesh || !HasCellSelection())
+		return;
+
+	// Only persistent actors are part of the room, so only record the change if the selection holds any
+	bool bAnyPersistent = false;
+	for (TConstSetBitIterator<> It(SelectedCells); It && !bAnyPersistent; ++It)
+		GetEditCell(It.GetIndex(), bAnyPersistent);
+
+	FPRGScopedCellChange CellChange(GetToolManager(), bAnyPersistent ? CurrentRoom.Get() : nullptr, LOCTEXT("SetCellMeshes", "Set Room Cell Meshes"));
+
+	// Original materials of the new mesh are the same for every cell
+	TArray<TObjectPtr<UMaterial>> MeshMaterials;
+	for (const FStaticMaterial& StaticMaterial : Mesh->GetStaticMaterials())
+		MeshMaterials.Add(StaticMaterial.MaterialInterface ? StaticMaterial.MaterialInterface->GetMaterial() : nullptr);
+
+	for (TConstSetBitIterator<> It(SelectedCells); It; ++It)
+	{
+		bool bPersistent = false;
+		TObjectPtr<AStaticMeshActor> Cell = GetEditCell(It.GetIndex(), bPersistent);
+		if (!Cell || !Cell->GetStaticMeshComponent())
+			continue;
+
+		Cell->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+		if (OriginalMaterials.IsValidIndex(It.GetIndex()))
+			OriginalMaterials[It.GetIndex()] = MeshMaterials;
+		SetEditModeMaterial(Cell, GetEditModeMaterial(bPersistent, true));
+	}
+
+	if (bAnyPersistent)
+		CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+}
+
+void UPRG_PluginRoomTool::ApplyWallTypeToSelectedWalls(EPRGWallType Type)
+{
+	if (Properties->EditMode != EEditMode::EditWalls || !HasCellSelection() || !CanEditRoomCells(CurrentRoom))
+		return;
+
+	{
+		FPRGScopedCellChange CellChange(GetToolManager(), CurrentRoom, LOCTEXT("SetWallTypes", "Set Room Wall Types"));
+
+		// Set contiguous selected walls as one range
+		WaitForDefaultMeshes();
+		int32 First = INDEX_NONE;
+		int32 Last = INDEX_NONE;
+		for (TConstSetBitIterator<> It(SelectedCells); It; ++It)
+		{
+			if (It.GetIndex() != Last + 1 && First != INDEX_NONE)
+			{
+				CurrentRoom->SetWallTypes(First, Last - First + 1, Type, Properties->WallMesh);
+				First = INDEX_NONE;
+			}
+			if (First == INDEX_NONE)
+				First = It.GetIndex();
+			Last = It.GetIndex();
+		}
+		if (First != INDEX_NONE)
+			CurrentRoom->SetWallTypes(First, Last - First + 1, Type, Properties->WallMesh);
+
+		CurrentRoom->NotifyRoomChanged(ERoomChange::Cells);
+	}
+
+	// Temporary walls follow the new set of empty slots
+	ResetRoomEditMode(EEditMode::EditWalls);
+	SetRoomEditMode();
+}
+
+// ***************************************************************************************************
+// ******************************** PRIVATE FUNCTIONS ************************************************
+// ***************************************************************************************************
+
+// ********************************* Spawn Objects Functions *****************************************
+
+TObjectPtr<ATile> UPRG_PluginRoomTool::SpawnTile(APRG_Room& ParentRoom, int IndexInRoom, FVector SpawnPos)
+{
+	// INFO: IndexInRoom is added to allow passing functor as template argument for SpawnTile / SpawnWall
+	WaitForDefaultMeshes();
+	return ParentRoom.SpawnTile(SpawnPos, Properties->FloorMesh);
+}
+
+TObjectPtr<AWall> UPRG_PluginRoomTool::SpawnWall(APRG_Room& ParentRoom, int IndexInRoom, FVector SpawnPos)
+{
+	return SpawnWallRot(ParentRoom, SpawnPos, ParentRoom.GetWallRotationByIndex(IndexInRoom));
+}
+
+TObjectPtr<AWall> UPRG_PluginRoomTool::SpawnWallRot(APRG_Room& ParentRoom, FVector SpawnPos, FRotator SpawnRot)
+{
+	WaitForDefaultMeshes();
+	return ParentRoom.SpawnWall(SpawnPos, SpawnRot, Properties->WallMesh);
+}
+
+// ********************************** Boundingbox Functions ******************************************
+
+void UPRG_PluginRoomTool::SpawnRoomBoundingBox()
+{
+	// Check if already added
+	if (CurrentBoundingBox && CurrentBoundingBox->GetAttachParentActor() == CurrentRoom)
+		return;
+
+	if (auto ActiveRoom = TryGetCurrentRoom())
+	{
+		// Get room size. Has XY in tiles, so convert these to meters
+		FVector RoomSize = FVector(ActiveRoom->GetRoomSize());
+		RoomSize.X *= Properties->TileSize;
+		RoomSize.Y *= Properties->TileSize;
+		RoomSize.Z = ActiveRoom->GetRoomHeight();
+		FVector SpawnScale = RoomSize + 0.1f;
+		FVector CenterOffset = RoomSize * 50.0f; // M to CM, divided by 2 for center
+
+		FTransform SpawnTransform = FTransform(FRotator(0.0f, 0.0f, 0.0f), CenterOffset, SpawnScale);
+		FActorSpawnParameters SpawnInfoTile;
+		TObjectPtr<ARoomBounds> NewActor = TargetWorld->SpawnActor<ARoomBounds>(ARoomBounds::StaticClass(), SpawnTransform, SpawnInfoTile);
+		NewActor->AttachToActor(ActiveRoom, FAttachmentTransformRules::KeepRelativeTransform);
+
+		// Both are loaded when the tool starts. Until then, the bounds are respawned once loading finished
+		NewActor->GetStaticMeshComponent()->SetStaticMesh(NewActor->CubeMesh.Get());
+		SetEditModeMaterial(NewActor, GetLoadedMaterial(NewActor->CubeMaterial));
+
+		CurrentBoundingBox = NewActor;
+	}
+}
+
+void UPRG_PluginRoomTool::RemoveRoomBoundingBox()
+{
+	if (CurrentBoundingBox)
+	{
+		TargetWorld->DestroyActor(CurrentBoundingBox);
+		CurrentBoundingBox = nullptr;
+	}
+}
+
+void UPRG_PluginRoomTool::SpawnCreateRoomGizmo()
+{
+	// Check if valid mode and whether gizmo already exists
+	if (Properties->EditMode == EEditMode::CreateRooms && !SpawnGizmo)
+	{
+		SpawnProxy = NewObject<UTransformProxy>(this);
+		SpawnProxy->SetTransform(FTransform(Properties->SpawnPosition));
+		SpawnGizmo = UE::TransformGizmoUtil::CreateCustomTransformGizmo(GetToolManager()->GetPairedGizmoManager(),
+			ETransformGizmoSubElements::TranslateAllAxes | ETransformGizmoSubElements::TranslateAllPlanes, this);
+		SpawnGizmo->SetActiveTarget(SpawnProxy, GetToolManager());
+
+		// Listen for changes to the proxy and update the gizmo when that happens
+		SpawnProxy->OnTransformChanged.AddUObject(this, &UPRG_PluginRoomTool::GizmoTransformChanged);
+		SpawnProxy->OnBeginTransformEdit.AddUObject(this, &UPRG_PluginRoomTool::GizmoTransformStarted);
+		SpawnProxy->OnEndTransformEdit.AddUObject(this, &UPRG_PluginRoomTool::GizmoTransformEnded);
+	}
+}
+
+void UPRG_PluginRoomTool::UpdateCreateRoomGizmo(FVector NewPos)
+{
+	if (Properties->EditMode == EEditMode::CreateRooms && SpawnGizmo)
+	{
+		SpawnGizmo->SetNewGizmoTransform(FTransform(Properties->SpawnPosition));
+	}
+}
+
+void UPRG_PluginRoomTool::RemoveCreateRoomGizmo()
+{
+	if (SpawnGizmo)
+	{
+		GetToolManager()->GetPairedGizmoManager()->DestroyGizmo(SpawnGizmo);
+		SpawnGizmo = nullptr;
+		SpawnProxy->OnTransformChanged.RemoveAll(this);
+		SpawnProxy->OnBeginTransformEdit.RemoveAll(this);
+		SpawnProxy->OnEndTransformEdit.RemoveAll(this);
+		SpawnProxy = nullptr;
+	}
+}
+
+// ************************************* Other Functions *********************************************
+
+void UPRG_PluginRoomTool::ResetToolState()
+{
+	CurrentSelectedActorInRoom = { -1, nullptr };
+	SelectedCells.Reset();
+	SelectionAnchor = INDEX_NONE;
+	PrevEditMode = EEditMode::CreateRooms;
+	CurrentRoom = nullptr;
+	RoomArraySize = 0;
+	RemoveRoomBoundingBox();
+	DeleteTempActors();
+
+	// Clear stored materials
+	for (auto& OrginalMatArray : OriginalMaterials)
+		OrginalMatArray.Empty();
+	OriginalMaterials.Empty();
+}
+
+#undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,742 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UObject/NoExportTypes.h"
+#include "InteractiveToolBuilder.h"
+#include "BaseTools/SingleClickTool.h"
+#include "BaseBehaviors/BehaviorTargetInterfaces.h"
+#include "GameFramework/Actor.h"
+#include "EditorUndoClient.h"
+#include <PRG_Room.h>
+#include "PRG_Settings.h"
+#include "PRG_RoomCellsChange.h"
+#include "PRG_ChangeTracker.h"
+#include "PRG_RoomOverlap.h"
+
+#include "PRG_PluginRoomTool.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPRGTool, Log, All);
+
+class UCombinedTransformGizmo;
+class UInteractiveGizmo;
+class UTransformProxy;
+class APRG_Settings;
+class UPRG_RoomLayout;
+struct FStreamableHandle;
+
+UENUM()
+enum class EEditMode : uint8
+{
+	CreateRooms,	// View content without any overlays.
+	ManageRooms,	// Manage Rooms. OnClick sets the spawn point for new rooms
+	EditWalls,		// Allow changing of walls in rooms. OnClick highlights selected.
+	EditTiles			// Allow changing of tiles in rooms. OnClick highlights selected.
+};
+
+UENUM()
+enum class ESelectionShape : uint8
+{
+	Single,		// Select one cell per click. Clicking the selected cell toggles it
+	Rectangle,	// Select all cells in the rectangle between two clicked cells
+	Line,		// Select all cells on the line between two clicked cells
+	FloodFill	// Select all connected cells with the same state and mesh as the clicked cell
+};
+
+UENUM()
+enum class EMeshReplaceScope : uint8
+{
+	CurrentRoom,	// Only the selected room
+	SelectedRooms,	// Rooms selected in the level, or owning a selected wall or tile
+	AllRooms		// All rooms managed by the tool
+};
+
+UENUM()
+enum class EIsolateMode : uint8
+{
+	Off,						// Show all rooms
+	Cutaway,				// Hide rooms with their floor at or above the cutaway height
+	SelectedRooms		// Hide rooms that were not selected when isolating
+};
+
+UCLASS()
+class PRG_PLUGINEDITOR_API ARoomBounds : public AStaticMeshActor
+{
+	GENERATED_BODY()
+
+public:
+	ARoomBounds();
+
+	// Loaded by the tool when it starts, not when the class is constructed
+	TSoftObjectPtr<UStaticMesh> CubeMesh;
+	TSoftObjectPtr<UMaterial> CubeMaterial;
+};
+
+/**
+ * Builder for UPRG_PluginRoomTool
+ */
+UCLASS()
+class PRG_PLUGINEDITOR_API UPRG_PluginRoomToolBuilder : public UInteractiveToolWithToolTargetsBuilder
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool CanBuildTool(const FToolBuilderState& SceneState) const override { return true; }
+	virtual UInteractiveTool* BuildTool(const FToolBuilderState& SceneState) const override;
+
+protected:
+	virtual const FToolTargetTypeRequirements& GetTargetRequirements() const override;
+};
+
+/**
+ * Settings UObject for UPRG_PluginRoomTool. This UClass inherits from UInteractiveToolPropertySet,
+ * which provides an OnModified delegate that the Tool will listen to for changes in property values.
+ */
+UCLASS(Transient)
+class PRG_PLUGINEDITOR_API UPRG_PluginRoomToolProperties : public UInteractiveToolPropertySet
+{
+	GENERATED_BODY()
+
+public:
+	UPRG_PluginRoomToolProperties();
+
+#if WITH_EDITOR
+	// Report edits of struct members, e.g. X of RoomSize, as edits of the tool property holding them
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Select editing mode
+	UPROPERTY(EditAnywhere, Category = "Options", meta = (DisplayName = "Edit mode"))
+	EEditMode EditMode;
+	// Snap rooms to the selected intervals
+	UPROPERTY(EditAnywhere, Category = "Options", meta = (DisplayName = "Position snapping (cm)"))
+	EPosSnap PositionSnap;
+	// Snap rooms to the selected rotations
+	UPROPERTY(EditAnywhere, Category = "Options", meta = (DisplayName = "Rotation snapping (deg)"))
+	ERotSnap RotationSnap;
+	// Toggle visibility of room gizmo's
+	UPROPERTY(EditAnywhere, Category = "Options", meta = (DisplayName = "Show All Gizmos"))
+	bool ShowAllGizmos;
+	// Reset the floor of a room
+	UPROPERTY(EditAnywhere, Category = "Options|Reset/Clear Floor", meta = (DisplayName = "Reset Floor", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ResetRoomFloor;
+	// Reset the floor of a room
+	UPROPERTY(EditAnywhere, Category = "Options|Reset/Clear Floor", meta = (DisplayName = "Clear Floor", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ClearRoomFloor;
+	// Reset the walls of a room
+	UPROPERTY(EditAnywhere, Category = "Options|Reset/Clear Walls", meta = (DisplayName = "Reset Walls", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ResetRoomWalls;
+	// Reset the walls of a room
+	UPROPERTY(EditAnywhere, Category = "Options|Reset/Clear Walls", meta = (DisplayName = "Clear Walls", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ClearRoomWalls;
+
+	// Stack a new level on top of the building of the selected room. A room outside a building becomes the ground level of a new building
+	UPROPERTY(EditAnywhere, Category = "Options|Building", meta = (DisplayName = "Add Level", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool AddBuildingLevel;
+
+	// Rooms changed by Replace Walls and Replace Floor
+	UPROPERTY(EditAnywhere, Category = "Options|Replace Meshes", meta = (DisplayName = "Rooms", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	EMeshReplaceScope ReplaceScope;
+	// Only replace cells using this mesh. Replaces all cells when empty
+	UPROPERTY(EditAnywhere, Category = "Options|Replace Meshes", meta = (DisplayName = "Only Replace Mesh", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	TObjectPtr<UStaticMesh> ReplaceFromMesh;
+	// Set the Wall Object on all matching walls, keeping the wall actors
+	UPROPERTY(EditAnywhere, Category = "Options|Replace Meshes", meta = (DisplayName = "Replace Walls", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ReplaceWalls;
+	// Set the Floor Object on all matching tiles, keeping the tile actors
+	UPROPERTY(EditAnywhere, Category = "Options|Replace Meshes", meta = (DisplayName = "Replace Floor", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ReplaceFloor;
+
+	// Hide rooms in the editor viewport to work inside buildings or dense interiors. The selected room always stays visible
+	UPROPERTY(EditAnywhere, Category = "Options|Isolate", meta = (DisplayName = "Isolate Mode"))
+	EIsolateMode IsolateMode;
+	// World height of the cut in Cutaway mode, in meters
+	UPROPERTY(EditAnywhere, Category = "Options|Isolate", meta = (DisplayName = "Cutaway height(m)", UIMin = "0", UIMax = "100", EditCondition = "IsolateMode == EIsolateMode::Cutaway"))
+	int CutawayHeight;
+	// Hide all rooms except the rooms currently selected in the level
+	UPROPERTY(EditAnywhere, Category = "Options|Isolate", meta = (DisplayName = "Isolate Selected"))
+	bool IsolateSelection;
+
+	// Shape used to select walls or tiles. Rectangle and Line select the cells between two clicks
+	UPROPERTY(EditAnywhere, Category = "Options|Selection", meta = (DisplayName = "Selection Shape", EditCondition = "EditMode == EEditMode::EditWalls || EditMode == EEditMode::EditTiles"))
+	ESelectionShape SelectionShape;
+	// Toggle all selected cells between persistent and temporary
+	UPROPERTY(EditAnywhere, Category = "Options|Selection", meta = (DisplayName = "Toggle Selected", EditCondition = "EditMode == EEditMode::EditWalls || EditMode == EEditMode::EditTiles"))
+	bool ToggleSelection;
+	// Deselect all selected cells
+	UPROPERTY(EditAnywhere, Category = "Options|Selection", meta = (DisplayName = "Clear Selection", EditCondition = "EditMode == EEditMode::EditWalls || EditMode == EEditMode::EditTiles"))
+	bool ClearSelection;
+
+	// Type given to the selected walls. Doors and windows are drawn instanced by the room, solid walls use the wall object
+	UPROPERTY(EditAnywhere, Category = "Options|Wall Type", meta = (DisplayName = "Wall Type", EditCondition = "EditMode == EEditMode::EditWalls"))
+	EPRGWallType WallType;
+	// Set the type of all selected walls
+	UPROPERTY(EditAnywhere, Category = "Options|Wall Type", meta = (DisplayName = "Apply Wall Type", EditCondition = "EditMode == EEditMode::EditWalls"))
+	bool ApplyWallType;
+
+	// Give cells using the default or no mesh the current floor and wall objects, in every room whose cells or defaults changed since it was last built
+	UPROPERTY(EditAnywhere, Category = "Options|Rebuild", meta = (DisplayName = "Rebuild All Rooms", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool RebuildAllRooms;
+
+	// Check cell arrays and gizmos of all rooms, repairing what can be repaired. Results are logged
+	UPROPERTY(EditAnywhere, Category = "Options|Validation", meta = (DisplayName = "Validate Rooms", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ValidateRooms;
+
+	// Log actors, instances, meshes, triangles, collision bodies and cell data of all rooms, and write them as CSV to Saved/PRG
+	UPROPERTY(EditAnywhere, Category = "Options|Cost Report", meta = (DisplayName = "Report Room Cost", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool CostReport;
+
+	// Shared layout used by the layout actions below, and by new rooms if Spawn With Layout is set
+	UPROPERTY(EditAnywhere, Category = "Options|Shared Layout", meta = (DisplayName = "Layout Asset", EditCondition = "EditMode == EEditMode::CreateRooms || EditMode == EEditMode::ManageRooms"))
+	TObjectPtr<UPRG_RoomLayout> RoomLayout;
+	// Create new rooms from the layout asset instead of default walls and tiles
+	UPROPERTY(EditAnywhere, Category = "Options|Shared Layout", meta = (DisplayName = "Spawn With Layout", EditCondition = "EditMode == EEditMode::CreateRooms"))
+	bool SpawnWithLayout;
+	// Store the cells of the selected room in the layout asset, creating one if none is set. The room then uses the layout
+	UPROPERTY(EditAnywhere, Category = "Options|Shared Layout", meta = (DisplayName = "Store Layout", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool StoreLayout;
+	// Replace the cells of the selected room by the layout asset
+	UPROPERTY(EditAnywhere, Category = "Options|Shared Layout", meta = (DisplayName = "Apply Layout", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool ApplyLayout;
+	// Spawn walls and tiles for the layout of the selected room, so it can be edited on its own
+	UPROPERTY(EditAnywhere, Category = "Options|Shared Layout", meta = (DisplayName = "Unpack Layout", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	bool UnpackLayout;
+
+	// Layout file used to export and import rooms
+	UPROPERTY(EditAnywhere, Category = "Options|Layout File", meta = (DisplayName = "Layout File", FilePathFilter = "prglayout"))
+	FFilePath LayoutFile;
+	// Write all rooms to the layout file
+	UPROPERTY(EditAnywhere, Category = "Options|Layout File", meta = (DisplayName = "Export Layout"))
+	bool ExportLayout;
+	// Spawn all rooms stored in the layout file
+	UPROPERTY(EditAnywhere, Category = "Options|Layout File", meta = (DisplayName = "Import Layout", EditCondition = "EditMode == EEditMode::CreateRooms"))
+	bool ImportLayout;
+
+	// Initial room size on spawn
+	UPROPERTY(EditAnywhere, Category = "Data", meta = (DisplayName = "Room tiles", NoResetToDefault, ClampMin = "1", ClampMax = "50", UIMin = "1", UIMax = "50", EditCondition = "EditMode == EEditMode::CreateRooms || EditMode == EEditMode::ManageRooms"))
+	FIntPoint RoomSize;
+	// Set scale of room gizmo's
+	/*UPROPERTY(EditAnywhere, Category = Data, meta = (DisplayName = "Gizmos Scale", ClampMin = "0.05", ClampMax = "2.0", UIMin = "0.05", UIMax = "2.0"))
+	float GizmoScale;*/
+	// Coordinates of where a new room will be spawned
+	UPROPERTY(EditAnywhere, Category = "Data|Spawn Room", meta = (DisplayName = "Spawn Position", EditCondition = "EditMode == EEditMode::CreateRooms"))
+	FVector SpawnPosition;
+	// Room height used for displaying the room selection box
+	UPROPERTY(EditAnywhere, Category = "Data|Spawn Room", meta = (DisplayName = "Room height(m)", ClampMin = "1", ClampMax = "20", UIMin = "1", UIMax = "20", EditCondition = "EditMode == EEditMode::CreateRooms"))
+	int InitHeight;
+	// Size of each tile
+	UPROPERTY(EditAnywhere, Category = "Data|Spawn Room", meta = (DisplayName = "Tile size (m)", ClampMin = "1", ClampMax = "100", UIMin = "1", UIMax = "10", EditCondition = "EditMode == EEditMode::CreateRooms"))
+	int TileSize;
+	// Mesh used to spawn new tiles with when spawning a new room
+	UPROPERTY(EditAnywhere, Category = "Data|Objects", meta = (DisplayName = "Floor Object", EditCondition = "EditMode == EEditMode::CreateRooms || EditMode == EEditMode::ManageRooms || EditMode == EEditMode::EditTiles"))
+	TObjectPtr<UStaticMesh> FloorMesh;
+	// Mesh used to spawn new walls with when spawning a new room
+	UPROPERTY(EditAnywhere, Category = "Data|Objects", meta = (DisplayName = "Wall Object", EditCondition = "EditMode == EEditMode::CreateRooms || EditMode == EEditMode::ManageRooms || EditMode == EEditMode::EditWalls"))
+	TObjectPtr<UStaticMesh> WallMesh;
+
+	// Provide option to select a room from the scene
+	UPROPERTY(EditAnywhere, Category = Overview, meta = (DisplayName = "Selected Room", GetOptions = "GetRoomSelection", EditCondition = "EditMode == EEditMode::ManageRooms"))
+	TObjectPtr<APRG_Room> RoomSelection;
+	// Overview of all room actors in the scene
+	UPROPERTY(EditAnywhere, Category = Overview, meta = (DisplayName = "Rooms", NoElementDuplicate, OnlyPlaceable, EditCondition = "EditMode == EEditMode::CreateRooms", EditFixedOrder), NoClear)
+	TArray<TObjectPtr<APRG_Room>> RoomArray;
+
+	// Floor and wall mesh used when neither the settings nor the user set one. Loaded asynchronously when the tool starts
+	TSoftObjectPtr<UStaticMesh> DefaultFloorMesh;
+	TSoftObjectPtr<UStaticMesh> DefaultWallMesh;
+
+	// Default material used to revert to after edit mode
+	TSoftObjectPtr<UMaterial> DefaultMat;
+	// Material shown for persistent room objects when selected in edit mode
+	UPROPERTY(EditAnywhere, Category = Materials, meta = (DisplayName = "Persistent selected"))
+	TSoftObjectPtr<UMaterial> PersistSelectedMat;
+	// Material shown for persistent room objects when not selected in edit mode
+	UPROPERTY(EditAnywhere, Category = Materials, meta = (DisplayName = "Persistent unselected"))
+	TSoftObjectPtr<UMaterial> PersistUnselectedMat;
+	// Material shown for temporary room objects when selected in edit mode
+	UPROPERTY(EditAnywhere, Category = Materials, meta = (DisplayName = "Temporary selected"))
+	TSoftObjectPtr<UMaterial> TempSelectedMat;
+	// Material shown for temporary room objects when not selected in edit mode
+	UPROPERTY(EditAnywhere, Category = Materials, meta = (DisplayName = "Temporary unselected"))
+	TSoftObjectPtr<UMaterial> TempUnselectedMat;
+
+	UFUNCTION()
+	TArray<APRG_Room*> GetRoomSelection() const
+	{
+		return RoomArray;
+	}
+};
+
+/**
+ * UPRG_PluginRoomTool is an Tool that allows the user to create and manage procedurally created rooms
+ * Functionality changes depending on the selected edit mode
+ */
+UCLASS()
+class PRG_PLUGINEDITOR_API UPRG_PluginRoomTool : public USingleClickTool, public IHoverBehaviorTarget, public FEditorUndoClient
+{
+	GENERATED_BODY()
+
+public:
+	UPRG_PluginRoomTool();
+
+	virtual void SetWorld(UWorld* World);
+
+	// Setup tool data
+	virtual void Setup() override;
+	// Clean up tool data
+	virtual void Shutdown(EToolShutdownType ShutdownType) override;
+
+	virtual void OnTick(float DeltaTime) override;
+	virtual void Render(IToolsContextRenderAPI* RenderAPI) override;
+
+	// Handle changes to properties of the tool
+	virtual void OnPropertyModified(UObject* PropertySet, FProperty* Property);
+	
+	// Handle OnClick events in the scene
+	virtual void OnClicked(const FInputDeviceRay& ClickPos);
+
+	// Hover cells of the current room in EditWalls and EditTiles. The ray is only stored, picking happens once per tick
+	virtual FInputRayHit BeginHoverSequenceHitTest(const FInputDeviceRay& PressPos) override;
+	virtual void OnBeginHover(const FInputDeviceRay& DevicePos) override;
+	virtual bool OnUpdateHover(const FInputDeviceRay& DevicePos) override;
+	virtual void OnEndHover() override;
+
+	// Resync rooms after undo/redo, which can create or remove rooms behind the tool's back
+	virtual void PostUndo(bool bSuccess) override;
+	virtual void PostRedo(bool bSuccess) override;
+
+protected:
+	// Try to get the current or first room available
+	TObjectPtr<APRG_Room> TryGetCurrentRoom();
+	// Set current room and UI info
+	void SetCurrentRoom(TObjectPtr<APRG_Room> setRoom);
+	// Find any room objects in the scene and add them to the tool
+	void FindRoomsInScene();
+	// Create and store a new room
+	void SpawnRoom();
+	// Set room to have all floor tiles filled
+	void SetRoomFloorDefault(TObjectPtr<APRG_Room> SetRoom);
+	// Set room to have only exterior walls
+	void SetRoomWallsDefault(TObjectPtr<APRG_Room> SetRoom);
+	// Set room to have all floor tiles filled
+	void ClearRoomFloor(TObjectPtr<APRG_Room> SetRoom);
+	// Set room to have only exterior walls
+	void ClearRoomWalls(TObjectPtr<APRG_Room> SetRoom);
+	// Fill all floor tiles of an existing room, reusing tile actors
+	void ResetRoomFloor(TObjectPtr<APRG_Room> SetRoom);
+	// Keep only exterior walls of an existing room, reusing wall actors
+	void ResetRoomWalls(TObjectPtr<APRG_Room> SetRoom);
+	// Spawn a room on top of the building of the given room, creating the building if needed
+	void AddBuildingLevel(TObjectPtr<APRG_Room> BaseRoom);
+	// Swap the meshes of matching walls or tiles in all rooms of the replace scope
+	void ReplaceRoomMeshes(bool bWalls);
+	// Get the rooms affected by the replace scope
+	void GatherReplaceRooms(TArray<TObjectPtr<APRG_Room>>& OutRooms);
+	// Get rooms selected in the level, or owning a selected wall or tile
+	void GatherSelectedRooms(TArray<TObjectPtr<APRG_Room>>& OutRooms);
+	// Show or hide all rooms for the IsolateMode, capturing the selected rooms when isolating them
+	void ApplyIsolation();
+	// Show or hide a single room for the IsolateMode
+	void ApplyRoomIsolation(TObjectPtr<APRG_Room> SetRoom);
+	// Show all rooms hidden by the IsolateMode
+	void ClearIsolation();
+	// Setup room found in the scene
+	void SetupFoundRoom(TObjectPtr<APRG_Room> addRoom);
+	// Register an existing room with the tool, binding its delegate and creating its gizmo
+	void RegisterRoom(TObjectPtr<APRG_Room> AddRoom);
+	// Remove a room from the tool without destroying it, e.g. when it is unloaded or removed by undo
+	void ReleaseRoom(TObjectPtr<APRG_Room> ReleasedRoom);
+	// Match registered rooms with the rooms in the world and rebuild edit state of the current room
+	void ResyncRooms();
+	// Regenerate the cells of all rooms whose regeneration hash changed, using the current floor and wall objects as defaults
+	void RebuildAllRooms();
+	// Validate and repair cell arrays and gizmos of all rooms, logging problems and time spent
+	void ValidateRooms();
+	// Create gizmo for a room that lost it, e.g. when it was restored by undo
+	void EnsureRoomGizmo(TObjectPtr<APRG_Room> SetRoom);
+	// Handle actors loaded by World Partition or level streaming while the tool is active
+	void OnLoadedActorAdded(AActor& Actor);
+	// Handle actors unloaded by World Partition or level streaming while the tool is active
+	void OnLoadedActorRemoved(AActor& Actor);
+	// Set up rooms loaded since the last tick, once all their cells had a chance to load
+	void SetupLoadedRooms();
+	// Write all rooms to the layout file
+	void ExportLayoutFile();
+	// Spawn all rooms from the layout file, streaming records in chunks
+	void ImportLayoutFile();
+	// Store the cells of a room in the layout asset and make the room use it
+	void StoreRoomLayout(TObjectPtr<APRG_Room> SetRoom);
+	// Spawn cell actors from the layout of a room and detach it from the layout
+	void UnpackRoomLayout(TObjectPtr<APRG_Room> SetRoom);
+	// Create a new layout asset in the project content folder
+	UPRG_RoomLayout* CreateLayoutAsset(const FString& BaseName);
+	// Check whether a room can be edited cell by cell. Logs a warning if not
+	bool CanEditRoomCells(TObjectPtr<APRG_Room> SetRoom) const;
+	// Change the size of the current room
+	void ResizeRoom();
+	// Handle deleting a room in the scene
+	void DeleteRoomInScene(TObjectPtr<APRG_Room> DeletedRoom);
+	// Delete a room from the tool and scene
+	void DeleteRoom(TObjectPtr<APRG_Room> removeRoom);
+	// Delete any temporary actors used for editing walls and floors
+	void DeleteTempActors();
+
+	// Create a room gizmo
+	void CreateCustomRoomGizmo(TObjectPtr<APRG_Room> room, bool loadTransform);
+	// Handle when a gizmo is moved. Listens to OnTransformChanged on TransformProxy
+	void GizmoTransformChanged(UTransformProxy* Proxy, FTransform Transform);
+	// Start coalescing dirty packages when a gizmo drag starts
+	void GizmoTransformStarted(UTransformProxy* Proxy);
+	// Mark packages changed by a gizmo drag dirty once the drag ends
+	void GizmoTransformEnded(UTransformProxy* Proxy);
+	// Toggle visibility of room gizmo's
+	//void SetGizmoScale(float Scale);
+	// Toggle visibility of room gizmo's
+	void ToggleGizmoVisibility(bool Visible);
+
+	// Reset room from edit state. Deletes temporary actors and resets materials
+	void ResetRoomEditMode(EEditMode EditMode);
+	// Set room to current EditMode. Spawns appropriate temporary actors and changes material
+	void SetRoomEditMode();
+	// Switch the edited room when the room collision of another room was clicked
+	void SwitchEditRoom(TObjectPtr<APRG_Room> SetRoom);
+	// Set temporary material on given actor during editing
+	void SetEditModeMaterial(TObjectPtr<AStaticMeshActor> Actor, TObjectPtr<UMaterial> Material);
+	// Set array of materials to actor
+	void SetArrayMaterials(TObjectPtr<AStaticMeshActor> Actor, TArray<TObjectPtr<UMaterial>> Materials);
+	// Reset materials on all persistent actors for the given EditMode
+	void ResetPersistMaterials(EEditMode EditMode);
+
+	// Get the edit mode material for a cell in the given state. Returns a placeholder while the material is loading
+	TObjectPtr<UMaterial> GetEditModeMaterial(bool bPersistent, bool bSelected) const;
+	// Apply the edit mode material of every cell of the current room again, e.g. once the materials are loaded
+	void RefreshEditModeMaterials();
+
+	// Start loading default meshes, edit mode materials and room bounds content asynchronously
+	void RequestDefaultContent();
+	// Block until the default meshes are loaded. Only waits when a cell is spawned before they finished loading
+	void WaitForDefaultMeshes();
+	// Use loaded default meshes where the settings and the user did not set one
+	void ApplyDefaultMeshes();
+	// Replace placeholders by the loaded edit mode materials and room bounds content
+	void OnEditContentLoaded();
+	// Get wall or tile actor at index for the current EditMode, and whether it is persistent
+	TObjectPtr<AStaticMeshActor> GetEditCell(int Index, bool& bOutPersistent);
+	// Number of walls or tiles in the current room for the current EditMode
+	int GetNumEditCells() const;
+	// Select cells using the SelectionShape, starting from or ending at the clicked cell
+	void SelectCellsWithShape(int ClickedIndex);
+	// Get all cells in the rectangle or on the line between two cells
+	void GatherShapeCells(int FromIndex, int ToIndex, TArray<int>& OutIndices) const;
+	// Get all cells connected to the seed cell with the same state and mesh
+	void GatherFloodFillCells(int SeedIndex, TArray<int>& OutIndices);
+	// Replace the multi-cell selection, updating materials of changed cells only
+	void SetCellSelection(const TArray<int>& Indices);
+	// Deselect all cells of the multi-cell selection
+	void ClearCellSelection();
+	// Check if any cell is part of the multi-cell selection
+	bool HasCellSelection() const;
+	// Toggle all selected cells between persistent and temporary as one change
+	void ToggleSelectedCells();
+	// Apply a mesh to all selected cells as one change
+	void ApplyMeshToSelectedCells(UStaticMesh* Mesh);
+	// Set the type of all selected walls as one change
+	void ApplyWallTypeToSelectedWalls(EPRGWallType Type);
+
+	// Get wall or tile index under the ray by intersecting it with the grid of the current room. No physics trace
+	int PickEditCell(const FRay& WorldRay) const;
+	// Pick the hovered cell from the last hover ray, if it moved since the last tick
+	void UpdateHoveredCell();
+	// Stop hovering any cell
+	void ClearHoveredCell();
+	// Outline the overlapping tiles of all overlapping rooms
+	void RenderOverlaps(IToolsContextRenderAPI* RenderAPI) const;
+
+	// Handler of changes to a single tool property
+	typedef TFunction<void(UObject* PropertySet, FProperty* Property)> FPropertyHandler;
+	// Fill PropertyHandlers. Properties are looked up once, so OnPropertyModified dispatches without comparing names
+	void RegisterPropertyHandlers();
+	// Handle changes to the tool property with the given name
+	void AddPropertyHandler(FName PropertyName, TFunction<void()> Handler);
+	// Handle a bool property used as button. OnPressed is only called when checked, and the button is unchecked afterwards
+	void AddButtonHandler(FName PropertyName, bool UPRG_PluginRoomToolProperties::* Button, TFunction<void()> OnPressed);
+	// Apply a changed wall or floor mesh to the selected cells, or store it as default when nothing is selected
+	void CellMeshModified(UStaticMesh* StaticMesh, EEditMode MeshEditMode);
+
+private:
+	// Spawn tile actor
+	TObjectPtr<ATile> SpawnTile(APRG_Room& ParentRoom, int IndexInRoom, FVector SpawnPos);
+	// Spawn wall actor and get rotation
+	TObjectPtr<AWall> SpawnWall(APRG_Room& ParentRoom, int IndexInRoom, FVector SpawnPos);
+	// Spawn wall actor with given rotation
+	TObjectPtr<AWall> SpawnWallRot(APRG_Room& ParentRoom, FVector SpawnPos, FRotator SpawnRot);
+
+	// Create a bounding box for the currently selected room
+	void SpawnRoomBoundingBox();
+	// Remove the bounding box for the currently selected room
+	void RemoveRoomBoundingBox();
+
+	void SpawnCreateRoomGizmo();
+	void UpdateCreateRoomGizmo(FVector NewPos);
+	void RemoveCreateRoomGizmo();
+
+	void ResetToolState();
+
+protected:
+	// Handle edit mode interaction with valid actors OnClick
+	template <class T>
+	void OnClickEditModeInteraction(EEditMode EditMode, FHitResult& TraceResult, TArray<TObjectPtr<T>>& TempArray, TArray<TObjectPtr<T>>& PersistArray)
+	{
+		if (auto ActiveRoom = TryGetCurrentRoom())
+		{
+			TObjectPtr<T> FoundActor = static_cast<T*>(TraceResult.GetActor());
+
+			// 0. Select multiple cells of the current room using the selection shape
+			int FoundIndex = INDEX_NONE;
+			if (Properties->SelectionShape != ESelectionShape::Single && (TempArray.Find(FoundActor, FoundIndex) || PersistArray.Find(FoundActor, FoundIndex)))
+			{
+				DeselectPriorActor(TempArray, PersistArray);
+				CurrentSelectedActorInRoom = { -1, nullptr };
+				SelectCellsWithShape(FoundIndex);
+
+				if constexpr (std::is_same<T, AWall>())
+					Properties->WallMesh = FoundActor->GetStaticMeshComponent()->GetStaticMesh();
+				else if constexpr (std::is_same<T, ATile>())
+					Properties->FloorMesh = FoundActor->GetStaticMeshComponent()->GetStaticMesh();
+				return;
+			}
+
+			// 1. Toggle selected object between temporary and persistent arrays
+			if (CurrentSelectedActorInRoom.Value == FoundActor)
+			{
+				FPRGScopedCellChange CellChange(GetToolManager(), ActiveRoom, NSLOCTEXT("UPRG_PluginRoomTool", "ToggleCell", "Toggle Room Cell"));
+				TogglePersistance(TempArray, PersistArray);
+			}
+			// 2. Set selected object to traced object if of matching type. Check if current selection is part of current room OR initial selection of current room
+			else if (CurrentSelectedActorInRoom.Value && CurrentSelectedActorInRoom.Value->GetAttachParentActor() == FoundActor->GetAttachParentActor() ||
+				TempArray.Contains(FoundActor) || PersistArray.Contains(FoundActor))
+			{
+				ClearCellSelection();
+				DeselectPriorActor(TempArray, PersistArray);
+				SetSelectedActorInRoom(TempArray, PersistArray, ActiveRoom, FoundActor);
+			}
+			// 3. Switch selection to new room when trace hits object of an unselected room
+			else
+			{
+				ClearCellSelection();
+				DeselectPriorActor(TempArray, PersistArray);
+				ResetRoomEditMode(EditMode);
+
+				if (TObjectPtr<APRG_Room> ChangeRoom = static_cast<APRG_Room*>(FoundActor->GetAttachParentActor()))
+				{
+					SetCurrentRoom(ChangeRoom);
+					SetRoomEditMode();
+
+					// When changing rooms, the passed temp and persist arrays will be outdated, so get them fresh
+					if constexpr (std::is_same<T, AWall>())
+						SetSelectedActorInRoom(TempWalls, ChangeRoom->GetWalls(), ChangeRoom, FoundActor);
+					else if constexpr (std::is_same<T, ATile>())
+						SetSelectedActorInRoom(TempTiles, ChangeRoom->GetTiles(), ChangeRoom, FoundActor);
+				}
+			}
+		}
+	}
+
+	// Toggle current actor persistance state, switching selected object between temp and peristent arrays
+	template <class T>
+	void TogglePersistance(TArray<TObjectPtr<T>>& TempArray, TArray<TObjectPtr<T>>& PersistArray)
+	{
+		if (TObjectPtr<T> ToggleActor = static_cast<T*>(CurrentSelectedActorInRoom.Value))
+		{
+			int FoundIndex;
+			if (TempArray.Find(ToggleActor, FoundIndex))
+			{
+				PersistArray[FoundIndex] = ToggleActor;
+				TempArray[FoundIndex] = nullptr;
+				APRG_Room::SetTemporaryCell(ToggleActor, false);
+				SetEditModeMaterial(ToggleActor, Properties->PersistSelectedMat);
+			}
+			else if (PersistArray.Find(ToggleActor, FoundIndex))
+			{
+				TempArray[FoundIndex] = ToggleActor;
+				PersistArray[FoundIndex] = nullptr;
+				APRG_Room::SetTemporaryCell(ToggleActor, true);
+				SetEditModeMaterial(ToggleActor, Properties->TempSelectedMat);
+			}
+		}
+	}
+
+	// Deselect previous actor, changing the material to appropriate UnselectedMat
+	template <class T>
+	void DeselectPriorActor(const TArray<TObjectPtr<T>>& TempArray, const TArray<TObjectPtr<T>>& PersistArray)
+	{
+		if (TObjectPtr<T> DeselectActor = static_cast<T*>(CurrentSelectedActorInRoom.Value))
+		{
+			if (TempArray.Contains(DeselectActor))
+				SetEditModeMaterial(DeselectActor, Properties->TempUnselectedMat);
+			else if (PersistArray.Contains(DeselectActor))
+				SetEditModeMaterial(DeselectActor, Properties->PersistUnselectedMat);
+		}
+	}
+
+	// Set current actor as selected and changes material to appropriate SelectedMat
+	template <class T>
+	void SetSelectedActorInRoom(const TArray<TObjectPtr<T>>& TempArray, const TArray<TObjectPtr<T>>& PersistArray, const TObjectPtr<APRG_Room> ActiveRoom, TObjectPtr<T> SetActor)
+	{
+		int FoundIndex = -1;
+		if (TempArray.Find(SetActor, FoundIndex))
+			SetEditModeMaterial(SetActor, Properties->TempSelectedMat);
+		else if (ActiveRoom)
+		{
+			if (PersistArray.Find(SetActor, FoundIndex))
+				SetEditModeMaterial(SetActor, Properties->PersistSelectedMat);
+		}
+		CurrentSelectedActorInRoom = { FoundIndex, SetActor };
+
+		if constexpr (std::is_same<T, AWall>())
+			Properties->WallMesh = SetActor->GetStaticMeshComponent()->GetStaticMesh();
+		else if constexpr (std::is_same<T, ATile>())
+			Properties->FloorMesh = SetActor->GetStaticMeshComponent()->GetStaticMesh();
+	}
+
+	// Set Room EditMode and set/update materials on persistent and temporary actors. Spawns temporary actors if needed
+	template <class T, typename FPtrSpawn, typename FPtrGetPos>
+	void SetEditModeMaterials(TArray<TObjectPtr<T>>& TempArray, TArray<TObjectPtr<T>>& PersistArray, FPtrSpawn SpawnFunc, FPtrGetPos GetPosFunc)
+	{
+		if constexpr (std::is_base_of<AStaticMeshActor, T>::value)
+		{
+			// Lambda - Store original materials
+			auto StoreOriginalMats = [&](TObjectPtr<T>& StaticMesh, int index, TObjectPtr<UMaterial> Material)
+			{
+				TArray<UMaterialInterface*> OutMaterials;
+				StaticMesh->GetStaticMeshComponent()->GetUsedMaterials(OutMaterials);
+				for (int j = 0; j < OutMaterials.Num(); j++)
+					OriginalMaterials[index].Add(OutMaterials[j]->GetMaterial());
+
+				SetEditModeMaterial(StaticMesh, Material);
+			};
+
+			// Call lambda for correct array
+			if (auto ActiveRoom = TryGetCurrentRoom())
+			{
+				// Reset and resize array of original materials
+				for (int i = 0; i < OriginalMaterials.Num(); i++)
+					OriginalMaterials[i].Empty();
+				OriginalMaterials.Empty();
+				OriginalMaterials.SetNum(PersistArray.Num());
+
+				TempArray.SetNum(PersistArray.Num());
+				for (int i = 0; i < PersistArray.Num(); i++)
+				{
+					// Store original materials and change existing material
+					if (PersistArray[i])
+					{
+						if (!PersistArray[i]->GetStaticMeshComponent())
+						{
+							// This can happen if a static mesh was manually deleted in the scene while the tool was open
+							UE_LOG(LogPRGTool, Warning, TEXT("Missing static mesh component detected. Adding TempArray actor to recover internal state."));
+
+							PersistArray[i] = nullptr;
+							// Get position from GetPosFunc, then call SpawnFunc to create actor
+							TempArray[i] = (this->*SpawnFunc)(*ActiveRoom, i, (ActiveRoom->*GetPosFunc)(i, TileSizeCM));
+							APRG_Room::SetTemporaryCell(TempArray[i], true);
+							StoreOriginalMats(TempArray[i], i, Properties->TempUnselectedMat);
+							continue;
+						}
+
+						StoreOriginalMats(PersistArray[i], i, Properties->PersistUnselectedMat);
+					}
+					// Check to spawn temporary actor and change material
+					else
+					{
+						if (!TempArray[i])
+						{
+							// Get position from GetPosFunc, then call SpawnFunc to create actor
+							TempArray[i] = (this->*SpawnFunc)(*ActiveRoom, i, (ActiveRoom->*GetPosFunc)(i, TileSizeCM));
+							APRG_Room::SetTemporaryCell(TempArray[i], true);
+						}
+						StoreOriginalMats(TempArray[i], i, Properties->TempUnselectedMat);
+					}
+				}
+			}
+		}
+	}
+
+protected:
+	UPROPERTY()
+	TObjectPtr<UPRG_PluginRoomToolProperties> Properties = nullptr;
+	UPROPERTY()
+	TObjectPtr<UCombinedTransformGizmo> TransformGizmo = nullptr;
+	UPROPERTY()
+	TObjectPtr<UTransformProxy> TransformProxy = nullptr;
+	UPROPERTY()
+	TObjectPtr<UCombinedTransformGizmo> SpawnGizmo = nullptr;
+	UPROPERTY()
+	TObjectPtr<UTransformProxy> SpawnProxy = nullptr;
+
+	/** Target World we will raycast into to find actors */
+	UWorld* TargetWorld = nullptr;
+
+private:
+	// Settings file
+	TObjectPtr<APRG_Settings> PRGSettings;
+	// Duplicate of RoomArray. Required to handle changes in OnPropertyModified 
+	TArray<TObjectPtr<APRG_Room>> RoomArrayCopy;
+	// Array of possible temporary walls used in EditMode::EditWalls
+	TArray<TObjectPtr<AWall>> TempWalls;
+	// Array of possible temporary tiles used in EditMode::EditTiles
+	TArray<TObjectPtr<ATile>> TempTiles;
+	// Array of stored original Materials used in EditMode::EditWalls or EditMode::EditTiles
+	TArray<TArray<TObjectPtr<UMaterial>>> OriginalMaterials;
+
+	// Room used with OriginalMaterials
+	TObjectPtr<APRG_Room> OriginMatRoom = nullptr;
+	// Last active Room
+	TObjectPtr<APRG_Room> LastActiveRoom = nullptr;
+	// Currently active Room
+	TObjectPtr<APRG_Room> CurrentRoom = nullptr;
+	// Bounding box of active Room
+	TObjectPtr<ARoomBounds> CurrentBoundingBox = nullptr;
+	// Currently active Tile or Wall StaticMeshActor
+	TPair<int, TObjectPtr<AStaticMeshActor>> CurrentSelectedActorInRoom;
+	// Cells of the current room selected with a selection shape, by wall or tile index
+	TBitArray<> SelectedCells;
+	// First clicked cell of a Rectangle or Line selection, INDEX_NONE when waiting for the first click
+	int SelectionAnchor = INDEX_NONE;
+	// Wall or tile index under the cursor in EditWalls and EditTiles, INDEX_NONE when not hovering a cell
+	int HoveredCell = INDEX_NONE;
+	// Last ray received while hovering, picked on the next tick
+	FRay HoverRay;
+	// Set when HoverRay changed since the last tick
+	bool bHoverRayChanged = false;
+	// Rooms kept visible by EIsolateMode::SelectedRooms
+	TArray<TObjectPtr<APRG_Room>> IsolatedRooms;
+	// Rooms and settings changed by gizmo drags and property edits, marked dirty once per interaction
+	FPRGChangeTracker ChangeTracker;
+	// Rooms sharing floor area. Highlighted while dragging, logged once no drag is in progress
+	FPRGRoomOverlap RoomOverlap;
+	// Handlers of tool property changes, keyed by the changed property
+	TMap<const FProperty*, FPropertyHandler> PropertyHandlers;
+	// Pending loads of the default meshes and of the edit mode materials and room bounds content
+	TSharedPtr<FStreamableHandle> DefaultMeshesHandle;
+	TSharedPtr<FStreamableHandle> EditContentHandle;
+
+	// Prior EditMode. Required to handle changes in OnPropertyModified 
+	EEditMode PrevEditMode = EEditMode::CreateRooms;
+	// RoomArray size. Required to handle changes in OnPropertyModified
+	int RoomArraySize = 0;
+
+	// Tile size internal. Separates UI in meters from internal calculations requiring more precision
+	int TileSizeCM = 200;
+
+	// Number of room records read and spawned per batch when importing a layout file
+	static constexpr int ImportChunkSize = 32;
+
+	// Rooms loaded while the tool is active, set up on the next tick
+	TArray<TWeakObjectPtr<APRG_Room>> LoadedRooms;
+	FDelegateHandle LoadedActorAddedHandle;
+	FDelegateHandle LoadedActorRemovedHandle;
+};
+
@@ -0,0 +1,151 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomCellsChange.h"
+
+#include "PRG_Room.h"
+#include "Engine/StaticMesh.h"
+#include "InteractiveToolManager.h"
+
+TUniquePtr<FPRGRoomCellsChange> FPRGRoomCellsChange::Create(const FPRGRoomCells& Before, const FPRGRoomCells& After, const FPRGMeshPalette& Palette)
+{
+	TUniquePtr<FPRGRoomCellsChange> Change = MakeUnique<FPRGRoomCellsChange>();
+	Change->OldSize = Before.RoomSize;
+	Change->NewSize = After.RoomSize;
+	Change->DeltaSize = FIntPoint(FMath::Max(Before.RoomSize.X, After.RoomSize.X), FMath::Max(Before.RoomSize.Y, After.RoomSize.Y));
+
+	// Compare both states on the common grid, so cells removed or added by a resize become runs as well
+	FPRGRoomCells OldCells = Before;
+	FPRGRoomCells NewCells = After;
+	OldCells.Resize(Change->DeltaSize);
+	NewCells.Resize(Change->DeltaSize);
+
+	BuildRuns(OldCells.TileMeshIds, NewCells.TileMeshIds, Change->TileRuns);
+	BuildRuns(OldCells.WallMeshIds, NewCells.WallMeshIds, Change->WallRuns);
+
+	// Lambda - Get wall types of cells as ids, so they share the run building
+	auto GetWallTypeIds = [](const FPRGRoomCells& Cells)
+	{
+		TArray<int32> TypeIds;
+		TypeIds.SetNumUninitialized(Cells.WallMeshIds.Num());
+		for (int32 i = 0; i < TypeIds.Num(); i++)
+			TypeIds[i] = int32(Cells.GetWallType(i));
+		return TypeIds;
+	};
+	BuildRuns(GetWallTypeIds(OldCells), GetWallTypeIds(NewCells), Change->WallTypeRuns);
+
+	if (Change->OldSize == Change->NewSize && Change->TileRuns.Num() == 0 && Change->WallRuns.Num() == 0 && Change->WallTypeRuns.Num() == 0)
+		return nullptr;
+
+	Change->Meshes = Palette.Meshes;
+	return Change;
+}
+
+void FPRGRoomCellsChange::BuildRuns(const TArray<int32>& OldIds, const TArray<int32>& NewIds, TArray<FCellRun>& OutRuns)
+{
+	check(OldIds.Num() == NewIds.Num());
+
+	int32 i = 0;
+	while (i < OldIds.Num())
+	{
+		if (OldIds[i] == NewIds[i])
+		{
+			i++;
+			continue;
+		}
+
+		FCellRun Run;
+		Run.First = i;
+		Run.OldId = OldIds[i];
+		Run.NewId = NewIds[i];
+		while (i < OldIds.Num() && OldIds[i] == Run.OldId && NewIds[i] == Run.NewId)
+			i++;
+		Run.Count = i - Run.First;
+
+		OutRuns.Add(Run);
+	}
+}
+
+void FPRGRoomCellsChange::Apply(UObject* Object)
+{
+	if (APRG_Room* Room = Cast<APRG_Room>(Object))
+		ApplyCells(*Room, false);
+}
+
+void FPRGRoomCellsChange::Revert(UObject* Object)
+{
+	if (APRG_Room* Room = Cast<APRG_Room>(Object))
+		ApplyCells(*Room, true);
+}
+
+void FPRGRoomCellsChange::ApplyCells(APRG_Room& Room, bool bRevert) const
+{
+	// Lambda - Get mesh of a palette index. Returns nullptr for empty cells
+	auto GetMesh = [this](int32 Id) -> UStaticMesh*
+	{
+		return Meshes.IsValidIndex(Id) ? Meshes[Id].Get() : nullptr;
+	};
+
+	FPRGScopedNavigationUpdate NavigationUpdate(&Room);
+
+	// Grow to the common grid first, so no cell is destroyed before its run is applied
+	Room.ResizeCells(DeltaSize);
+
+	for (const FCellRun& Run : TileRuns)
+		Room.SetCellMeshes(false, Run.First, Run.Count, GetMesh(bRevert ? Run.OldId : Run.NewId));
+	// Types before meshes, as placing a wall mesh makes its slot solid again
+	for (const FCellRun& Run : WallTypeRuns)
+		Room.SetWallTypes(Run.First, Run.Count, EPRGWallType(bRevert ? Run.OldId : Run.NewId));
+	for (const FCellRun& Run : WallRuns)
+		Room.SetCellMeshes(true, Run.First, Run.Count, GetMesh(bRevert ? Run.OldId : Run.NewId));
+
+	Room.ResizeCells(bRevert ? OldSize : NewSize);
+
+	Room.MarkPackageDirty();
+	Room.NotifyRoomChanged(ERoomChange::Cells);
+}
+
+bool FPRGRoomCellsChange::HasExpired(UObject* Object) const
+{
+	return !IsValid(Object);
+}
+
+FString FPRGRoomCellsChange::ToString() const
+{
+	return FString::Printf(TEXT("FPRGRoomCellsChange (%d tile runs, %d wall runs, %d wall type runs)"), TileRuns.Num(), WallRuns.Num(), WallTypeRuns.Num());
+}
+
+void FPRGRoomCellsChange::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(Meshes);
+}
+
+/*
+ * FPRGScopedCellChange implementation
+ */
+
+FPRGScopedCellChange::FPRGScopedCellChange(UInteractiveToolManager* InToolManager, APRG_Room* InRoom, const FText& InDescription)
+	: ToolManager(InToolManager)
+	, Room(InRoom)
+	, Description(InDescription)
+	, SuspendedUndo(GUndo)
+	, NavigationUpdate(InRoom)
+{
+	if (InRoom)
+		InRoom->CaptureCells(CellsBefore, Palette);
+
+	GUndo = nullptr;
+}
+
+FPRGScopedCellChange::~FPRGScopedCellChange()
+{
+	GUndo = SuspendedUndo;
+
+	if (!ToolManager || !Room.IsValid())
+		return;
+
+	FPRGRoomCells CellsAfter;
+	Room->CaptureCells(CellsAfter, Palette);
+
+	if (TUniquePtr<FPRGRoomCellsChange> Change = FPRGRoomCellsChange::Create(CellsBefore, CellsAfter, Palette))
+		ToolManager->EmitObjectChange(Room.Get(), MoveTemp(Change), Description);
+}
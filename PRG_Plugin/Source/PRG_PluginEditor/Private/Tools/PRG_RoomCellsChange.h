@@ -0,0 +1,82 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InteractiveToolChange.h"
+#include "PRG_RoomCells.h"
+#include "PRG_NavigationUpdate.h"
+
+class APRG_Room;
+class ITransaction;
+class UInteractiveToolManager;
+
+/**
+ * Undoable change of the cells of one room. Only stores runs of changed cell indices with their old and new
+ * palette index or wall type, so clearing or resetting a large room costs a few runs instead of a copy of every cell actor.
+ * Applying the change spawns, replaces or destroys the affected cell actors of the room.
+ */
+class FPRGRoomCellsChange : public FToolCommandChange
+{
+public:
+	// Build change from room cells before and after an edit, captured with the same palette. Returns nullptr if nothing changed
+	static TUniquePtr<FPRGRoomCellsChange> Create(const FPRGRoomCells& Before, const FPRGRoomCells& After, const FPRGMeshPalette& Palette);
+
+	virtual void Apply(UObject* Object) override;
+	virtual void Revert(UObject* Object) override;
+	virtual bool HasExpired(UObject* Object) const override;
+	virtual FString ToString() const override;
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+
+private:
+	// Consecutive cells sharing the same old and new palette index
+	struct FCellRun
+	{
+		int32 First = 0;
+		int32 Count = 0;
+		int32 OldId = INDEX_NONE;
+		int32 NewId = INDEX_NONE;
+	};
+
+	// Add runs for all cells that differ between the two arrays
+	static void BuildRuns(const TArray<int32>& OldIds, const TArray<int32>& NewIds, TArray<FCellRun>& OutRuns);
+	// Set room cells to the old or new state
+	void ApplyCells(APRG_Room& Room, bool bRevert) const;
+
+	// Room size before and after the change
+	FIntPoint OldSize = FIntPoint::ZeroValue;
+	FIntPoint NewSize = FIntPoint::ZeroValue;
+	// Size covering both old and new size. Runs index into a grid of this size
+	FIntPoint DeltaSize = FIntPoint::ZeroValue;
+
+	TArray<FCellRun> TileRuns;
+	TArray<FCellRun> WallRuns;
+	// Runs of changed wall types, storing the type instead of a palette index
+	TArray<FCellRun> WallTypeRuns;
+	// Meshes referenced by the runs
+	TArray<TObjectPtr<UStaticMesh>> Meshes;
+};
+
+/**
+ * Records the cells of a room for the lifetime of the scope and emits the difference as one FPRGRoomCellsChange.
+ * Cell actors spawned or destroyed within the scope are kept out of the transaction, as the change restores them.
+ * Navigation updates of the room are batched for the same scope.
+ */
+class FPRGScopedCellChange
+{
+public:
+	FPRGScopedCellChange(UInteractiveToolManager* InToolManager, APRG_Room* InRoom, const FText& InDescription);
+	~FPRGScopedCellChange();
+
+private:
+	UInteractiveToolManager* ToolManager;
+	TWeakObjectPtr<APRG_Room> Room;
+	FText Description;
+
+	FPRGRoomCells CellsBefore;
+	FPRGMeshPalette Palette;
+	// Transaction suspended while the scope is active
+	ITransaction* SuspendedUndo;
+	// Released after the change is emitted
+	FPRGScopedNavigationUpdate NavigationUpdate;
+};
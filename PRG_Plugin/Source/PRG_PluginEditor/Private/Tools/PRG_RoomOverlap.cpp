@@ -0,0 +1,301 @@
+// Copyright 2022 Steven Weijden
+
+#include "PRG_RoomOverlap.h"
+
+#include "EngineUtils.h"
+#include "PRG_Room.h"
+#include "PRG_RoomLayout.h"
+
+namespace
+{
+	// Edge length of the spatial hash buckets, in cm
+	constexpr double BucketSize = 2000.0;
+	// Overlaps thinner than this, e.g. rooms sharing an edge, are ignored. In cm
+	constexpr double Tolerance = 1.0;
+
+	using FOrientedRect = FPRGRoomOverlap::FOrientedRect;
+
+	// Radius of a rectangle projected on an axis
+	double ProjectedRadius(const FOrientedRect& Rect, const FVector2D& Axis)
+	{
+		return Rect.HalfExtent.X * FMath::Abs(Rect.AxisX | Axis) + Rect.HalfExtent.Y * FMath::Abs(Rect.AxisY | Axis);
+	}
+
+	// Separating axis test. Two rectangles are disjoint if their projections on any of their four axes are
+	bool RectsOverlap(const FOrientedRect& A, const FOrientedRect& B)
+	{
+		const FVector2D Delta = B.Center - A.Center;
+		for (const FVector2D& Axis : { A.AxisX, A.AxisY, B.AxisX, B.AxisY })
+		{
+			if (FMath::Abs(Delta | Axis) >= ProjectedRadius(A, Axis) + ProjectedRadius(B, Axis) - Tolerance)
+				return false;
+		}
+		return true;
+	}
+}
+
+FPRGRoomOverlap::FOrientedRect FPRGRoomOverlap::FFootprint::GetRect() const
+{
+	const FVector2D HalfExtent = FVector2D(Size) * TileSize * 0.5;
+	return { Origin + AxisX * HalfExtent.X + AxisY * HalfExtent.Y, AxisX, AxisY, HalfExtent };
+}
+
+FPRGRoomOverlap::FOrientedRect FPRGRoomOverlap::FFootprint::GetTileRect(int32 X, int32 Y) const
+{
+	const double HalfTile = TileSize * 0.5;
+	return { Origin + AxisX * (X * TileSize + HalfTile) + AxisY * (Y * TileSize + HalfTile), AxisX, AxisY, FVector2D(HalfTile, HalfTile) };
+}
+
+bool FPRGRoomOverlap::FFootprint::GetTileRange(const FOrientedRect& Rect, FIntPoint& OutFrom, FIntPoint& OutTo) const
+{
+	const FVector2D Delta = Rect.Center - Origin;
+	const FVector2D Local(Delta | AxisX, Delta | AxisY);
+	const FVector2D Radius(ProjectedRadius(Rect, AxisX), ProjectedRadius(Rect, AxisY));
+
+	OutFrom.X = FMath::Max(FMath::FloorToInt((Local.X - Radius.X) / TileSize), 0);
+	OutFrom.Y = FMath::Max(FMath::FloorToInt((Local.Y - Radius.Y) / TileSize), 0);
+	OutTo.X = FMath::Min(FMath::FloorToInt((Local.X + Radius.X) / TileSize), Size.X - 1);
+	OutTo.Y = FMath::Min(FMath::FloorToInt((Local.Y + Radius.Y) / TileSize), Size.Y - 1);
+	return OutFrom.X <= OutTo.X && OutFrom.Y <= OutTo.Y;
+}
+
+FPRGRoomOverlap::~FPRGRoomOverlap()
+{
+	Stop();
+}
+
+void FPRGRoomOverlap::Start(UWorld* InWorld)
+{
+	Stop();
+	World = InWorld;
+	if (!World)
+		return;
+
+	RoomChangedHandle = APRG_Room::OnAnyRoomChanged.AddRaw(this, &FPRGRoomOverlap::OnRoomChanged);
+	for (TActorIterator<APRG_Room> It(World); It; ++It)
+		DirtyRooms.Add(*It, true);
+}
+
+void FPRGRoomOverlap::Stop()
+{
+	APRG_Room::OnAnyRoomChanged.Remove(RoomChangedHandle);
+	RoomChangedHandle.Reset();
+
+	World = nullptr;
+	Footprints.Reset();
+	Buckets.Reset();
+	DirtyRooms.Reset();
+	Overlaps.Reset();
+}
+
+void FPRGRoomOverlap::Update()
+{
+	if (DirtyRooms.Num() == 0)
+		return;
+
+	const TMap<TWeakObjectPtr<APRG_Room>, bool> ChangedRooms = MoveTemp(DirtyRooms);
+	DirtyRooms.Reset();
+
+	// Move all changed rooms first, so rooms changed together, e.g. levels of a building, are tested at their new place
+	for (const TPair<TWeakObjectPtr<APRG_Room>, bool>& ChangedRoom : ChangedRooms)
+	{
+		APRG_Room* Room = ChangedRoom.Key.Get();
+		if (Room && Room->GetWorld() == World)
+			UpdateFootprint(*Room, ChangedRoom.Value);
+		else
+			RemoveRoom(ChangedRoom.Key);
+	}
+
+	// Overlaps that are found again keep their reported state, so they are only reported once
+	TSet<TPair<TWeakObjectPtr<APRG_Room>, TWeakObjectPtr<APRG_Room>>> ReportedBefore;
+	Overlaps.RemoveAll([&](const FOverlap& Overlap)
+	{
+		if (!ChangedRooms.Contains(Overlap.RoomA) && !ChangedRooms.Contains(Overlap.RoomB))
+			return false;
+
+		if (Overlap.bReported)
+			ReportedBefore.Add({ Overlap.RoomA, Overlap.RoomB });
+		return true;
+	});
+
+	TSet<TPair<TWeakObjectPtr<APRG_Room>, TWeakObjectPtr<APRG_Room>>> TestedPairs;
+	TArray<TWeakObjectPtr<APRG_Room>> Candidates;
+	for (const TPair<TWeakObjectPtr<APRG_Room>, bool>& ChangedRoom : ChangedRooms)
+	{
+		const FFootprint* Footprint = Footprints.Find(ChangedRoom.Key);
+		if (!Footprint)
+			continue;
+
+		Candidates.Reset();
+		for (const FIntPoint& Bucket : Footprint->Buckets)
+			Buckets.MultiFind(Bucket, Candidates);
+
+		for (const TWeakObjectPtr<APRG_Room>& Candidate : Candidates)
+		{
+			// Pairs of two changed rooms are found from both sides, and large rooms are found in many buckets
+			if (Candidate == ChangedRoom.Key || TestedPairs.Contains({ Candidate, ChangedRoom.Key }) || TestedPairs.Contains({ ChangedRoom.Key, Candidate }))
+				continue;
+			TestedPairs.Add({ ChangedRoom.Key, Candidate });
+
+			const FFootprint* CandidateFootprint = Footprints.Find(Candidate);
+			FOverlap Overlap;
+			if (CandidateFootprint && Candidate.IsValid() && TestFootprints(*Footprint, *CandidateFootprint, Overlap))
+			{
+				Overlap.RoomA = ChangedRoom.Key;
+				Overlap.RoomB = Candidate;
+				Overlap.bReported = ReportedBefore.Contains({ Overlap.RoomA, Overlap.RoomB }) || ReportedBefore.Contains({ Overlap.RoomB, Overlap.RoomA });
+				Overlaps.Add(MoveTemp(Overlap));
+			}
+		}
+	}
+}
+
+void FPRGRoomOverlap::ReportOverlaps(TFunctionRef<void(const FOverlap&)> Report)
+{
+	for (FOverlap& Overlap : Overlaps)
+	{
+		if (Overlap.bReported || !Overlap.RoomA.IsValid() || !Overlap.RoomB.IsValid())
+			continue;
+
+		Report(Overlap);
+		Overlap.bReported = true;
+	}
+}
+
+void FPRGRoomOverlap::OnRoomChanged(APRG_Room* Room, ERoomChange Change)
+{
+	// Hidden rooms still take up their floor space
+	if (!Room || Room->GetWorld() != World || Change == ERoomChange::Visibility)
+		return;
+
+	// Removed rooms may be gone by the next update
+	if (Change == ERoomChange::Removed)
+	{
+		RemoveRoom(Room);
+		return;
+	}
+
+	DirtyRooms.FindOrAdd(Room) |= (Change == ERoomChange::Cells);
+}
+
+void FPRGRoomOverlap::UpdateFootprint(APRG_Room& Room, bool bCellsChanged)
+{
+	FFootprint* Footprint = Footprints.Find(&Room);
+	if (!Footprint)
+	{
+		Footprint = &Footprints.Add(&Room);
+		bCellsChanged = true;
+	}
+
+	for (const FIntPoint& Bucket : Footprint->Buckets)
+		Buckets.RemoveSingle(Bucket, &Room);
+	Footprint->Buckets.Reset();
+
+	// Rooms only rotate around Z
+	const FTransform Transform = Room.GetActorTransform();
+	Footprint->Origin = FVector2D(Transform.GetLocation());
+	Footprint->AxisX = FVector2D(Transform.GetUnitAxis(EAxis::X)).GetSafeNormal();
+	Footprint->AxisY = FVector2D(-Footprint->AxisX.Y, Footprint->AxisX.X);
+	Footprint->MinZ = Transform.GetLocation().Z;
+	Footprint->MaxZ = Footprint->MinZ + Room.GetRoomHeight() * 100.0;
+
+	// Dragging a room only moves its footprint, the occupied tiles stay the same
+	if (bCellsChanged)
+	{
+		Footprint->Size = Room.GetRoomSize();
+		Footprint->TileSize = Room.GetTileSizeCM();
+		Footprint->Tiles.Init(false, Footprint->Size.X * Footprint->Size.Y);
+
+		if (const UPRG_RoomLayout* Layout = Room.GetLayout())
+		{
+			for (int32 i = 0; i < Layout->Cells.TileMeshIds.Num() && i < Footprint->Tiles.Num(); i++)
+				Footprint->Tiles[i] = Layout->Cells.TileMeshIds[i] != INDEX_NONE;
+		}
+		else
+		{
+			for (int32 i = 0; i < Room.GetTiles().Num() && i < Footprint->Tiles.Num(); i++)
+				Footprint->Tiles[i] = Room.GetTiles()[i] != nullptr;
+		}
+	}
+
+	// Store the room in every bucket its world bounds touch
+	const FOrientedRect Rect = Footprint->GetRect();
+	const FVector2D Radius(ProjectedRadius(Rect, FVector2D(1.0, 0.0)), ProjectedRadius(Rect, FVector2D(0.0, 1.0)));
+	const FIntPoint From(FMath::FloorToInt((Rect.Center.X - Radius.X) / BucketSize), FMath::FloorToInt((Rect.Center.Y - Radius.Y) / BucketSize));
+	const FIntPoint To(FMath::FloorToInt((Rect.Center.X + Radius.X) / BucketSize), FMath::FloorToInt((Rect.Center.Y + Radius.Y) / BucketSize));
+	for (int32 Y = From.Y; Y <= To.Y; Y++)
+	{
+		for (int32 X = From.X; X <= To.X; X++)
+		{
+			Footprint->Buckets.Add(FIntPoint(X, Y));
+			Buckets.Add(FIntPoint(X, Y), &Room);
+		}
+	}
+}
+
+void FPRGRoomOverlap::RemoveRoom(const TWeakObjectPtr<APRG_Room>& Room)
+{
+	if (const FFootprint* Footprint = Footprints.Find(Room))
+	{
+		for (const FIntPoint& Bucket : Footprint->Buckets)
+			Buckets.RemoveSingle(Bucket, Room);
+		Footprints.Remove(Room);
+	}
+
+	DirtyRooms.Remove(Room);
+	Overlaps.RemoveAll([&Room](const FOverlap& Overlap) { return Overlap.RoomA == Room || Overlap.RoomB == Room; });
+}
+
+bool FPRGRoomOverlap::TestFootprints(const FFootprint& A, const FFootprint& B, FOverlap& OutOverlap)
+{
+	// Levels of a building are stacked, so their height ranges only touch
+	if (A.MinZ >= B.MaxZ - Tolerance || B.MinZ >= A.MaxZ - Tolerance)
+		return false;
+
+	const FOrientedRect RectB = B.GetRect();
+	if (!RectsOverlap(A.GetRect(), RectB))
+		return false;
+
+	// Only tiles of A inside the bounds of B, and per tile of A only tiles of B inside its bounds, are tested
+	FIntPoint FromA, ToA;
+	if (!A.GetTileRange(RectB, FromA, ToA))
+		return false;
+
+	TBitArray<> HitB(false, B.Tiles.Num());
+	for (int32 YA = FromA.Y; YA <= ToA.Y; YA++)
+	{
+		for (int32 XA = FromA.X; XA <= ToA.X; XA++)
+		{
+			const int32 IndexA = XA + YA * A.Size.X;
+			if (!A.Tiles[IndexA])
+				continue;
+
+			const FOrientedRect TileA = A.GetTileRect(XA, YA);
+			FIntPoint FromB, ToB;
+			if (!B.GetTileRange(TileA, FromB, ToB))
+				continue;
+
+			bool bHit = false;
+			for (int32 YB = FromB.Y; YB <= ToB.Y; YB++)
+			{
+				for (int32 XB = FromB.X; XB <= ToB.X; XB++)
+				{
+					const int32 IndexB = XB + YB * B.Size.X;
+					if (B.Tiles[IndexB] && RectsOverlap(TileA, B.GetTileRect(XB, YB)))
+					{
+						HitB[IndexB] = true;
+						bHit = true;
+					}
+				}
+			}
+
+			if (bHit)
+				OutOverlap.TilesA.Add(IndexA);
+		}
+	}
+
+	for (TConstSetBitIterator<> It(HitB); It; ++It)
+		OutOverlap.TilesB.Add(It.GetIndex());
+
+	return OutOverlap.TilesA.Num() > 0;
+}
@@ -0,0 +1,95 @@
+// Copyright 2022 Steven Weijden
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APRG_Room;
+enum class ERoomChange : uint8;
+
+/**
+ * Finds rooms whose floors overlap, e.g. while a room is dragged with its gizmo or right after it is spawned.
+ * Rooms changed since the last update are tested against their neighbours only:
+ *  - Broad phase: rooms are stored in a spatial hash by the buckets their world bounds cover
+ *  - Mid phase: separating axis test of the oriented footprints, including their height range
+ *  - Narrow phase: separating axis test of the occupied tiles of both rooms, so rotated rooms are tested per tile
+ * Edges and corners that only touch do not count as overlap, so rooms placed side by side are fine.
+ */
+class FPRGRoomOverlap
+{
+public:
+	// Two rooms sharing floor area, and the tiles of each room inside the other one
+	struct FOverlap
+	{
+		TWeakObjectPtr<APRG_Room> RoomA;
+		TWeakObjectPtr<APRG_Room> RoomB;
+		TArray<int32> TilesA;
+		TArray<int32> TilesB;
+		// Set once the overlap was passed to ReportOverlaps
+		bool bReported = false;
+	};
+
+	// Rectangle on the XY plane with unit axes
+	struct FOrientedRect
+	{
+		FVector2D Center;
+		FVector2D AxisX;
+		FVector2D AxisY;
+		FVector2D HalfExtent;
+	};
+
+	// Room grid projected on the XY plane, with its height range and occupied tiles
+	struct FFootprint
+	{
+		FVector2D Origin = FVector2D::ZeroVector;
+		FVector2D AxisX = FVector2D(1.0, 0.0);
+		FVector2D AxisY = FVector2D(0.0, 1.0);
+		FIntPoint Size = FIntPoint::ZeroValue;
+		double TileSize = 0.0;
+		double MinZ = 0.0;
+		double MaxZ = 0.0;
+		TBitArray<> Tiles;
+		// Spatial hash buckets the footprint is stored in
+		TArray<FIntPoint> Buckets;
+
+		// Get the rectangle covered by the whole grid
+		FOrientedRect GetRect() const;
+		// Get the rectangle covered by a tile
+		FOrientedRect GetTileRect(int32 X, int32 Y) const;
+		// Get the inclusive range of tiles the bounds of a rectangle cover. Returns false if it covers none
+		bool GetTileRange(const FOrientedRect& Rect, FIntPoint& OutFrom, FIntPoint& OutTo) const;
+	};
+
+	~FPRGRoomOverlap();
+
+	// Track all rooms of a world and follow their changes
+	void Start(UWorld* InWorld);
+	// Stop tracking rooms and forget all overlaps
+	void Stop();
+
+	// Test rooms changed since the last update against their neighbours
+	void Update();
+	// Call Report once for every overlap found since the last call
+	void ReportOverlaps(TFunctionRef<void(const FOverlap&)> Report);
+
+	// Get all current overlaps
+	const TArray<FOverlap>& GetOverlaps() const { return Overlaps; }
+
+private:
+	// Record a room change, tested on the next update
+	void OnRoomChanged(APRG_Room* Room, ERoomChange Change);
+	// Update footprint and buckets of a room. Occupied tiles are only gathered again when its cells changed
+	void UpdateFootprint(APRG_Room& Room, bool bCellsChanged);
+	// Remove a room from the spatial hash, its footprint and all its overlaps
+	void RemoveRoom(const TWeakObjectPtr<APRG_Room>& Room);
+	// Test two footprints, returning true and filling the overlapping tiles if they overlap
+	static bool TestFootprints(const FFootprint& A, const FFootprint& B, FOverlap& OutOverlap);
+
+	UWorld* World = nullptr;
+	TMap<TWeakObjectPtr<APRG_Room>, FFootprint> Footprints;
+	TMultiMap<FIntPoint, TWeakObjectPtr<APRG_Room>> Buckets;
+	// Rooms to test on the next update, and whether their cells changed
+	TMap<TWeakObjectPtr<APRG_Room>, bool> DirtyRooms;
+	TArray<FOverlap> Overlaps;
+	FDelegateHandle RoomChangedHandle;
+};
@@ -6,10 +6,10 @@
 #include "Modules/ModuleManager.h"
 
 /**
- * This is the module definition for the editor mode. You can implement custom functionality
+ * This is the module definition for the editor mode, the room tool and the commandlet. You can implement custom functionality
  * as your plugin module starts up and shuts down. See IModuleInterface for more extensibility options.
  */
-class FPRG_PluginModule : public IModuleInterface
+class FPRG_PluginEditorModule : public IModuleInterface
 {
 public:
 